@@ -0,0 +1,4602 @@
+// Biblioteca do tradutor: carga, gravação, tradução, otimização, simulação e verificação de Máquinas de Turing.
+// A interface está em tradutor.h; o programa de linha de comando fica em tradutor.c.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "tradutor.h"
+
+// Código e mensagem do último erro da thread atual. As funções da biblioteca registram o erro
+// aqui e retornam NULL/-1, deixando para quem chamou decidir se aborta.
+static __thread char mensagemErro[512];
+static __thread CodigoErro codigoErro;
+
+static void registrar_erro(CodigoErro codigo, const char* formato, ...) {
+    codigoErro = codigo;
+    va_list args;
+    va_start(args, formato);
+    vsnprintf(mensagemErro, sizeof(mensagemErro), formato, args);
+    va_end(args);
+}
+
+const char* ultimo_erro(void) {
+    return mensagemErro;
+}
+
+CodigoErro ultimo_codigo_erro(void) {
+    return codigoErro;
+}
+
+// Falha de alocação: registra o erro e deixa quem chamou liberar o que já tinha e retornar
+static void registrar_falta_de_memoria(const char* para) {
+    registrar_erro(TRADUTOR_ERRO_MEMORIA, "Falha na alocação de memória para %s.", para);
+}
+
+// === Instrumentação ===
+// Com uma Instrumentacao ativada na thread, a biblioteca acumula nela os tempos de cada etapa, as
+// alocações e as regras geradas por categoria. As partes de uma tradução em várias threads herdam a
+// instrumentação da thread que as criou; os contadores são somados atomicamente.
+
+static __thread Instrumentacao* instrumentacao;
+
+void ativar_instrumentacao(Instrumentacao* destino) {
+    instrumentacao = destino;
+}
+
+static void contar(uint64_t* contador, uint64_t quantidade) {
+    __atomic_fetch_add(contador, quantidade, __ATOMIC_RELAXED);
+}
+
+static double segundos_do_relogio(clockid_t relogio) {
+    struct timespec agora;
+    clock_gettime(relogio, &agora);
+    return agora.tv_sec + agora.tv_nsec / 1e9;
+}
+
+// Marca do início de uma etapa; etapa_fim acumula o tempo desde a marca
+typedef struct {
+    double real;
+    double cpu;
+} MarcaTempo;
+
+static MarcaTempo etapa_inicio(void) {
+    MarcaTempo marca = { 0, 0 };
+    if (instrumentacao) {
+        marca.real = segundos_do_relogio(CLOCK_MONOTONIC);
+        marca.cpu = segundos_do_relogio(CLOCK_PROCESS_CPUTIME_ID);
+    }
+    return marca;
+}
+
+static void etapa_fim(EtapaTraducao etapa, MarcaTempo marca) {
+    if (!instrumentacao) return;
+    instrumentacao->segundos[etapa] += segundos_do_relogio(CLOCK_MONOTONIC) - marca.real;
+    instrumentacao->segundosCpu[etapa] += segundos_do_relogio(CLOCK_PROCESS_CPUTIME_ID) - marca.cpu;
+}
+
+// Regras acrescentadas a 'maquina' desde que ela tinha 'antes' transições
+static void contar_regras(CategoriaRegra categoria, const MaquinaTuring* maquina, int antes) {
+    if (instrumentacao && maquina->numTransicoes > antes) contar(&instrumentacao->regras[categoria], maquina->numTransicoes - antes);
+}
+
+static void* alocar(size_t tamanho) {
+    if (instrumentacao) {
+        contar(&instrumentacao->alocacoes, 1);
+        contar(&instrumentacao->bytesAlocados, tamanho);
+    }
+    return malloc(tamanho);
+}
+
+static void* alocar_zerado(size_t quantidade, size_t tamanho) {
+    if (instrumentacao) {
+        contar(&instrumentacao->alocacoes, 1);
+        contar(&instrumentacao->bytesAlocados, quantidade * tamanho);
+    }
+    return calloc(quantidade, tamanho);
+}
+
+static void* realocar(void* anterior, size_t tamanho) {
+    if (instrumentacao) {
+        contar(&instrumentacao->alocacoes, 1);
+        contar(&instrumentacao->bytesAlocados, tamanho);
+    }
+    return realloc(anterior, tamanho);
+}
+
+const char* nome_etapa(EtapaTraducao etapa) {
+    static const char* const nomes[NUM_ETAPAS] = { "leitura", "coleta_estados", "fase1", "fase2", "escrita" };
+    return etapa < NUM_ETAPAS ? nomes[etapa] : "?";
+}
+
+const char* nome_categoria(CategoriaRegra categoria) {
+    static const char* const nomes[NUM_CATEGORIAS] = { "preparacao", "copiadas", "mola", "deslocamento", "extensao" };
+    return categoria < NUM_CATEGORIAS ? nomes[categoria] : "?";
+}
+
+// Origem de cada regra da tradução em andamento nesta thread (traduzir_maquina_com_origens)
+typedef struct {
+    int32_t* origens;
+    size_t capacidade;
+    int falhou;
+} RegistroOrigens;
+
+static __thread RegistroOrigens* registroOrigens;
+
+// Marca as regras [antes, numTransicoes) de 'maquina' com 'origem'
+static void marcar_origem(const MaquinaTuring* maquina, int antes, int32_t origem) {
+    RegistroOrigens* registro = registroOrigens;
+    if (!registro || registro->falhou) return;
+    if ((size_t) maquina->numTransicoes > registro->capacidade) {
+        size_t capacidade = registro->capacidade ? registro->capacidade : 1024;
+        while (capacidade < (size_t) maquina->numTransicoes) capacidade *= 2;
+        int32_t* origens = (int32_t*) realocar(registro->origens, capacidade * sizeof(int32_t));
+        if (!origens) {
+            registro->falhou = 1;
+            return;
+        }
+        registro->origens = origens;
+        registro->capacidade = capacidade;
+    }
+    for (int i = antes; i < maquina->numTransicoes; i++) registro->origens[i] = origem;
+}
+
+// FNV-1a de 32 bits, usado pelo índice das tabelas de nomes
+static uint32_t hash_nome(const char* nome, size_t tamanho) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < tamanho; i++) {
+        h ^= (unsigned char) nome[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Retorna o deslocamento da cópia, ou UINT32_MAX se a arena não pôde crescer
+static uint32_t arena_copiar(Arena* arena, const char* nome, size_t tamanho) {
+    if (arena->usados + tamanho + 1 > arena->capacidade) {
+        // 'nome' pode apontar para dentro da própria arena, que vai ser realocada
+        int dentroDaArena = arena->bytes && nome >= arena->bytes && nome < arena->bytes + arena->usados;
+        size_t deslocamentoNome = dentroDaArena ? (size_t) (nome - arena->bytes) : 0;
+
+        size_t novaCapacidade = arena->capacidade ? arena->capacidade : 4096;
+        while (arena->usados + tamanho + 1 > novaCapacidade) novaCapacidade *= 2;
+        if (novaCapacidade > UINT32_MAX) {
+            registrar_erro(TRADUTOR_ERRO_LIMITE, "Nomes de estados e símbolos excedem o limite da arena.");
+            return UINT32_MAX;
+        }
+        char* bytes = (char*) realocar(arena->bytes, novaCapacidade);
+        if (!bytes) {
+            registrar_falta_de_memoria("a arena de nomes");
+            return UINT32_MAX;
+        }
+        arena->bytes = bytes;
+        arena->capacidade = novaCapacidade;
+        if (dentroDaArena) nome = arena->bytes + deslocamentoNome;
+    }
+
+    uint32_t deslocamento = (uint32_t) arena->usados;
+    memcpy(arena->bytes + deslocamento, nome, tamanho);
+    arena->bytes[deslocamento + tamanho] = '\0';
+    arena->usados += tamanho + 1;
+    return deslocamento;
+}
+
+// Procura a posição do índice onde 'nome' está ou deveria estar
+static uint32_t posicao_no_indice(const TabelaNomes* tabela, const Arena* arena, const char* nome, size_t tamanho) {
+    uint32_t mascara = tabela->capacidadeIndice - 1;
+    uint32_t pos = hash_nome(nome, tamanho) & mascara;
+    while (tabela->indice[pos] != 0) {
+        IdNome id = tabela->indice[pos] - 1;
+        if (tabela->tamanhos[id] == tamanho && memcmp(arena->bytes + tabela->deslocamentos[id], nome, tamanho) == 0) {
+            break;
+        }
+        pos = (pos + 1) & mascara;
+    }
+    return pos;
+}
+
+// Em caso de falha o índice antigo continua valendo
+static int reconstruir_indice(TabelaNomes* tabela, const Arena* arena, uint32_t novaCapacidade) {
+    uint32_t* indice = (uint32_t*) alocar_zerado(novaCapacidade, sizeof(uint32_t));
+    if (!indice) {
+        registrar_falta_de_memoria("o índice de nomes");
+        return -1;
+    }
+    free(tabela->indice);
+    tabela->indice = indice;
+    tabela->capacidadeIndice = novaCapacidade;
+    for (IdNome id = 0; id < tabela->numNomes; id++) {
+        const char* nome = arena->bytes + tabela->deslocamentos[id];
+        tabela->indice[posicao_no_indice(tabela, arena, nome, tabela->tamanhos[id])] = id + 1;
+    }
+    return 0;
+}
+
+IdNome buscar_nome(const TabelaNomes* tabela, const Arena* arena, const char* nome, size_t tamanho) {
+    if (tabela->capacidadeIndice == 0) {
+        // Tabelas vindas do formato binário não têm índice: busca linear
+        for (IdNome id = 0; id < tabela->numNomes; id++) {
+            if (tabela->tamanhos[id] == tamanho && memcmp(arena->bytes + tabela->deslocamentos[id], nome, tamanho) == 0) return id;
+        }
+        return ID_INEXISTENTE;
+    }
+    uint32_t pos = posicao_no_indice(tabela, arena, nome, tamanho);
+    return tabela->indice[pos] ? tabela->indice[pos] - 1 : ID_INEXISTENTE;
+}
+
+// Retorna ID_INEXISTENTE se faltar memória ou se a tabela for de uma máquina binária (somente leitura)
+IdNome internar_nome(TabelaNomes* tabela, Arena* arena, const char* nome, size_t tamanho) {
+    // Só as tabelas vindas do formato binário têm vetores sem ter índice; eles apontam para a região do arquivo
+    if (tabela->capacidadeIndice == 0 && tabela->deslocamentos) {
+        registrar_erro(TRADUTOR_ERRO_SOMENTE_LEITURA, "Máquinas carregadas do formato binário são somente leitura.");
+        return ID_INEXISTENTE;
+    }
+    // Mantém o fator de carga do índice abaixo de 1/2
+    if ((tabela->numNomes + 1) * 2 > tabela->capacidadeIndice &&
+        reconstruir_indice(tabela, arena, tabela->capacidadeIndice ? tabela->capacidadeIndice * 2 : 64) != 0) {
+        return ID_INEXISTENTE;
+    }
+
+    uint32_t pos = posicao_no_indice(tabela, arena, nome, tamanho);
+    if (tabela->indice[pos] != 0) {
+        return tabela->indice[pos] - 1;
+    }
+
+    if (tabela->numNomes >= tabela->capacidadeNomes) {
+        uint32_t capacidade = tabela->capacidadeNomes ? tabela->capacidadeNomes * 2 : 32;
+        uint32_t* deslocamentos = (uint32_t*) realocar(tabela->deslocamentos, capacidade * sizeof(uint32_t));
+        if (deslocamentos) tabela->deslocamentos = deslocamentos;
+        uint32_t* tamanhos = (uint32_t*) realocar(tabela->tamanhos, capacidade * sizeof(uint32_t));
+        if (tamanhos) tabela->tamanhos = tamanhos;
+        if (!deslocamentos || !tamanhos) {
+            registrar_falta_de_memoria("a tabela de nomes");
+            return ID_INEXISTENTE;
+        }
+        tabela->capacidadeNomes = capacidade;
+    }
+
+    uint32_t deslocamento = arena_copiar(arena, nome, tamanho);
+    if (deslocamento == UINT32_MAX) return ID_INEXISTENTE;
+    IdNome id = tabela->numNomes++;
+    tabela->deslocamentos[id] = deslocamento;
+    tabela->tamanhos[id] = (uint32_t) tamanho;
+    tabela->indice[pos] = id + 1;
+    return id;
+}
+
+static void liberar_tabela(TabelaNomes* tabela) {
+    free(tabela->deslocamentos);
+    free(tabela->tamanhos);
+    free(tabela->indice);
+}
+
+// Conjunto de chaves inteiras (IDs ou pares de IDs) com endereçamento aberto e sondagem linear
+typedef struct {
+    uint64_t* chaves;     // guarda chave+1 (0 = posição vazia)
+    uint32_t numChaves;
+    uint32_t capacidade;  // sempre potência de 2
+    int falhou;           // faltou memória: o conjunto não aceita mais chaves e quem o usa deve desistir
+} ConjuntoIds;
+
+static void conjunto_iniciar(ConjuntoIds* conjunto, uint32_t capacidadeInicial) {
+    uint32_t capacidade = 16;
+    while (capacidade < capacidadeInicial * 2) capacidade *= 2;
+    conjunto->numChaves = 0;
+    conjunto->capacidade = capacidade;
+    conjunto->falhou = 0;
+    conjunto->chaves = (uint64_t*) alocar_zerado(capacidade, sizeof(uint64_t));
+    if (!conjunto->chaves) {
+        registrar_falta_de_memoria("o conjunto de estados");
+        conjunto->falhou = 1;
+    }
+}
+
+static uint32_t conjunto_posicao(const ConjuntoIds* conjunto, uint64_t chave) {
+    uint32_t mascara = conjunto->capacidade - 1;
+    uint32_t pos = (uint32_t) hash_chave(chave) & mascara;
+    while (conjunto->chaves[pos] != 0 && conjunto->chaves[pos] != chave + 1) {
+        pos = (pos + 1) & mascara;
+    }
+    return pos;
+}
+
+// Retorna 1 se a chave foi inserida agora e 0 se ela já estava no conjunto (ou se faltou memória,
+// caso em que 'falhou' fica marcado)
+static int conjunto_inserir(ConjuntoIds* conjunto, uint64_t chave) {
+    if (conjunto->falhou) return 0;
+    if ((conjunto->numChaves + 1) * 2 > conjunto->capacidade) {
+        uint64_t* antigas = conjunto->chaves;
+        uint32_t capacidadeAntiga = conjunto->capacidade;
+        uint64_t* novas = (uint64_t*) alocar_zerado((size_t) capacidadeAntiga * 2, sizeof(uint64_t));
+        if (!novas) {
+            registrar_falta_de_memoria("o conjunto de estados");
+            conjunto->falhou = 1;
+            return 0;
+        }
+        conjunto->chaves = novas;
+        conjunto->capacidade = capacidadeAntiga * 2;
+        for (uint32_t i = 0; i < capacidadeAntiga; i++) {
+            if (antigas[i]) conjunto->chaves[conjunto_posicao(conjunto, antigas[i] - 1)] = antigas[i];
+        }
+        free(antigas);
+    }
+
+    uint32_t pos = conjunto_posicao(conjunto, chave);
+    if (conjunto->chaves[pos] != 0) return 0;
+    conjunto->chaves[pos] = chave + 1;
+    conjunto->numChaves++;
+    return 1;
+}
+
+static void conjunto_liberar(ConjuntoIds* conjunto) {
+    free(conjunto->chaves);
+    conjunto->chaves = NULL;
+}
+
+static IdNome internar_estado(MaquinaTuring* maquina, const char* nome) {
+    return internar_nome(&maquina->estados, &maquina->arena, nome, strlen(nome));
+}
+
+static IdNome internar_simbolo(MaquinaTuring* maquina, const char* nome) {
+    return internar_nome(&maquina->simbolos, &maquina->arena, nome, strlen(nome));
+}
+
+MaquinaTuring* criar_maquina(char tipo, int capacidadeInicial) {
+    MaquinaTuring* maquina = (MaquinaTuring*) alocar_zerado(1, sizeof(MaquinaTuring));
+    if (!maquina) {
+        registrar_falta_de_memoria("a máquina");
+        return NULL;
+    }
+
+    maquina->tipo = tipo;
+    maquina->numTransicoes = 0;
+    maquina->capacidadeTransicoes = capacidadeInicial > 0 ? capacidadeInicial : 1;
+    maquina->transicoes = (Transicao*) alocar(maquina->capacidadeTransicoes * sizeof(Transicao));
+    if (!maquina->transicoes) {
+        registrar_falta_de_memoria("as transições");
+        free(maquina);
+        return NULL;
+    }
+    return maquina;
+}
+
+// Fecha a construção de uma máquina: se alguma transição não pôde ser adicionada, a máquina
+// incompleta é descartada (o erro já foi registrado) e o resultado é NULL
+static MaquinaTuring* concluir_maquina(MaquinaTuring* maquina) {
+    if (maquina && maquina->erro != TRADUTOR_OK) {
+        liberar_maquina(maquina);
+        return NULL;
+    }
+    return maquina;
+}
+
+static Transicao* nova_transicao(MaquinaTuring* maquina) {
+    // Checar se o array de transições está cheio e precisa ser realocado
+    if (maquina->numTransicoes >= maquina->capacidadeTransicoes) {
+        int capacidade = maquina->capacidadeTransicoes * 2; // Dobrar a capacidade
+        Transicao* transicoes = (Transicao*) realocar(maquina->transicoes, capacidade * sizeof(Transicao));
+        if (!transicoes) {
+            registrar_falta_de_memoria("as transições");
+            return NULL;
+        }
+        maquina->transicoes = transicoes;
+        maquina->capacidadeTransicoes = capacidade;
+        if (instrumentacao) contar(&instrumentacao->crescimentosTransicoes, 1);
+    }
+    Transicao* t = &maquina->transicoes[maquina->numTransicoes];
+    memset(t, 0, sizeof(Transicao)); // zera o padding para que o registro seja um POD determinístico
+    return t;
+}
+
+
+
+// Avança '*cursor' até o próximo token da linha (separadores: espaço, tab e '\r').
+// Retorna 0 quando a linha acabou. O token é uma visão para dentro do buffer, sem cópia.
+int proximo_token(const char** cursor, const char* fimLinha, const char** token, size_t* tamanho) {
+    const char* p = *cursor;
+    while (p < fimLinha && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    if (p == fimLinha) {
+        *cursor = p;
+        return 0;
+    }
+
+    const char* inicio = p;
+    while (p < fimLinha && *p != ' ' && *p != '\t' && *p != '\r') p++;
+    *token = inicio;
+    *tamanho = (size_t) (p - inicio);
+    *cursor = p;
+    return 1;
+}
+
+// Interpreta uma máquina no formato texto a partir de um buffer em memória, numa única passada.
+// Os nomes são internados diretamente do buffer, que pode ser liberado logo em seguida.
+MaquinaTuring* interpretar_maquina(const char* dados, size_t tamanho) {
+    const char* fim = dados + tamanho;
+
+    // 1. Ler a primeira linha para determinar o tipo da máquina
+    if (tamanho == 0) {
+        registrar_erro(TRADUTOR_ERRO_FORMATO, "Arquivo de entrada vazio ou corrompido.");
+        return NULL;
+    }
+    if (tamanho < 2 || dados[0] != ';' || (dados[1] != 'S' && dados[1] != 'I')) {
+        registrar_erro(TRADUTOR_ERRO_FORMATO, "Primeira linha do arquivo inválida. Esperado ';S' ou ';I'.");
+        return NULL;
+    }
+
+    // Estimar uma transição a cada 16 bytes evita a maior parte dos realloc em arquivos grandes
+    size_t estimativa = tamanho / 16;
+    int capacidadeInicial = estimativa < 10 ? 10 : (estimativa > INT32_MAX / 2 ? INT32_MAX / 2 : (int) estimativa);
+    MaquinaTuring* maquina = criar_maquina(dados[1], capacidadeInicial);
+    if (!maquina) return NULL;
+
+    const char* linha = memchr(dados, '\n', tamanho);
+    linha = linha ? linha + 1 : fim;
+
+    // 2. Ler as transições linha por linha, sem limite de tamanho de linha
+    while (linha < fim && maquina->erro == TRADUTOR_OK) {
+        const char* fimLinha = memchr(linha, '\n', (size_t) (fim - linha));
+        if (!fimLinha) fimLinha = fim;
+
+        // Ignorar linhas vazias ou de comentário
+        if (linha == fimLinha || linha[0] == ';') {
+            linha = fimLinha + 1;
+            continue;
+        }
+
+        const char* tokens[5];
+        size_t tamanhos[5];
+        const char* cursor = linha;
+        int numTokens = 0;
+        while (numTokens < 5 && proximo_token(&cursor, fimLinha, &tokens[numTokens], &tamanhos[numTokens])) {
+            numTokens++;
+        }
+
+        if (numTokens == 5) {
+            // Um nome por comando, na ordem da linha: os IDs seguem a ordem de aparição no arquivo
+            IdNome estA = internar_nome(&maquina->estados, &maquina->arena, tokens[0], tamanhos[0]);
+            IdNome simA = internar_nome(&maquina->simbolos, &maquina->arena, tokens[1], tamanhos[1]);
+            IdNome simN = internar_nome(&maquina->simbolos, &maquina->arena, tokens[2], tamanhos[2]);
+            IdNome estN = internar_nome(&maquina->estados, &maquina->arena, tokens[4], tamanhos[4]);
+            adicionar_transicao_ids(maquina, estA, simA, simN, tokens[3][0], estN);
+        } // Senão, linha mal formatada: ignorada
+
+        linha = fimLinha + 1;
+    }
+
+    return concluir_maquina(maquina);
+}
+
+// Lê todo o conteúdo de um descritor que não pode ser mapeado (pipe, terminal, ...)
+static char* ler_descritor(int fd, size_t* tamanho) {
+    size_t capacidade = 1 << 16;
+    size_t usados = 0;
+    char* dados = (char*) alocar(capacidade);
+    if (!dados) {
+        registrar_falta_de_memoria("a leitura da entrada");
+        return NULL;
+    }
+
+    for (;;) {
+        if (usados == capacidade) {
+            char* maiores = (char*) realocar(dados, capacidade * 2);
+            if (!maiores) {
+                registrar_falta_de_memoria("a leitura da entrada");
+                free(dados);
+                return NULL;
+            }
+            dados = maiores;
+            capacidade *= 2;
+        }
+        ssize_t lidos = read(fd, dados + usados, capacidade - usados);
+        if (lidos < 0) {
+            if (errno == EINTR) continue;
+            registrar_erro(TRADUTOR_ERRO_ARQUIVO, "Falha na leitura da entrada: %s", strerror(errno));
+            free(dados);
+            return NULL;
+        }
+        if (lidos == 0) break;
+        usados += (size_t) lidos;
+    }
+
+    *tamanho = usados;
+    return dados;
+}
+
+// === Formato binário ===
+// Arquivo versionado pensado para ser usado direto do mmap, sem nenhuma interpretação:
+//   CabecalhoBinario
+//   uint32_t deslocamentos[numEstados], tamanhos[numEstados]    (tabela de estados)
+//   uint32_t deslocamentos[numSimbolos], tamanhos[numSimbolos]  (tabela de símbolos)
+//   char arena[tamanhoArena]                                    (nomes terminados em '\0')
+//   Transicao transicoes[numTransicoes]                         (alinhadas em 8 bytes)
+// Os inteiros ficam na ordem de bytes da máquina que gravou, conferida por 'marcaOrdem'.
+#define MAGICA_BINARIA "MTBN"
+#define VERSAO_BINARIA 1u
+#define MARCA_ORDEM_BYTES 0x01020304u
+
+typedef struct {
+    char magica[4];
+    uint32_t versao;
+    uint32_t marcaOrdem;
+    uint32_t tamanhoTransicao;  // sizeof(Transicao) de quem gravou
+    char tipo;
+    char reservado[7];
+    uint32_t numEstados;
+    uint32_t numSimbolos;
+    uint64_t numTransicoes;
+    uint64_t tamanhoArena;
+    uint64_t deslocamentoTransicoes;
+} CabecalhoBinario;
+
+static int eh_formato_binario(const void* dados, size_t tamanho) {
+    return tamanho >= 4 && memcmp(dados, MAGICA_BINARIA, 4) == 0;
+}
+
+static size_t alinhar8(size_t n) {
+    return (n + 7) & ~(size_t) 7;
+}
+
+// Confere que cada nome cabe na arena e termina em '\0', e que cada transição só usa IDs das tabelas
+// e uma direção conhecida. É uma passada só sobre as seções, sem interpretar nada, para que um arquivo
+// corrompido vire TRADUTOR_ERRO_FORMATO em vez de acessos fora da região.
+static int conferir_secoes_binarias(const uint32_t* deslocamentos, const uint32_t* tamanhos, uint32_t numNomes,
+                                    const char* arena, uint64_t tamanhoArena) {
+    for (uint32_t id = 0; id < numNomes; id++) {
+        if ((uint64_t) deslocamentos[id] + tamanhos[id] >= tamanhoArena ||
+            arena[(size_t) deslocamentos[id] + tamanhos[id]] != '\0') return -1;
+    }
+    return 0;
+}
+
+static int conferir_transicoes_binarias(const Transicao* transicoes, uint64_t numTransicoes,
+                                        uint32_t numEstados, uint32_t numSimbolos) {
+    for (uint64_t i = 0; i < numTransicoes; i++) {
+        const Transicao* t = &transicoes[i];
+        if (t->estadoAtual >= numEstados || t->novoEstado >= numEstados ||
+            t->simboloAtual >= numSimbolos || t->novoSimbolo >= numSimbolos) return -1;
+        // 's' é aceito como '*' pelo formato texto e pelo simulador, então também pode estar aqui
+        if (t->direcao != 'l' && t->direcao != 'r' && t->direcao != '*' && t->direcao != 's') return -1;
+    }
+    return 0;
+}
+
+// Constrói uma máquina cujas tabelas e transições apontam para dentro de 'regiao'.
+// Os nomes e as transições são conferidos numa passada só, sem cópia. Em caso de sucesso a região
+// passa a pertencer à máquina; em caso de erro ela continua com quem chamou.
+MaquinaTuring* abrir_maquina_binaria(void* regiao, size_t tamanho, int regiaoMapeada) {
+    const CabecalhoBinario* cab = (const CabecalhoBinario*) regiao;
+    if (tamanho < sizeof(CabecalhoBinario) || !eh_formato_binario(regiao, tamanho)) {
+        registrar_erro(TRADUTOR_ERRO_FORMATO, "Arquivo binário de máquina corrompido.");
+        return NULL;
+    }
+    if (cab->versao != VERSAO_BINARIA || cab->marcaOrdem != MARCA_ORDEM_BYTES || cab->tamanhoTransicao != sizeof(Transicao)) {
+        registrar_erro(TRADUTOR_ERRO_FORMATO, "Arquivo binário de máquina com versão ou plataforma incompatível (versão %u).", cab->versao);
+        return NULL;
+    }
+    if (cab->tipo != 'S' && cab->tipo != 'I') {
+        registrar_erro(TRADUTOR_ERRO_FORMATO, "Tipo de máquina desconhecido '%c' no arquivo binário.", cab->tipo);
+        return NULL;
+    }
+
+    size_t fimTabelas = sizeof(CabecalhoBinario) + 2 * sizeof(uint32_t) * ((size_t) cab->numEstados + cab->numSimbolos);
+    size_t fimArena = fimTabelas + cab->tamanhoArena;
+    if (cab->numTransicoes > INT32_MAX || cab->tamanhoArena > tamanho || fimArena > tamanho || cab->deslocamentoTransicoes < fimArena ||
+        cab->deslocamentoTransicoes % 8 != 0 || cab->deslocamentoTransicoes > tamanho ||
+        cab->numTransicoes > (tamanho - cab->deslocamentoTransicoes) / sizeof(Transicao)) {
+        registrar_erro(TRADUTOR_ERRO_FORMATO, "Arquivo binário de máquina truncado.");
+        return NULL;
+    }
+
+    char* base = (char*) regiao;
+    uint32_t* tabelas = (uint32_t*) (base + sizeof(CabecalhoBinario));
+    uint32_t* tabelaSimbolos = tabelas + 2 * (size_t) cab->numEstados;
+    if (conferir_secoes_binarias(tabelas, tabelas + cab->numEstados, cab->numEstados, base + fimTabelas, cab->tamanhoArena) != 0 ||
+        conferir_secoes_binarias(tabelaSimbolos, tabelaSimbolos + cab->numSimbolos, cab->numSimbolos, base + fimTabelas, cab->tamanhoArena) != 0 ||
+        conferir_transicoes_binarias((const Transicao*) (base + cab->deslocamentoTransicoes), cab->numTransicoes,
+                                     cab->numEstados, cab->numSimbolos) != 0) {
+        registrar_erro(TRADUTOR_ERRO_FORMATO, "Arquivo binário de máquina corrompido.");
+        return NULL;
+    }
+
+    MaquinaTuring* maquina = (MaquinaTuring*) alocar_zerado(1, sizeof(MaquinaTuring));
+    if (!maquina) {
+        registrar_falta_de_memoria("a máquina");
+        return NULL;
+    }
+
+    maquina->tipo = cab->tipo;
+    maquina->estados.numNomes = maquina->estados.capacidadeNomes = cab->numEstados;
+    maquina->estados.deslocamentos = tabelas;
+    maquina->estados.tamanhos = tabelas + cab->numEstados;
+    maquina->simbolos.numNomes = maquina->simbolos.capacidadeNomes = cab->numSimbolos;
+    maquina->simbolos.deslocamentos = tabelaSimbolos;
+    maquina->simbolos.tamanhos = tabelaSimbolos + cab->numSimbolos;
+    maquina->arena.bytes = base + fimTabelas;
+    maquina->arena.usados = maquina->arena.capacidade = cab->tamanhoArena;
+    maquina->transicoes = (Transicao*) (base + cab->deslocamentoTransicoes);
+    maquina->numTransicoes = maquina->capacidadeTransicoes = (int) cab->numTransicoes;
+    maquina->regiao = regiao;
+    maquina->tamanhoRegiao = tamanho;
+    maquina->regiaoMapeada = regiaoMapeada;
+    return maquina;
+}
+
+// Carrega a máquina mapeando o arquivo em memória ("-" lê da entrada padrão).
+// Aceita tanto o formato texto do Morphett quanto o formato binário.
+MaquinaTuring* carregar_maquina(const char* nomeArquivo) {
+    int usarEntradaPadrao = strcmp(nomeArquivo, "-") == 0;
+    int fd = usarEntradaPadrao ? STDIN_FILENO : open(nomeArquivo, O_RDONLY);
+    if (fd < 0) {
+        registrar_erro(TRADUTOR_ERRO_ARQUIVO, "Não foi possível abrir o arquivo '%s': %s", nomeArquivo, strerror(errno));
+        return NULL;
+    }
+
+    MarcaTempo marca = etapa_inicio();
+    MaquinaTuring* maquina = NULL;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        size_t tamanho = (size_t) info.st_size;
+        void* mapa = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapa == MAP_FAILED) {
+            registrar_erro(TRADUTOR_ERRO_ARQUIVO, "Não foi possível mapear o arquivo '%s': %s", nomeArquivo, strerror(errno));
+        } else if (eh_formato_binario(mapa, tamanho)) {
+            // Formato binário: a máquina passa a usar o mapeamento diretamente, sem interpretação
+            maquina = abrir_maquina_binaria(mapa, tamanho, 1);
+            if (!maquina) munmap(mapa, tamanho);
+        } else {
+            madvise(mapa, tamanho, MADV_SEQUENTIAL);
+            maquina = interpretar_maquina((const char*) mapa, tamanho);
+            munmap(mapa, tamanho);
+        }
+    } else {
+        size_t tamanho;
+        char* dados = ler_descritor(fd, &tamanho);
+        if (dados && eh_formato_binario(dados, tamanho)) {
+            maquina = abrir_maquina_binaria(dados, tamanho, 0);
+            if (!maquina) free(dados);
+        } else if (dados) {
+            maquina = interpretar_maquina(dados, tamanho);
+            free(dados);
+        }
+    }
+
+    if (!usarEntradaPadrao) close(fd);
+    etapa_fim(ETAPA_LEITURA, marca);
+    return maquina;
+}
+
+// Lê uma máquina de um buffer em memória, em qualquer dos dois formatos. O buffer não é guardado:
+// uma máquina binária é copiada para uma região própria, que é liberada junto com ela.
+MaquinaTuring* ler_maquina(const void* dados, size_t tamanho) {
+    if (!eh_formato_binario(dados, tamanho)) return interpretar_maquina((const char*) dados, tamanho);
+
+    // A cópia também garante o alinhamento que as tabelas e as transições esperam
+    void* regiao = alocar(tamanho);
+    if (!regiao) {
+        registrar_falta_de_memoria("a máquina binária");
+        return NULL;
+    }
+    memcpy(regiao, dados, tamanho);
+    MaquinaTuring* maquina = abrir_maquina_binaria(regiao, tamanho, 0);
+    if (!maquina) free(regiao);
+    return maquina;
+}
+
+// 'esquema' escolhe a construção da tradução I -> S; é ignorado para máquinas do tipo 'S'
+// Em caso de erro a transição não é adicionada e o código fica em maquina->erro (ver concluir_maquina).
+// Um ID_INEXISTENTE vem de um internar_nome que falhou.
+void adicionar_transicao_ids(MaquinaTuring* maquina, IdNome estA, IdNome simA, IdNome simN, char dir, IdNome estN) {
+    if (maquina->erro != TRADUTOR_OK) return;
+    if (maquina->regiao) {
+        registrar_erro(TRADUTOR_ERRO_SOMENTE_LEITURA, "Máquinas carregadas do formato binário são somente leitura.");
+        maquina->erro = TRADUTOR_ERRO_SOMENTE_LEITURA;
+        return;
+    }
+    if (estA == ID_INEXISTENTE || simA == ID_INEXISTENTE || simN == ID_INEXISTENTE || estN == ID_INEXISTENTE) {
+        maquina->erro = ultimo_codigo_erro();
+        return;
+    }
+    Transicao* t = nova_transicao(maquina);
+    if (!t) {
+        maquina->erro = TRADUTOR_ERRO_MEMORIA;
+        return;
+    }
+    t->estadoAtual  = estA;
+    t->simboloAtual = simA;
+    t->novoSimbolo  = simN;
+    t->direcao      = dir;
+    t->novoEstado   = estN;
+
+    maquina->numTransicoes++;
+}
+
+void adicionar_transicao(MaquinaTuring* maquina, const char* estA, const char* simA, const char* simN, char dir, const char* estN) {
+    // A recusa vem antes de internar qualquer nome: numa máquina binária as tabelas apontam para a região
+    if (maquina->regiao) {
+        adicionar_transicao_ids(maquina, ID_INEXISTENTE, ID_INEXISTENTE, ID_INEXISTENTE, dir, ID_INEXISTENTE);
+        return;
+    }
+    // Os nomes são internados: cada nome distinto é copiado para a arena uma única vez.
+    // Os IDs seguem a ordem em que os nomes aparecem na regra; unir_parcial segue a mesma.
+    IdNome idEstA = internar_estado(maquina, estA);
+    IdNome idSimA = internar_simbolo(maquina, simA);
+    IdNome idSimN = internar_simbolo(maquina, simN);
+    IdNome idEstN = internar_estado(maquina, estN);
+    adicionar_transicao_ids(maquina, idEstA, idSimA, idSimN, dir, idEstN);
+}
+
+// Buffer de saída grande e reutilizável, descarregado com chamadas write() em blocos
+// (ou acumulado em memória, para serializar_maquina)
+typedef struct {
+    int fd;             // -1: a saída vai para 'memoria'
+    char* buffer;
+    size_t usados;
+    uint64_t descarregados; // bytes já entregues ao arquivo ou à memória
+    int falhou;         // depois de um erro de escrita o resto da saída é descartado
+    int bufferProprio;  // 1 se o buffer foi alocado por escritor_abrir
+    char* memoria;
+    size_t tamanhoMemoria;
+    size_t capacidadeMemoria;
+} EscritorSaida;
+
+static void escritor_descarregar(EscritorSaida* escritor) {
+    escritor->descarregados += escritor->usados;
+    if (escritor->fd < 0) {
+        size_t necessario = escritor->tamanhoMemoria + escritor->usados;
+        if (!escritor->falhou && necessario > escritor->capacidadeMemoria) {
+            size_t capacidade = escritor->capacidadeMemoria ? escritor->capacidadeMemoria * 2 : TAMANHO_BUFFER_SAIDA;
+            while (capacidade < necessario) capacidade *= 2;
+            char* memoria = (char*) realocar(escritor->memoria, capacidade);
+            if (!memoria) {
+                registrar_falta_de_memoria("a saída em memória");
+                escritor->falhou = 1;
+            } else {
+                escritor->memoria = memoria;
+                escritor->capacidadeMemoria = capacidade;
+            }
+        }
+        if (!escritor->falhou) {
+            memcpy(escritor->memoria + escritor->tamanhoMemoria, escritor->buffer, escritor->usados);
+            escritor->tamanhoMemoria = necessario;
+        }
+        escritor->usados = 0;
+        return;
+    }
+
+    size_t escritos = 0;
+    while (escritos < escritor->usados && !escritor->falhou) {
+        ssize_t n = write(escritor->fd, escritor->buffer + escritos, escritor->usados - escritos);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            registrar_erro(TRADUTOR_ERRO_ARQUIVO, "Falha na escrita do arquivo de saída: %s", strerror(errno));
+            escritor->falhou = 1;
+            break;
+        }
+        escritos += (size_t) n;
+    }
+    escritor->usados = 0;
+}
+
+// Posição da saída em bytes, contando o que ainda está no buffer
+static uint64_t escritor_posicao(const EscritorSaida* escritor) {
+    return escritor->descarregados + escritor->usados;
+}
+
+static void escritor_bytes(EscritorSaida* escritor, const char* dados, size_t tamanho) {
+    while (tamanho > 0) {
+        if (escritor->usados == TAMANHO_BUFFER_SAIDA) escritor_descarregar(escritor);
+        size_t livre = TAMANHO_BUFFER_SAIDA - escritor->usados;
+        size_t n = tamanho < livre ? tamanho : livre;
+        memcpy(escritor->buffer + escritor->usados, dados, n);
+        escritor->usados += n;
+        dados += n;
+        tamanho -= n;
+    }
+}
+
+// Escreve "<estA> <simA> <simN> <dir> <estN>\n" copiando os bytes dos nomes, cujo tamanho já é conhecido
+static void escritor_transicao(EscritorSaida* escritor, const MaquinaTuring* maquina, const Transicao* t) {
+    const char* campos[4] = {
+        nome_estado(maquina, t->estadoAtual),
+        nome_simbolo(maquina, t->simboloAtual),
+        nome_simbolo(maquina, t->novoSimbolo),
+        nome_estado(maquina, t->novoEstado)
+    };
+    size_t tamanhos[4] = {
+        maquina->estados.tamanhos[t->estadoAtual],
+        maquina->simbolos.tamanhos[t->simboloAtual],
+        maquina->simbolos.tamanhos[t->novoSimbolo],
+        maquina->estados.tamanhos[t->novoEstado]
+    };
+    size_t tamanhoLinha = tamanhos[0] + tamanhos[1] + tamanhos[2] + tamanhos[3] + 6;
+
+    if (escritor->usados + tamanhoLinha > TAMANHO_BUFFER_SAIDA) {
+        escritor_descarregar(escritor);
+        if (tamanhoLinha > TAMANHO_BUFFER_SAIDA) {
+            // Linha maior que o buffer inteiro: caminho lento, campo a campo
+            char direcao[3] = { ' ', t->direcao, ' ' };
+            escritor_bytes(escritor, campos[0], tamanhos[0]);
+            escritor_bytes(escritor, " ", 1);
+            escritor_bytes(escritor, campos[1], tamanhos[1]);
+            escritor_bytes(escritor, " ", 1);
+            escritor_bytes(escritor, campos[2], tamanhos[2]);
+            escritor_bytes(escritor, direcao, 3);
+            escritor_bytes(escritor, campos[3], tamanhos[3]);
+            escritor_bytes(escritor, "\n", 1);
+            return;
+        }
+    }
+
+    char* p = escritor->buffer + escritor->usados;
+    memcpy(p, campos[0], tamanhos[0]); p += tamanhos[0];
+    *p++ = ' ';
+    memcpy(p, campos[1], tamanhos[1]); p += tamanhos[1];
+    *p++ = ' ';
+    memcpy(p, campos[2], tamanhos[2]); p += tamanhos[2];
+    *p++ = ' ';
+    *p++ = t->direcao;
+    *p++ = ' ';
+    memcpy(p, campos[3], tamanhos[3]); p += tamanhos[3];
+    *p++ = '\n';
+    escritor->usados = (size_t) (p - escritor->buffer);
+}
+
+// Abre o arquivo de saída ("-" é a saída padrão). Se 'buffer' for NULL, o escritor aloca o seu.
+static int escritor_abrir(EscritorSaida* escritor, const char* nomeArquivo, char* buffer) {
+    int usarSaidaPadrao = strcmp(nomeArquivo, "-") == 0;
+    memset(escritor, 0, sizeof(*escritor));
+    escritor->bufferProprio = buffer == NULL;
+    escritor->buffer = buffer ? buffer : (char*) alocar(TAMANHO_BUFFER_SAIDA);
+    if (!escritor->buffer) {
+        registrar_falta_de_memoria("o buffer de saída");
+        return -1;
+    }
+    escritor->fd = usarSaidaPadrao ? STDOUT_FILENO : open(nomeArquivo, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (escritor->fd < 0) {
+        registrar_erro(TRADUTOR_ERRO_ARQUIVO, "Não foi possível abrir o arquivo de saída '%s': %s", nomeArquivo, strerror(errno));
+        if (escritor->bufferProprio) free(escritor->buffer);
+        return -1;
+    }
+    if (usarSaidaPadrao) fflush(stdout); // não intercalar com o que o printf ainda tem em buffer
+    return 0;
+}
+
+static int escritor_fechar(EscritorSaida* escritor, const char* nomeArquivo) {
+    escritor_descarregar(escritor);
+    if (escritor->bufferProprio) free(escritor->buffer);
+    if (escritor->fd != STDOUT_FILENO && close(escritor->fd) != 0 && !escritor->falhou) {
+        registrar_erro(TRADUTOR_ERRO_ARQUIVO, "Falha ao fechar o arquivo de saída '%s': %s", nomeArquivo, strerror(errno));
+        escritor->falhou = 1;
+    }
+    return escritor->falhou ? -1 : 0;
+}
+
+static void escrever_maquina_texto(EscritorSaida* escritor, const MaquinaTuring* maquina) {
+    // Escrever a primeira linha com o tipo da máquina
+    char cabecalho[3] = { ';', maquina->tipo, '\n' };
+    escritor_bytes(escritor, cabecalho, sizeof(cabecalho));
+
+    // Fazer um loop e escrever cada transição, convertendo os IDs de volta em nomes
+    for (int i = 0; i < maquina->numTransicoes && !escritor->falhou; i++) {
+        escritor_transicao(escritor, maquina, &maquina->transicoes[i]);
+    }
+}
+
+// Salva a máquina no formato binário: cabeçalho, tabelas de nomes, arena e transições, sem conversão
+static void escrever_maquina_binaria(EscritorSaida* escritor, const MaquinaTuring* maquina) {
+    CabecalhoBinario cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magica, MAGICA_BINARIA, 4);
+    cab.versao = VERSAO_BINARIA;
+    cab.marcaOrdem = MARCA_ORDEM_BYTES;
+    cab.tamanhoTransicao = sizeof(Transicao);
+    cab.tipo = maquina->tipo;
+    cab.numEstados = maquina->estados.numNomes;
+    cab.numSimbolos = maquina->simbolos.numNomes;
+    cab.numTransicoes = (uint64_t) maquina->numTransicoes;
+    cab.tamanhoArena = maquina->arena.usados;
+    size_t fimArena = sizeof(cab) + 2 * sizeof(uint32_t) * ((size_t) cab.numEstados + cab.numSimbolos) + cab.tamanhoArena;
+    cab.deslocamentoTransicoes = alinhar8(fimArena);
+
+    escritor_bytes(escritor, (const char*) &cab, sizeof(cab));
+    escritor_bytes(escritor, (const char*) maquina->estados.deslocamentos, cab.numEstados * sizeof(uint32_t));
+    escritor_bytes(escritor, (const char*) maquina->estados.tamanhos, cab.numEstados * sizeof(uint32_t));
+    escritor_bytes(escritor, (const char*) maquina->simbolos.deslocamentos, cab.numSimbolos * sizeof(uint32_t));
+    escritor_bytes(escritor, (const char*) maquina->simbolos.tamanhos, cab.numSimbolos * sizeof(uint32_t));
+    escritor_bytes(escritor, maquina->arena.bytes, maquina->arena.usados);
+    static const char preenchimento[8] = { 0 };
+    escritor_bytes(escritor, preenchimento, cab.deslocamentoTransicoes - fimArena);
+    escritor_bytes(escritor, (const char*) maquina->transicoes, (size_t) maquina->numTransicoes * sizeof(Transicao));
+}
+
+// Grava a máquina em um arquivo ("-" escreve na saída padrão), no formato texto ou binário.
+// 'buffer' (TAMANHO_BUFFER_SAIDA bytes) pode ser reaproveitado entre gravações; com NULL, um é alocado.
+int gravar_maquina(const MaquinaTuring* maquina, const char* nomeArquivo, int binaria, char* buffer) {
+    if (!maquina) {
+        registrar_erro(TRADUTOR_ERRO_ENTRADA, "Tentativa de salvar uma máquina nula.");
+        return -1;
+    }
+
+    MarcaTempo marca = etapa_inicio();
+    EscritorSaida escritor;
+    if (escritor_abrir(&escritor, nomeArquivo, buffer) != 0) return -1;
+    if (binaria) escrever_maquina_binaria(&escritor, maquina);
+    else escrever_maquina_texto(&escritor, maquina);
+    int resultado = escritor_fechar(&escritor, nomeArquivo);
+    etapa_fim(ETAPA_ESCRITA, marca);
+    return resultado;
+}
+
+int salvar_maquina(const MaquinaTuring* maquina, const char* nomeArquivo) {
+    return gravar_maquina(maquina, nomeArquivo, 0, NULL);
+}
+
+int salvar_maquina_binaria(const MaquinaTuring* maquina, const char* nomeArquivo) {
+    return gravar_maquina(maquina, nomeArquivo, 1, NULL);
+}
+
+// Serializa a máquina em um buffer alocado com malloc, que passa a ser de quem chamou
+int serializar_maquina(const MaquinaTuring* maquina, int binaria, char** dados, size_t* tamanho) {
+    if (!maquina) {
+        registrar_erro(TRADUTOR_ERRO_ENTRADA, "Tentativa de serializar uma máquina nula.");
+        return -1;
+    }
+
+    EscritorSaida escritor;
+    memset(&escritor, 0, sizeof(escritor));
+    escritor.fd = -1;
+    escritor.buffer = (char*) alocar(TAMANHO_BUFFER_SAIDA);
+    if (!escritor.buffer) {
+        registrar_falta_de_memoria("o buffer de saída");
+        return -1;
+    }
+    if (binaria) escrever_maquina_binaria(&escritor, maquina);
+    else escrever_maquina_texto(&escritor, maquina);
+    escritor_descarregar(&escritor);
+    free(escritor.buffer);
+    if (escritor.falhou) {
+        free(escritor.memoria);
+        return -1;
+    }
+    *dados = escritor.memoria;
+    *tamanho = escritor.tamanhoMemoria;
+    return 0;
+}
+
+void liberar_maquina(MaquinaTuring* maquina) {
+    if (!maquina) return;
+
+    if (maquina->regiao) {
+        // Tabelas, nomes e transições estão todos dentro da região do arquivo binário
+        free(maquina->estados.indice);
+        free(maquina->simbolos.indice);
+        if (maquina->regiaoMapeada) munmap(maquina->regiao, maquina->tamanhoRegiao);
+        else free(maquina->regiao);
+        free(maquina);
+        return;
+    }
+
+    // Todos os nomes vivem na arena: uma única liberação no lugar de quatro free() por transição
+    free(maquina->arena.bytes);
+    liberar_tabela(&maquina->estados);
+    liberar_tabela(&maquina->simbolos);
+
+    free(maquina->transicoes);
+    free(maquina);
+}
+
+
+// === Alfabeto e marcadores ===
+// As traduções geram regras para os símbolos que a máquina realmente usa e escolhem marcadores
+// de fita que não colidem com eles.
+
+static int eh_estado_de_parada(const MaquinaTuring* maquina, IdNome estado) {
+    return maquina->estados.tamanhos[estado] >= 4 && strncmp(nome_estado(maquina, estado), "halt", 4) == 0;
+}
+
+// Símbolos que a máquina lê ou escreve, sem o curinga '*', com o branco '_' sempre presente.
+// Retorna a quantidade; 'simbolos' precisa de espaço para numNomes + 1 nomes.
+static int coletar_alfabeto(const MaquinaTuring* maquina, const char** simbolos) {
+    int n = 0, temBranco = 0;
+    for (IdNome id = 0; id < maquina->simbolos.numNomes; id++) {
+        const char* nome = nome_simbolo(maquina, id);
+        if (strcmp(nome, "*") == 0) continue;
+        if (strcmp(nome, "_") == 0) temBranco = 1;
+        simbolos[n++] = nome;
+    }
+    if (!temBranco) simbolos[n++] = "_";
+    return n;
+}
+
+// Escolhe 'quantos' marcadores de um caractere fora do alfabeto, na ordem de preferência abaixo
+// ('#' e '&' primeiro, que são os marcadores tradicionais). Retorna -1 se não houver marcadores livres.
+static int escolher_marcadores(const char** alfabeto, int k, char marcadores[][2], int quantos) {
+    static const char preferidos[] = "#&$%@^~!?|+=<>";
+    const char* candidato = preferidos;
+    for (int m = 0; m < quantos; m++) {
+        for (;; candidato++) {
+            if (!*candidato) {
+                registrar_erro(TRADUTOR_ERRO_TRADUCAO, "Não há marcadores livres fora do alfabeto da máquina.");
+                return -1;
+            }
+            int colide = 0;
+            for (int a = 0; a < k && !colide; a++) colide = alfabeto[a][0] == *candidato && alfabeto[a][1] == '\0';
+            if (!colide) break;
+        }
+        marcadores[m][0] = *candidato++;
+        marcadores[m][1] = '\0';
+    }
+    return 0;
+}
+
+// Alfabeto da máquina em um vetor alocado (ver coletar_alfabeto); 'k' recebe o tamanho. NULL se faltar memória.
+static const char** alfabeto_da_maquina(const MaquinaTuring* maquina, int* k) {
+    const char** alfabeto = (const char**) alocar((maquina->simbolos.numNomes + 1) * sizeof(const char*));
+    if (!alfabeto) {
+        registrar_falta_de_memoria("o alfabeto");
+        return NULL;
+    }
+    *k = coletar_alfabeto(maquina, alfabeto);
+    return alfabeto;
+}
+
+
+// === Nomes derivados ===
+// Os estados auxiliares das traduções têm nomes montados a partir dos da original ("q1_<x>_<e>",
+// "<e>_dir", ...). Como os nomes da entrada não têm limite de tamanho, cada nome derivado é montado num
+// buffer que cresce até caber; um buffer de tamanho fixo cortaria nomes longos e fundiria estados
+// diferentes. Um NomeDerivado guarda um nome por vez e é reaproveitado entre as regras.
+typedef struct {
+    char* bytes;
+    size_t capacidade;
+    int falhou;  // faltou memória: os nomes devolvidos são "" e quem montou deve descartar o resultado
+} NomeDerivado;
+
+static const char* nome_derivado(NomeDerivado* nome, const char* formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    int tamanho = vsnprintf(nome->bytes, nome->capacidade, formato, args);
+    va_end(args);
+    if (tamanho >= 0 && (size_t) tamanho >= nome->capacidade) {
+        size_t capacidade = nome->capacidade ? nome->capacidade : 64;
+        while (capacidade <= (size_t) tamanho) capacidade *= 2;
+        char* bytes = (char*) realocar(nome->bytes, capacidade);
+        if (!bytes) {
+            registrar_falta_de_memoria("um nome de estado");
+            nome->falhou = 1;
+            return "";
+        }
+        nome->bytes = bytes;
+        nome->capacidade = capacidade;
+        va_start(args, formato);
+        vsnprintf(nome->bytes, nome->capacidade, formato, args);
+        va_end(args);
+    }
+    return tamanho < 0 ? "" : nome->bytes;
+}
+
+static void liberar_nome_derivado(NomeDerivado* nome) {
+    free(nome->bytes);
+    nome->bytes = NULL;
+    nome->capacidade = 0;
+}
+
+
+// === Tradução em partes ===
+// As traduções geram as regras de cada item (transição ou estado da original) independentemente dos
+// outros. Com várias threads, cada uma traduz uma faixa contígua de itens numa máquina parcial, com
+// tabelas de nomes próprias, e as parciais são unidas na ordem das faixas. Cada ID local é mapeado
+// para o global na primeira vez que aparece, na ordem em que adicionar_transicao internaria o nome,
+// então a máquina resultante (inclusive a arena) é idêntica à da tradução numa thread só.
+
+// Gera em 'destino' as regras dos itens [inicio, fim)
+typedef void (*TraduzirFaixa)(MaquinaTuring* destino, const void* contexto, int inicio, int fim);
+
+// Abaixo disso, criar as threads e unir as parciais custa mais do que traduzir numa thread só
+#define REGRAS_MINIMAS_POR_PARTE 16384
+
+typedef struct {
+    TraduzirFaixa traduzir;
+    const void* contexto;
+    int inicio;
+    int fim;
+    char tipo;
+    int capacidade;
+    Instrumentacao* instrumentacao;  // a da thread que criou as partes
+    MaquinaTuring* parcial;
+    CodigoErro codigo;      // o erro fica registrado na thread que traduziu a parte
+    char mensagem[512];
+} ParteTraducao;
+
+static void* trabalhador_traducao(void* argumento) {
+    ParteTraducao* parte = (ParteTraducao*) argumento;
+    Instrumentacao* anterior = instrumentacao;
+    instrumentacao = parte->instrumentacao;
+    parte->parcial = criar_maquina(parte->tipo, parte->capacidade);
+    if (parte->parcial) parte->traduzir(parte->parcial, parte->contexto, parte->inicio, parte->fim);
+    if (!parte->parcial || parte->parcial->erro != TRADUTOR_OK) {
+        parte->codigo = ultimo_codigo_erro();
+        snprintf(parte->mensagem, sizeof(parte->mensagem), "%s", ultimo_erro());
+    }
+    instrumentacao = anterior;
+    return NULL;
+}
+
+// ID global do nome que tem o ID 'id' na tabela local; ID_INEXISTENTE se faltar memória
+static IdNome mapear_nome(TabelaNomes* tabela, Arena* arena, const TabelaNomes* tabelaLocal, const Arena* arenaLocal,
+                          IdNome* mapa, IdNome id) {
+    if (mapa[id] == ID_INEXISTENTE) {
+        mapa[id] = internar_nome(tabela, arena, arenaLocal->bytes + tabelaLocal->deslocamentos[id], tabelaLocal->tamanhos[id]);
+    }
+    return mapa[id];
+}
+
+// Acrescenta as transições da parcial a 'destino', na mesma ordem de internação de adicionar_transicao
+static void unir_parcial(MaquinaTuring* destino, const MaquinaTuring* parcial, IdNome* mapaEstados, IdNome* mapaSimbolos) {
+    memset(mapaEstados, 0xff, parcial->estados.numNomes * sizeof(IdNome));
+    memset(mapaSimbolos, 0xff, parcial->simbolos.numNomes * sizeof(IdNome));
+    for (int i = 0; i < parcial->numTransicoes && destino->erro == TRADUTOR_OK; i++) {
+        const Transicao* t = &parcial->transicoes[i];
+        IdNome estA = mapear_nome(&destino->estados, &destino->arena, &parcial->estados, &parcial->arena, mapaEstados, t->estadoAtual);
+        IdNome simA = mapear_nome(&destino->simbolos, &destino->arena, &parcial->simbolos, &parcial->arena, mapaSimbolos, t->simboloAtual);
+        IdNome simN = mapear_nome(&destino->simbolos, &destino->arena, &parcial->simbolos, &parcial->arena, mapaSimbolos, t->novoSimbolo);
+        IdNome estN = mapear_nome(&destino->estados, &destino->arena, &parcial->estados, &parcial->arena, mapaEstados, t->novoEstado);
+        adicionar_transicao_ids(destino, estA, simA, simN, t->direcao, estN);
+    }
+}
+
+// Traduz os itens [0, numItens) em até 'numThreads' partes. 'regrasPorItem' é uma estimativa usada para
+// decidir quantas partes valem a pena. Se não houver memória para as partes, tudo roda nesta thread.
+static void traduzir_em_partes(MaquinaTuring* destino, TraduzirFaixa traduzir, const void* contexto, int numItens,
+                               int regrasPorItem, int numThreads) {
+    if (registroOrigens) numThreads = 1; // as origens são marcadas na máquina de destino, regra a regra
+    long long maximoPartes = (long long) numItens * regrasPorItem / REGRAS_MINIMAS_POR_PARTE;
+    int numPartes = numThreads < maximoPartes ? numThreads : (int) maximoPartes;
+    ParteTraducao* partes = numPartes > 1 ? (ParteTraducao*) alocar_zerado(numPartes, sizeof(ParteTraducao)) : NULL;
+    pthread_t* threads = partes ? (pthread_t*) alocar(numPartes * sizeof(pthread_t)) : NULL;
+    if (!threads) {
+        free(partes);
+        traduzir(destino, contexto, 0, numItens);
+        return;
+    }
+
+    for (int p = 0; p < numPartes; p++) {
+        partes[p].traduzir = traduzir;
+        partes[p].contexto = contexto;
+        partes[p].inicio = (int) ((long long) numItens * p / numPartes);
+        partes[p].fim = (int) ((long long) numItens * (p + 1) / numPartes);
+        partes[p].tipo = destino->tipo;
+        partes[p].instrumentacao = instrumentacao;
+        long long regras = (long long) (partes[p].fim - partes[p].inicio) * regrasPorItem;
+        partes[p].capacidade = regras < (1 << 24) ? (int) regras : (1 << 24);
+    }
+    int criadas = 0;
+    while (criadas < numPartes && pthread_create(&threads[criadas], NULL, trabalhador_traducao, &partes[criadas]) == 0) criadas++;
+    // As partes que ficaram sem thread são traduzidas aqui mesmo
+    for (int p = criadas; p < numPartes; p++) trabalhador_traducao(&partes[p]);
+    for (int p = 0; p < criadas; p++) pthread_join(threads[p], NULL);
+
+    uint32_t maiorEstados = 0, maiorSimbolos = 0;
+    for (int p = 0; p < numPartes; p++) {
+        if (!partes[p].parcial) continue;
+        if (partes[p].parcial->estados.numNomes > maiorEstados) maiorEstados = partes[p].parcial->estados.numNomes;
+        if (partes[p].parcial->simbolos.numNomes > maiorSimbolos) maiorSimbolos = partes[p].parcial->simbolos.numNomes;
+    }
+    IdNome* mapaEstados = (IdNome*) alocar(((size_t) maiorEstados + 1) * sizeof(IdNome));
+    IdNome* mapaSimbolos = (IdNome*) alocar(((size_t) maiorSimbolos + 1) * sizeof(IdNome));
+    if (!mapaEstados || !mapaSimbolos) {
+        registrar_falta_de_memoria("a união das partes da tradução");
+        destino->erro = TRADUTOR_ERRO_MEMORIA;
+    }
+    for (int p = 0; p < numPartes; p++) {
+        if (destino->erro == TRADUTOR_OK && partes[p].codigo != TRADUTOR_OK) {
+            registrar_erro(partes[p].codigo, "%s", partes[p].mensagem);
+            destino->erro = partes[p].codigo;
+        }
+        if (destino->erro == TRADUTOR_OK) unir_parcial(destino, partes[p].parcial, mapaEstados, mapaSimbolos);
+        liberar_maquina(partes[p].parcial);
+    }
+    free(mapaEstados);
+    free(mapaSimbolos);
+    free(threads);
+    free(partes);
+}
+
+
+//  Lógica usada: Para desenvolver uma MT Duplamente Infinita (MT_di) que simule uma MT Sipser, precisamos primeiramente na MT_di mover o cabeçote para a esquerda e marcar o inicio da fita com um simbolo especial (no caso o #). Apartir disso a MT_di reproduz as transições para direita e parado exatamente da mesma forma que a do Sipser, a unica diferença é a o movimento para a esquerda que pode ser que o mesmo leve para o simbolo #, nesse caso o cabeçote deve voltar para a primeira celula (simbolo 0 ou 1). E para fazer essa verificação e garantir a integridade da tradução adicionamos a transição ("#", "#", 'r') para cada estado que possua uma transição para esquerda 'l'.
+
+// Nome do estado na máquina traduzida: com o sufixo '_dir', a menos que seja um estado 'halt' ou o curinga '*'
+static const char* nome_estado_dir(const char* nome, NomeDerivado* buffer) {
+    if (strncmp(nome, "halt", 4) == 0 || strcmp(nome, "*") == 0) return nome;
+    return nome_derivado(buffer, "%s_dir", nome);
+}
+
+// Dados de traduzir_S_para_I lidos pelas partes
+typedef struct {
+    const MaquinaTuring* original;
+    const char* barreira;
+    IdNome curinga;           // ID do estado '*' na original, ou ID_INEXISTENTE
+    const int* primeiraMola;  // por estado da original: a primeira transição 'l' que o leva à barreira, ou -1
+} ContextoSparaI;
+
+// Estado da original que chega na barreira depois da transição 'l' t: o próximo estado ou, se ele for
+// o curinga '*', o próprio estado atual
+static IdNome estado_na_barreira(const Transicao* t, IdNome curinga) {
+    return t->novoEstado == curinga ? t->estadoAtual : t->novoEstado;
+}
+
+// Parte 2 de traduzir_S_para_I para as transições [inicio, fim) da original
+static void traduzir_faixa_S_para_I(MaquinaTuring* maquinaTraduzida, const void* contexto, int inicio, int fim) {
+    const ContextoSparaI* ctx = (const ContextoSparaI*) contexto;
+    const MaquinaTuring* maquinaOriginal = ctx->original;
+    NomeDerivado bufferAtual = { 0 }, bufferNovo = { 0 };
+    for (int i = inicio; i < fim && !bufferAtual.falhou && !bufferNovo.falhou; i++) {
+        const Transicao* t = &maquinaOriginal->transicoes[i];
+        const char* simboloAtual = nome_simbolo(maquinaOriginal, t->simboloAtual);
+        const char* novoSimbolo  = nome_simbolo(maquinaOriginal, t->novoSimbolo);
+
+        // Adiciona o sufixo '_dir', a menos que seja um estado 'halt' (ou o curinga '*')
+        const char* estadoAtualDir = nome_estado_dir(nome_estado(maquinaOriginal, t->estadoAtual), &bufferAtual);
+        const char* novoEstadoDir = nome_estado_dir(nome_estado(maquinaOriginal, t->novoEstado), &bufferNovo);
+        if (bufferAtual.falhou || bufferNovo.falhou) break;
+
+        // Traduz apenas as regras de movimento para a direita ou parado
+        int antes = maquinaTraduzida->numTransicoes;
+        if (t->direcao == 'r' || t->direcao == '*') {
+            // Adiciona a transição traduzida à nova máquina
+            adicionar_transicao(maquinaTraduzida,
+                estadoAtualDir,
+                simboloAtual,
+                novoSimbolo,
+                t->direcao,
+                novoEstadoDir);
+            marcar_origem(maquinaTraduzida, antes, i);
+        }
+
+        else if (t->direcao == 'l') {
+            // Adiciona a transição 'l' normal (caso não seja na barreira)
+            adicionar_transicao(maquinaTraduzida, estadoAtualDir, simboloAtual, novoSimbolo, 'l', novoEstadoDir);
+            marcar_origem(maquinaTraduzida, antes, i);
+            antes = maquinaTraduzida->numTransicoes;
+
+            // Com '*' como próximo estado, quem chega na barreira é o próprio estado atual
+            const char* estadoNaBarreira = strcmp(novoEstadoDir, "*") == 0 ? estadoAtualDir : novoEstadoDir;
+
+            // Cria a regra da mola apenas na primeira vez que o estado aparece como destino de um 'l'
+            if (ctx->primeiraMola[estado_na_barreira(t, ctx->curinga)] == i) {
+                // Adiciona a regra da mola: ao bater na barreira, move para a direita 'r'
+                adicionar_transicao(maquinaTraduzida, estadoNaBarreira, ctx->barreira, ctx->barreira, 'r', estadoNaBarreira);
+                marcar_origem(maquinaTraduzida, antes, ORIGEM_AUXILIAR(REGRAS_MOLA));
+            }
+        }
+
+    }
+    if ((bufferAtual.falhou || bufferNovo.falhou) && maquinaTraduzida->erro == TRADUTOR_OK) maquinaTraduzida->erro = TRADUTOR_ERRO_MEMORIA;
+    liberar_nome_derivado(&bufferAtual);
+    liberar_nome_derivado(&bufferNovo);
+}
+
+static MaquinaTuring* traduzir_S_para_I_paralela(const MaquinaTuring* maquinaOriginal, int numThreads) {
+    MarcaTempo marca = etapa_inicio();
+    MaquinaTuring* maquinaTraduzida = criar_maquina('I', 20);
+    if (!maquinaTraduzida) return NULL;
+
+    // A barreira é '#', a menos que '#' faça parte do alfabeto da máquina
+    int k;
+    const char** alfabeto = alfabeto_da_maquina(maquinaOriginal, &k);
+    if (!alfabeto) {
+        liberar_maquina(maquinaTraduzida);
+        return NULL;
+    }
+    char barreira[1][2];
+    int resultado = escolher_marcadores(alfabeto, k, barreira, 1);
+    free(alfabeto);
+    if (resultado != 0) {
+        liberar_maquina(maquinaTraduzida);
+        return NULL;
+    }
+
+    // A regra da mola de cada estado sai junto da primeira transição 'l' que o leva à barreira. Essa
+    // transição é marcada antes, para que as partes não precisem de um conjunto compartilhado.
+    // Os nomes com '_dir' são distintos para estados distintos, então o ID da original basta.
+    ContextoSparaI contexto;
+    contexto.original = maquinaOriginal;
+    contexto.barreira = barreira[0];
+    contexto.curinga = buscar_nome(&maquinaOriginal->estados, &maquinaOriginal->arena, "*", 1);
+    int* primeiraMola = (int*) alocar(((size_t) maquinaOriginal->estados.numNomes + 1) * sizeof(int));
+    if (!primeiraMola) {
+        registrar_falta_de_memoria("as regras da barreira");
+        liberar_maquina(maquinaTraduzida);
+        return NULL;
+    }
+    memset(primeiraMola, 0xff, ((size_t) maquinaOriginal->estados.numNomes + 1) * sizeof(int));
+    int numMolas = 0;
+    for (int i = 0; i < maquinaOriginal->numTransicoes; i++) {
+        const Transicao* t = &maquinaOriginal->transicoes[i];
+        if (t->direcao != 'l') continue;
+        IdNome estado = estado_na_barreira(t, contexto.curinga);
+        if (primeiraMola[estado] < 0) {
+            primeiraMola[estado] = i;
+            numMolas++;
+        }
+    }
+    contexto.primeiraMola = primeiraMola;
+    etapa_fim(ETAPA_COLETA_ESTADOS, marca);
+    marca = etapa_inicio();
+
+
+    // Parte 1: Move para esquerda e coloca a barreira
+    char marcar[16];
+    snprintf(marcar, sizeof(marcar), "marcar_%s", barreira[0]);
+    adicionar_transicao(maquinaTraduzida, "0", "*", "*", 'l', marcar);
+    adicionar_transicao(maquinaTraduzida, marcar, "*", barreira[0], 'r', "0_dir");
+    contar_regras(REGRAS_PREPARACAO, maquinaTraduzida, 0);
+    marcar_origem(maquinaTraduzida, 0, ORIGEM_AUXILIAR(REGRAS_PREPARACAO));
+
+    // Parte 2: Tratando as transições originais sem problemas (movimento para direita e Parado)
+    int antes = maquinaTraduzida->numTransicoes;
+    traduzir_em_partes(maquinaTraduzida, traduzir_faixa_S_para_I, &contexto, maquinaOriginal->numTransicoes, 1, numThreads);
+    contar_regras(REGRAS_COPIADAS, maquinaTraduzida, antes + numMolas);
+    contar_regras(REGRAS_MOLA, maquinaTraduzida, maquinaTraduzida->numTransicoes - numMolas);
+    etapa_fim(ETAPA_FASE1, marca);
+
+    free(primeiraMola);
+    return concluir_maquina(maquinaTraduzida);
+}
+
+MaquinaTuring* traduzir_S_para_I(const MaquinaTuring* maquinaOriginal) {
+    return traduzir_S_para_I_paralela(maquinaOriginal, 1);
+}
+
+// === Tradução S -> I em fluxo ===
+// Mesma tradução de traduzir_S_para_I, mas lendo uma transição por vez e emitindo as regras
+// traduzidas na hora. Só o conjunto de estados que já têm a regra de barreira fica em memória,
+// então o consumo depende do número de estados destino de movimentos 'l', não do tamanho da máquina.
+// Como o alfabeto não é conhecido de antemão, a barreira é sempre '#' e uma máquina que use '#'
+// como símbolo é recusada.
+
+// Escreve o nome do estado com o sufixo '_dir', a menos que seja um estado 'halt' ou o curinga '*'
+static void escrever_estado_dir(EscritorSaida* escritor, const char* nome, size_t tamanho) {
+    escritor_bytes(escritor, nome, tamanho);
+    if ((tamanho < 4 || strncmp(nome, "halt", 4) != 0) && !(tamanho == 1 && nome[0] == '*')) escritor_bytes(escritor, "_dir", 4);
+}
+
+// Retorna 0 em caso de sucesso e -1 em caso de erro (mensagem em ultimo_erro())
+static int traduzir_fluxo(FILE* entrada, EscritorSaida* saida) {
+    char* linha = NULL;
+    size_t capacidadeLinha = 0;
+    ssize_t tamanho = getline(&linha, &capacidadeLinha, entrada);
+    if (tamanho <= 0) {
+        free(linha);
+        registrar_erro(TRADUTOR_ERRO_FORMATO, "Arquivo de entrada vazio ou corrompido.");
+        return -1;
+    }
+    if (tamanho < 2 || linha[0] != ';' || linha[1] != 'S') {
+        free(linha);
+        registrar_erro(TRADUTOR_ERRO_TRADUCAO, "A tradução em fluxo só aceita máquinas de Sipser (primeira linha ';S').");
+        return -1;
+    }
+
+    // Parte 1: Move para esquerda e coloca a barreira #
+    static const char setup[] = ";I\n0 * * l marcar_#\nmarcar_# * # r 0_dir\n";
+    escritor_bytes(saida, setup, sizeof(setup) - 1);
+
+    // Estados (já com '_dir') que possuem regra de barreira; a arena guarda só esses nomes
+    Arena arena;
+    TabelaNomes estadosComBarreira;
+    memset(&arena, 0, sizeof(arena));
+    memset(&estadosComBarreira, 0, sizeof(estadosComBarreira));
+    char* nomeDir = NULL;
+    size_t capacidadeNomeDir = 0;
+    int interativo = isatty(fileno(entrada));
+    int resultado = 0;
+
+    // Parte 2: cada transição original é traduzida assim que é lida
+    while ((tamanho = getline(&linha, &capacidadeLinha, entrada)) != -1 && !saida->falhou) {
+        // Ignorar linhas vazias ou de comentário
+        if (linha[0] == '\n' || linha[0] == ';') continue;
+
+        const char* tokens[5];
+        size_t tamanhos[5];
+        const char* cursor = linha;
+        const char* fimLinha = linha + tamanho;
+        if (tamanho > 0 && linha[tamanho - 1] == '\n') fimLinha--;
+        int numTokens = 0;
+        while (numTokens < 5 && proximo_token(&cursor, fimLinha, &tokens[numTokens], &tamanhos[numTokens])) numTokens++;
+        if (numTokens < 5) continue; // Linha mal formatada
+
+        char direcao = tokens[3][0];
+        if (direcao != 'r' && direcao != '*' && direcao != 'l') continue;
+        if ((tamanhos[1] == 1 && tokens[1][0] == '#') || (tamanhos[2] == 1 && tokens[2][0] == '#')) {
+            registrar_erro(TRADUTOR_ERRO_TRADUCAO, "A máquina usa o símbolo '#', que é a barreira da tradução em fluxo; use a tradução normal.");
+            resultado = -1;
+            break;
+        }
+
+        char campoDirecao[3] = { ' ', direcao, ' ' };
+        escrever_estado_dir(saida, tokens[0], tamanhos[0]);
+        escritor_bytes(saida, " ", 1);
+        escritor_bytes(saida, tokens[1], tamanhos[1]);
+        escritor_bytes(saida, " ", 1);
+        escritor_bytes(saida, tokens[2], tamanhos[2]);
+        escritor_bytes(saida, campoDirecao, 3);
+        escrever_estado_dir(saida, tokens[4], tamanhos[4]);
+        escritor_bytes(saida, "\n", 1);
+
+        if (direcao == 'l') {
+            // Com '*' como próximo estado, quem chega na barreira é o próprio estado atual
+            int destino = (tamanhos[4] == 1 && tokens[4][0] == '*') ? 0 : 4;
+
+            // Monta o nome com '_dir' para consultar o conjunto de estados com barreira
+            size_t tamanhoDir = tamanhos[destino] + 4;
+            if (tamanhoDir + 1 > capacidadeNomeDir) {
+                char* maior = (char*) realocar(nomeDir, (tamanhoDir + 1) * 2);
+                if (!maior) {
+                    registrar_falta_de_memoria("o nome do estado");
+                    resultado = -1;
+                    break;
+                }
+                nomeDir = maior;
+                capacidadeNomeDir = (tamanhoDir + 1) * 2;
+            }
+            const char* nome = tokens[destino];
+            size_t tamanhoNome = tamanhos[destino];
+            memcpy(nomeDir, nome, tamanhoNome);
+            if ((tamanhoNome >= 4 && strncmp(nome, "halt", 4) == 0) || (tamanhoNome == 1 && nome[0] == '*')) tamanhoDir = tamanhoNome;
+            else memcpy(nomeDir + tamanhoNome, "_dir", 4);
+
+            uint32_t antes = estadosComBarreira.numNomes;
+            if (internar_nome(&estadosComBarreira, &arena, nomeDir, tamanhoDir) == ID_INEXISTENTE) {
+                resultado = -1;
+                break;
+            }
+            if (estadosComBarreira.numNomes != antes) {
+                // Adiciona a regra da mola: ao bater no '#', move para a direita 'r'
+                escritor_bytes(saida, nomeDir, tamanhoDir);
+                escritor_bytes(saida, " # # r ", 7);
+                escritor_bytes(saida, nomeDir, tamanhoDir);
+                escritor_bytes(saida, "\n", 1);
+            }
+        }
+
+        if (interativo) escritor_descarregar(saida);
+    }
+
+    if (ferror(entrada)) {
+        registrar_erro(TRADUTOR_ERRO_ARQUIVO, "Falha na leitura da entrada: %s", strerror(errno));
+        resultado = -1;
+    }
+    free(linha);
+    free(nomeDir);
+    free(arena.bytes);
+    liberar_tabela(&estadosComBarreira);
+    return saida->falhou ? -1 : resultado;
+}
+
+// Traduz a máquina de Sipser lida de 'entrada' direto para o arquivo 'nomeSaida' ("-" é a saída padrão).
+// Um arquivo nomeado é escrito em '<nomeSaida>.tmp' e só substitui o destino se a tradução terminar, para
+// que um erro no meio da entrada não deixe uma saída truncada com cara de válida. Na saída padrão o que
+// já foi escrito não tem como ser desfeito.
+int traduzir_S_para_I_fluxo(FILE* entrada, const char* nomeSaida) {
+    int usarSaidaPadrao = strcmp(nomeSaida, "-") == 0;
+    char* temporario = NULL;
+    if (!usarSaidaPadrao) {
+        temporario = (char*) alocar(strlen(nomeSaida) + 5);
+        if (!temporario) {
+            registrar_falta_de_memoria("o nome do arquivo temporário");
+            return -1;
+        }
+        sprintf(temporario, "%s.tmp", nomeSaida);
+    }
+    const char* destino = usarSaidaPadrao ? nomeSaida : temporario;
+
+    EscritorSaida escritor;
+    if (escritor_abrir(&escritor, destino, NULL) != 0) {
+        free(temporario);
+        return -1;
+    }
+    int resultado = traduzir_fluxo(entrada, &escritor);
+    if (escritor_fechar(&escritor, destino) != 0) resultado = -1;
+    if (temporario) {
+        if (resultado == 0 && rename(temporario, nomeSaida) != 0) {
+            registrar_erro(TRADUTOR_ERRO_ARQUIVO, "Não foi possível substituir o arquivo '%s': %s", nomeSaida, strerror(errno));
+            resultado = -1;
+        }
+        if (resultado != 0) unlink(temporario);
+        free(temporario);
+    }
+    return resultado;
+}
+
+
+// Renomeia o estado "0" original para "inicio" ao ler as transições da máquina original.
+// Isso evita conflitos com o novo estado "0" de pré-processamento na MT de Sipser.
+// A renomeação é feita só na leitura dos nomes, a máquina original não é modificada.
+static const char* nome_estado_I_para_S(const MaquinaTuring* maquinaOriginal, IdNome id) {
+    const char* nome = nome_estado(maquinaOriginal, id);
+    return strcmp(nome, "0") == 0 ? "inicio" : nome;
+}
+
+// Dados de traduzir_I_para_S lidos pelas partes
+typedef struct {
+    const MaquinaTuring* original;
+    const char** alfabeto;
+    int k;
+    const char* esquerdo;
+    const char* direito;
+    const char** estados;  // estados com sub-rotinas de borda, na ordem da primeira aparição
+} ContextoIparaS;
+
+// Fase 1 de traduzir_I_para_S para as transições [inicio, fim) da original.
+// Dentro dos marcadores a fita é a mesma da original, então cada regra é copiada como está;
+// o movimento parado ('s' ou '*') vira o '*' do Morphett.
+static void traduzir_faixa_fase1(MaquinaTuring* maquinaTraduzida, const void* contexto, int inicio, int fim) {
+    const MaquinaTuring* maquinaOriginal = ((const ContextoIparaS*) contexto)->original;
+    for (int i = inicio; i < fim; ++i) {
+        const Transicao* t = &maquinaOriginal->transicoes[i];
+        char direcao = (t->direcao == 'l' || t->direcao == 'r') ? t->direcao : '*';
+        int antes = maquinaTraduzida->numTransicoes;
+        adicionar_transicao(maquinaTraduzida,
+                            nome_estado_I_para_S(maquinaOriginal, t->estadoAtual),
+                            nome_simbolo(maquinaOriginal, t->simboloAtual),
+                            nome_simbolo(maquinaOriginal, t->novoSimbolo),
+                            direcao,
+                            nome_estado_I_para_S(maquinaOriginal, t->novoEstado));
+        marcar_origem(maquinaTraduzida, antes, i);
+    }
+}
+
+// Fase 2 de traduzir_I_para_S para os estados [inicio, fim) da lista.
+// As regras exatas sobre os marcadores têm prioridade sobre as regras '*' da máquina original.
+static void traduzir_faixa_fase2(MaquinaTuring* maquinaTraduzida, const void* contexto, int inicio, int fim) {
+    const ContextoIparaS* ctx = (const ContextoIparaS*) contexto;
+    const char** alfabeto = ctx->alfabeto;
+    int k = ctx->k;
+    const char* esquerdo = ctx->esquerdo;
+    const char* direito = ctx->direito;
+    NomeDerivado nome = { 0 }, destino = { 0 }, nome_q1_amp_e = { 0 }, nome_q2e = { 0 };
+    for (int idx = inicio; idx < fim && !nome.falhou && !destino.falhou && !nome_q1_amp_e.falhou && !nome_q2e.falhou; ++idx) {
+        const char* e = ctx->estados[idx];
+        int antes = maquinaTraduzida->numTransicoes;
+
+        // Borda esquerda: a fita inteira é deslocada uma célula para a direita e o estado 'e'
+        // retoma na célula 1, agora em branco. q1_x_e carrega o símbolo x da célula anterior.
+        adicionar_transicao(maquinaTraduzida, e, esquerdo, esquerdo, 'r', nome_derivado(&destino, "q1___%s", e));
+
+        const char* q1_amp_e = nome_derivado(&nome_q1_amp_e, "q1_amp_%s", e);
+        const char* q2e = nome_derivado(&nome_q2e, "q2%s", e);
+        for (int x = 0; x < k; x++) {
+            const char* q1_x_e = nome_derivado(&nome, "q1_%s_%s", alfabeto[x], e);
+            for (int a = 0; a < k; a++) {
+                adicionar_transicao(maquinaTraduzida, q1_x_e, alfabeto[a], alfabeto[x], 'r', nome_derivado(&destino, "q1_%s_%s", alfabeto[a], e));
+            }
+            adicionar_transicao(maquinaTraduzida, q1_x_e, direito, alfabeto[x], 'r', q1_amp_e);
+        }
+
+        // q1_amp_e -> quando o shift atinge o marcador direito, ele é reescrito uma célula adiante
+        adicionar_transicao(maquinaTraduzida, q1_amp_e, "_", direito, 'l', q2e);
+
+        // q2e: volta até o marcador esquerdo e retorna para o estado original 'e' após o shift
+        adicionar_transicao(maquinaTraduzida, q2e, esquerdo, esquerdo, 'r', e);
+        adicionar_transicao(maquinaTraduzida, q2e, "*", "*", 'l', q2e);
+        marcar_origem(maquinaTraduzida, antes, ORIGEM_AUXILIAR(REGRAS_DESLOCAMENTO));
+
+        // Borda direita: o marcador direito avança uma célula e 'e' lê o branco no seu lugar
+        antes = maquinaTraduzida->numTransicoes;
+        const char* q_amp_e = nome_derivado(&destino, "q_amp%s", e);
+        adicionar_transicao(maquinaTraduzida, e, direito, "_", 'r', q_amp_e);
+        adicionar_transicao(maquinaTraduzida, q_amp_e, "_", direito, 'l', e);
+        marcar_origem(maquinaTraduzida, antes, ORIGEM_AUXILIAR(REGRAS_EXTENSAO));
+    }
+    if ((nome.falhou || destino.falhou || nome_q1_amp_e.falhou || nome_q2e.falhou) && maquinaTraduzida->erro == TRADUTOR_OK) {
+        maquinaTraduzida->erro = TRADUTOR_ERRO_MEMORIA;
+    }
+    liberar_nome_derivado(&nome);
+    liberar_nome_derivado(&destino);
+    liberar_nome_derivado(&nome_q1_amp_e);
+    liberar_nome_derivado(&nome_q2e);
+}
+
+static MaquinaTuring* traduzir_I_para_S_paralela(const MaquinaTuring* maquinaOriginal, int numThreads) {
+    // --- INÍCIO: Parte de inicialização e coleta de estados ---
+    MarcaTempo marca = etapa_inicio();
+
+    MaquinaTuring* maquinaTraduzida = criar_maquina('S', 2000); // suficiente para muitas regras
+    if (!maquinaTraduzida) return NULL;
+
+    // Alfabeto real da máquina e marcadores das pontas da fita: '#' à esquerda e '&' à direita, se estiverem livres
+    int k;
+    const char** alfabeto = alfabeto_da_maquina(maquinaOriginal, &k);
+    char marcadores[2][2];
+    if (!alfabeto || escolher_marcadores(alfabeto, k, marcadores, 2) != 0) {
+        free(alfabeto);
+        liberar_maquina(maquinaTraduzida);
+        return NULL;
+    }
+    const char* esquerdo = marcadores[0];
+    const char* direito = marcadores[1];
+
+    // === Recolher conjunto de estados da maquinaOriginal, garantindo unicidade ===
+    // A unicidade é verificada pelo ID do nome (já mapeado) na máquina traduzida, em O(1) por consulta.
+    // Estados de parada e o curinga '*' não precisam das sub-rotinas de borda.
+    int capEstados = 128;
+    int numEstados = 0;
+    const char** estados = (const char**) alocar(capEstados * sizeof(const char*));
+    if (!estados) {
+        registrar_falta_de_memoria("a lista de estados");
+        free(alfabeto);
+        liberar_maquina(maquinaTraduzida);
+        return NULL;
+    }
+    ConjuntoIds estadosVistos;
+    conjunto_iniciar(&estadosVistos, maquinaOriginal->estados.numNomes);
+
+    // Adiciona o estado atual e o próximo estado de cada transição, lidando com a renomeação de '0' para 'inicio'
+    for (int i = 0; i < maquinaOriginal->numTransicoes; ++i) {
+        const Transicao* t = &maquinaOriginal->transicoes[i];
+        IdNome ids[2] = { t->estadoAtual, t->novoEstado };
+
+        for (int k2 = 0; k2 < 2; ++k2) {
+            const char* nome = nome_estado_I_para_S(maquinaOriginal, ids[k2]);
+            if (strcmp(nome, "*") == 0 || eh_estado_de_parada(maquinaOriginal, ids[k2])) continue;
+            if (!conjunto_inserir(&estadosVistos, internar_estado(maquinaTraduzida, nome))) continue;
+            if (numEstados >= capEstados) {
+                const char** maiores = (const char**) realocar(estados, capEstados * 2 * sizeof(const char*));
+                if (!maiores) {
+                    registrar_falta_de_memoria("a lista de estados");
+                    maquinaTraduzida->erro = TRADUTOR_ERRO_MEMORIA;
+                    break;
+                }
+                estados = maiores;
+                capEstados *= 2;
+            }
+            estados[numEstados++] = nome;
+        }
+    }
+    if (estadosVistos.falhou) maquinaTraduzida->erro = TRADUTOR_ERRO_MEMORIA;
+    conjunto_liberar(&estadosVistos);
+    // Agora 'estados' contém uma lista única de todos os estados (onde '0' já foi renomeado para 'inicio')
+    // --- FIM: Parte de inicialização e coleta de estados ---
+    etapa_fim(ETAPA_COLETA_ESTADOS, marca);
+    marca = etapa_inicio();
+
+    NomeDerivado nome = { 0 }, destino = { 0 };
+
+    // === Agora construir as transicoes pre-processamento ===
+    // O estado '0' é o estado inicial real da MT de Sipser. Ele desloca a palavra uma célula para a
+    // direita, deixando a fita no formato '<esquerdo> palavra <direito>', e entrega o cabeçote a 'inicio'.
+    // O estado '1_x' carrega o símbolo x da célula anterior; '1__' é o fim da palavra.
+    for (int a = 0; a < k; a++) {
+        adicionar_transicao(maquinaTraduzida, "0", alfabeto[a], esquerdo, 'r', nome_derivado(&destino, "1_%s", alfabeto[a]));
+    }
+    for (int x = 0; x < k; x++) {
+        if (strcmp(alfabeto[x], "_") == 0) continue;
+        const char* um_x = nome_derivado(&nome, "1_%s", alfabeto[x]);
+        for (int a = 0; a < k; a++) {
+            adicionar_transicao(maquinaTraduzida, um_x, alfabeto[a], alfabeto[x], 'r', nome_derivado(&destino, "1_%s", alfabeto[a]));
+        }
+    }
+    if ((nome.falhou || destino.falhou) && maquinaTraduzida->erro == TRADUTOR_OK) maquinaTraduzida->erro = TRADUTOR_ERRO_MEMORIA;
+    liberar_nome_derivado(&nome);
+    liberar_nome_derivado(&destino);
+    adicionar_transicao(maquinaTraduzida, "1__", "_", direito, 'l', "2_");
+
+    adicionar_transicao(maquinaTraduzida, "2_", esquerdo, esquerdo, 'r', "inicio");
+    adicionar_transicao(maquinaTraduzida, "2_", "*", "*", 'l', "2_"); // Move para a esquerda até o marcador esquerdo
+    contar_regras(REGRAS_PREPARACAO, maquinaTraduzida, 0);
+    marcar_origem(maquinaTraduzida, 0, ORIGEM_AUXILIAR(REGRAS_PREPARACAO));
+
+    // === FASE 1: Traduzir cada transição original da maquinaOriginal ===
+    int antes = maquinaTraduzida->numTransicoes;
+    ContextoIparaS contexto = { maquinaOriginal, alfabeto, k, esquerdo, direito, estados };
+    traduzir_em_partes(maquinaTraduzida, traduzir_faixa_fase1, &contexto, maquinaOriginal->numTransicoes, 1, numThreads);
+    contar_regras(REGRAS_COPIADAS, maquinaTraduzida, antes);
+    etapa_fim(ETAPA_FASE1, marca);
+    marca = etapa_inicio();
+
+    // === FASE 2: Gerar as sub-rotinas de borda de cada estado ===
+    // Cada estado ganha 2 regras de extensão da borda direita; as demais são do deslocamento
+    antes = maquinaTraduzida->numTransicoes;
+    traduzir_em_partes(maquinaTraduzida, traduzir_faixa_fase2, &contexto, numEstados, k * (k + 1) + 5, numThreads);
+    contar_regras(REGRAS_DESLOCAMENTO, maquinaTraduzida, antes + 2 * numEstados);
+    contar_regras(REGRAS_EXTENSAO, maquinaTraduzida, maquinaTraduzida->numTransicoes - 2 * numEstados);
+    etapa_fim(ETAPA_FASE2, marca);
+
+
+    // === Liberar listas temporarias (os nomes pertencem à máquina original) ===
+    free(estados);
+    free(alfabeto);
+
+    return concluir_maquina(maquinaTraduzida);
+}
+
+MaquinaTuring* traduzir_I_para_S(const MaquinaTuring* maquinaOriginal) {
+    return traduzir_I_para_S_paralela(maquinaOriginal, 1);
+}
+
+MaquinaTuring* traduzir_maquina(const MaquinaTuring* maquinaOriginal, EsquemaIparaS esquema) {
+    return traduzir_maquina_paralela(maquinaOriginal, esquema, 1);
+}
+
+// As construções dobrada e compartilhada são sempre traduzidas numa thread só
+MaquinaTuring* traduzir_maquina_paralela(const MaquinaTuring* maquinaOriginal, EsquemaIparaS esquema, int numThreads) {
+    switch (maquinaOriginal->tipo) {
+        case 'S':
+            return traduzir_S_para_I_paralela(maquinaOriginal, numThreads);
+        case 'I':
+            if (esquema == ESQUEMA_DOBRADO) return traduzir_I_para_S_dobrada(maquinaOriginal);
+            if (esquema == ESQUEMA_COMPARTILHADO) return traduzir_I_para_S_compartilhada(maquinaOriginal);
+            return traduzir_I_para_S_paralela(maquinaOriginal, numThreads);
+        default:
+            registrar_erro(TRADUTOR_ERRO_TRADUCAO, "Tipo de máquina desconhecido '%c'.", maquinaOriginal->tipo);
+            return NULL;
+    }
+}
+
+MaquinaTuring* traduzir_maquina_com_origens(const MaquinaTuring* maquinaOriginal, EsquemaIparaS esquema, int32_t** origens) {
+    RegistroOrigens registro = { NULL, 0, 0 };
+    registroOrigens = &registro;
+    MaquinaTuring* maquinaTraduzida = traduzir_maquina_paralela(maquinaOriginal, esquema, 1);
+    registroOrigens = NULL;
+    if (maquinaTraduzida && registro.falhou) {
+        registrar_falta_de_memoria("as origens das regras");
+        liberar_maquina(maquinaTraduzida);
+        maquinaTraduzida = NULL;
+    }
+    if (!maquinaTraduzida) {
+        free(registro.origens);
+        return NULL;
+    }
+    *origens = registro.origens;
+    return maquinaTraduzida;
+}
+
+
+// === Tradução I -> S incremental ===
+// No formato texto, a saída de traduzir_I_para_S é o cabeçalho, o setup (que só depende do alfabeto
+// e dos marcadores), uma regra por transição da original (fase 1) e um bloco de sub-rotinas de borda
+// por estado (fase 2), que só depende do nome do estado, do alfabeto e dos marcadores. Ao lado da
+// saída fica um manifesto com o alfabeto, os marcadores e a posição do bloco de cada estado.
+// Numa nova execução com o mesmo alfabeto e os mesmos marcadores, os blocos dos estados que continuam
+// na máquina são copiados da saída anterior e só os dos estados novos são gerados. O setup e a fase 1
+// são escritos direto como texto, sem montar a máquina traduzida. O resultado é byte a byte igual ao
+// de traduzir_I_para_S seguido de salvar_maquina, então as funções abaixo precisam acompanhar aquela.
+
+// Escreve "<estA> <simA> <simN> <dir> <estN>\n" a partir dos nomes
+static void escritor_regra(EscritorSaida* escritor, const char* estA, const char* simA, const char* simN, char dir, const char* estN) {
+    char direcao[3] = { ' ', dir, ' ' };
+    escritor_bytes(escritor, estA, strlen(estA));
+    escritor_bytes(escritor, " ", 1);
+    escritor_bytes(escritor, simA, strlen(simA));
+    escritor_bytes(escritor, " ", 1);
+    escritor_bytes(escritor, simN, strlen(simN));
+    escritor_bytes(escritor, direcao, 3);
+    escritor_bytes(escritor, estN, strlen(estN));
+    escritor_bytes(escritor, "\n", 1);
+}
+
+// Setup e fase 1 de traduzir_I_para_S
+static void escrever_inicio_I_para_S(EscritorSaida* escritor, const MaquinaTuring* maquinaOriginal, const char** alfabeto, int k,
+                                     const char* esquerdo, const char* direito) {
+    NomeDerivado nome = { 0 }, destino = { 0 };
+    escritor_bytes(escritor, ";S\n", 3);
+    for (int a = 0; a < k; a++) {
+        escritor_regra(escritor, "0", alfabeto[a], esquerdo, 'r', nome_derivado(&destino, "1_%s", alfabeto[a]));
+    }
+    for (int x = 0; x < k; x++) {
+        if (strcmp(alfabeto[x], "_") == 0) continue;
+        const char* um_x = nome_derivado(&nome, "1_%s", alfabeto[x]);
+        for (int a = 0; a < k; a++) {
+            escritor_regra(escritor, um_x, alfabeto[a], alfabeto[x], 'r', nome_derivado(&destino, "1_%s", alfabeto[a]));
+        }
+    }
+    if (nome.falhou || destino.falhou) escritor->falhou = 1;
+    liberar_nome_derivado(&nome);
+    liberar_nome_derivado(&destino);
+    escritor_regra(escritor, "1__", "_", direito, 'l', "2_");
+    escritor_regra(escritor, "2_", esquerdo, esquerdo, 'r', "inicio");
+    escritor_regra(escritor, "2_", "*", "*", 'l', "2_");
+
+    for (int i = 0; i < maquinaOriginal->numTransicoes; ++i) {
+        const Transicao* t = &maquinaOriginal->transicoes[i];
+        char direcao = (t->direcao == 'l' || t->direcao == 'r') ? t->direcao : '*';
+        escritor_regra(escritor, nome_estado_I_para_S(maquinaOriginal, t->estadoAtual), nome_simbolo(maquinaOriginal, t->simboloAtual),
+                       nome_simbolo(maquinaOriginal, t->novoSimbolo), direcao, nome_estado_I_para_S(maquinaOriginal, t->novoEstado));
+    }
+}
+
+// Bloco da fase 2 de traduzir_I_para_S para o estado 'e'
+static void escrever_bloco_I_para_S(EscritorSaida* escritor, const char* e, const char** alfabeto, int k,
+                                    const char* esquerdo, const char* direito) {
+    NomeDerivado nome = { 0 }, destino = { 0 }, nome_q1_amp_e = { 0 }, nome_q2e = { 0 };
+    escritor_regra(escritor, e, esquerdo, esquerdo, 'r', nome_derivado(&destino, "q1___%s", e));
+    const char* q1_amp_e = nome_derivado(&nome_q1_amp_e, "q1_amp_%s", e);
+    const char* q2e = nome_derivado(&nome_q2e, "q2%s", e);
+    for (int x = 0; x < k; x++) {
+        const char* q1_x_e = nome_derivado(&nome, "q1_%s_%s", alfabeto[x], e);
+        for (int a = 0; a < k; a++) {
+            escritor_regra(escritor, q1_x_e, alfabeto[a], alfabeto[x], 'r', nome_derivado(&destino, "q1_%s_%s", alfabeto[a], e));
+        }
+        escritor_regra(escritor, q1_x_e, direito, alfabeto[x], 'r', q1_amp_e);
+    }
+    escritor_regra(escritor, q1_amp_e, "_", direito, 'l', q2e);
+    escritor_regra(escritor, q2e, esquerdo, esquerdo, 'r', e);
+    escritor_regra(escritor, q2e, "*", "*", 'l', q2e);
+    const char* q_amp_e = nome_derivado(&destino, "q_amp%s", e);
+    escritor_regra(escritor, e, direito, "_", 'r', q_amp_e);
+    escritor_regra(escritor, q_amp_e, "_", direito, 'l', e);
+    if (nome.falhou || destino.falhou || nome_q1_amp_e.falhou || nome_q2e.falhou) escritor->falhou = 1;
+    liberar_nome_derivado(&nome);
+    liberar_nome_derivado(&destino);
+    liberar_nome_derivado(&nome_q1_amp_e);
+    liberar_nome_derivado(&nome_q2e);
+}
+
+// Posição do bloco de cada estado na saída anterior, lida do manifesto
+typedef struct {
+    Arena arena;
+    TabelaNomes estados;
+    uint64_t* inicioBloco;   // indexados pelo ID do estado em 'estados'
+    uint64_t* tamanhoBloco;
+    char* saida;             // saída anterior mapeada em memória
+    size_t tamanhoSaida;
+} SaidaAnterior;
+
+static void liberar_saida_anterior(SaidaAnterior* anterior) {
+    free(anterior->arena.bytes);
+    liberar_tabela(&anterior->estados);
+    free(anterior->inicioBloco);
+    free(anterior->tamanhoBloco);
+    if (anterior->saida) munmap(anterior->saida, anterior->tamanhoSaida);
+    memset(anterior, 0, sizeof(*anterior));
+}
+
+// Próximo token da linha comparado com 'texto'
+static int token_igual(const char** cursor, const char* fimLinha, const char* texto) {
+    const char* token;
+    size_t tamanho;
+    return proximo_token(cursor, fimLinha, &token, &tamanho) && tamanho == strlen(texto) && memcmp(token, texto, tamanho) == 0;
+}
+
+// Próximo token da linha como número decimal
+static int token_numero(const char** cursor, const char* fimLinha, uint64_t* valor) {
+    const char* token;
+    size_t tamanho;
+    if (!proximo_token(cursor, fimLinha, &token, &tamanho) || tamanho > 19) return 0;
+    *valor = 0;
+    for (size_t i = 0; i < tamanho; i++) {
+        if (token[i] < '0' || token[i] > '9') return 0;
+        *valor = *valor * 10 + (uint64_t) (token[i] - '0');
+    }
+    return 1;
+}
+
+// Lê o manifesto e mapeia a saída anterior. Retorna 0 só se o manifesto vale para a saída que está no
+// disco (mesmo tamanho e mesma data de modificação) e foi gerado com o mesmo alfabeto e os mesmos marcadores.
+static int carregar_saida_anterior(SaidaAnterior* anterior, const char* nomeSaida, const char* nomeManifesto,
+                                   const char** alfabeto, int k, const char* esquerdo, const char* direito) {
+    memset(anterior, 0, sizeof(*anterior));
+    struct stat info;
+    int fd = open(nomeManifesto, O_RDONLY);
+    if (fd < 0) return -1;
+    size_t tamanho;
+    char* dados = ler_descritor(fd, &tamanho);
+    close(fd);
+    if (!dados) return -1;
+
+    // Linhas: cabeçalho; "saida <tamanho> <segundos> <nanossegundos>"; "marcadores <esquerdo> <direito>";
+    // "alfabeto <símbolos...>"; e uma linha "<início> <tamanho> <estado>" por bloco
+    int valido = stat(nomeSaida, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0;
+    uint32_t capacidadeBlocos = 0;
+    const char* fim = dados + tamanho;
+    const char* linha = dados;
+    for (int numLinha = 0; valido && linha < fim; numLinha++) {
+        const char* fimLinha = (const char*) memchr(linha, '\n', (size_t) (fim - linha));
+        if (!fimLinha) fimLinha = fim;
+        const char* cursor = linha;
+        uint64_t numeros[3];
+        if (numLinha == 0) {
+            valido = token_igual(&cursor, fimLinha, ";manifesto") && token_igual(&cursor, fimLinha, "I->S") &&
+                     token_igual(&cursor, fimLinha, "1");
+        } else if (numLinha == 1) {
+            valido = token_igual(&cursor, fimLinha, "saida") && token_numero(&cursor, fimLinha, &numeros[0]) &&
+                     token_numero(&cursor, fimLinha, &numeros[1]) && token_numero(&cursor, fimLinha, &numeros[2]) &&
+                     numeros[0] == (uint64_t) info.st_size && numeros[1] == (uint64_t) info.st_mtim.tv_sec &&
+                     numeros[2] == (uint64_t) info.st_mtim.tv_nsec;
+        } else if (numLinha == 2) {
+            valido = token_igual(&cursor, fimLinha, "marcadores") && token_igual(&cursor, fimLinha, esquerdo) &&
+                     token_igual(&cursor, fimLinha, direito);
+        } else if (numLinha == 3) {
+            valido = token_igual(&cursor, fimLinha, "alfabeto");
+            for (int a = 0; a < k && valido; a++) valido = token_igual(&cursor, fimLinha, alfabeto[a]);
+            const char* sobra;
+            size_t tamanhoSobra;
+            valido = valido && !proximo_token(&cursor, fimLinha, &sobra, &tamanhoSobra);
+        } else {
+            const char* nome;
+            size_t tamanhoNome;
+            valido = token_numero(&cursor, fimLinha, &numeros[0]) && token_numero(&cursor, fimLinha, &numeros[1]) &&
+                     proximo_token(&cursor, fimLinha, &nome, &tamanhoNome) &&
+                     numeros[0] + numeros[1] <= (uint64_t) info.st_size && numeros[1] > tamanhoNome;
+            IdNome id = valido ? internar_nome(&anterior->estados, &anterior->arena, nome, tamanhoNome) : ID_INEXISTENTE;
+            valido = id == anterior->estados.numNomes - 1; // um estado repetido invalida o manifesto
+            if (valido && id >= capacidadeBlocos) {
+                capacidadeBlocos = capacidadeBlocos ? capacidadeBlocos * 2 : 1024;
+                uint64_t* inicios = (uint64_t*) realocar(anterior->inicioBloco, capacidadeBlocos * sizeof(uint64_t));
+                if (inicios) anterior->inicioBloco = inicios;
+                uint64_t* tamanhos = (uint64_t*) realocar(anterior->tamanhoBloco, capacidadeBlocos * sizeof(uint64_t));
+                if (tamanhos) anterior->tamanhoBloco = tamanhos;
+                valido = inicios && tamanhos;
+            }
+            if (valido) {
+                anterior->inicioBloco[id] = numeros[0];
+                anterior->tamanhoBloco[id] = numeros[1];
+            }
+        }
+        linha = fimLinha + 1;
+    }
+    free(dados);
+
+    if (valido) {
+        fd = open(nomeSaida, O_RDONLY);
+        void* mapa = fd >= 0 ? mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        if (fd >= 0) close(fd);
+        valido = mapa != MAP_FAILED;
+        if (valido) {
+            anterior->saida = (char*) mapa;
+            anterior->tamanhoSaida = (size_t) info.st_size;
+        }
+    }
+    // Cada bloco precisa começar pela regra do próprio estado
+    for (IdNome id = 0; valido && id < anterior->estados.numNomes; id++) {
+        const char* bloco = anterior->saida + anterior->inicioBloco[id];
+        uint32_t tamanhoNome = anterior->estados.tamanhos[id];
+        valido = memcmp(bloco, anterior->arena.bytes + anterior->estados.deslocamentos[id], tamanhoNome) == 0 && bloco[tamanhoNome] == ' ';
+    }
+    if (!valido) liberar_saida_anterior(anterior);
+    return valido ? 0 : -1;
+}
+
+int traduzir_I_para_S_incremental(const MaquinaTuring* maquinaOriginal, const char* nomeSaida, EstatisticasIncremental* estatisticas) {
+    memset(estatisticas, 0, sizeof(*estatisticas));
+    if (maquinaOriginal->tipo != 'I') {
+        registrar_erro(TRADUTOR_ERRO_TRADUCAO, "A tradução incremental só se aplica a máquinas do tipo 'I'.");
+        return -1;
+    }
+    if (strcmp(nomeSaida, "-") == 0) {
+        registrar_erro(TRADUTOR_ERRO_ENTRADA, "A tradução incremental precisa de um arquivo de saída.");
+        return -1;
+    }
+
+    int k;
+    const char** alfabeto = alfabeto_da_maquina(maquinaOriginal, &k);
+    char marcadores[2][2];
+    if (!alfabeto || escolher_marcadores(alfabeto, k, marcadores, 2) != 0) {
+        free(alfabeto);
+        return -1;
+    }
+    const char* esquerdo = marcadores[0];
+    const char* direito = marcadores[1];
+
+    // Estados com bloco na fase 2, na ordem da primeira aparição (a mesma de traduzir_I_para_S)
+    Arena arena;
+    TabelaNomes estados;
+    memset(&arena, 0, sizeof(arena));
+    memset(&estados, 0, sizeof(estados));
+    int faltouMemoria = 0;
+    for (int i = 0; i < maquinaOriginal->numTransicoes && !faltouMemoria; ++i) {
+        const Transicao* t = &maquinaOriginal->transicoes[i];
+        IdNome ids[2] = { t->estadoAtual, t->novoEstado };
+        for (int k2 = 0; k2 < 2; ++k2) {
+            const char* nome = nome_estado_I_para_S(maquinaOriginal, ids[k2]);
+            if (strcmp(nome, "*") == 0 || eh_estado_de_parada(maquinaOriginal, ids[k2])) continue;
+            if (internar_nome(&estados, &arena, nome, strlen(nome)) == ID_INEXISTENTE) faltouMemoria = 1;
+        }
+    }
+
+    size_t tamanhoNome = strlen(nomeSaida);
+    char* nomeManifesto = (char*) alocar(tamanhoNome + 16);
+    char* temporarioSaida = (char*) alocar(tamanhoNome + 16);
+    char* temporarioManifesto = (char*) alocar(tamanhoNome + 16);
+    uint64_t* inicioBloco = (uint64_t*) alocar(((size_t) estados.numNomes + 1) * sizeof(uint64_t));
+    uint64_t* tamanhoBloco = (uint64_t*) alocar(((size_t) estados.numNomes + 1) * sizeof(uint64_t));
+    if (faltouMemoria || !nomeManifesto || !temporarioSaida || !temporarioManifesto || !inicioBloco || !tamanhoBloco) {
+        if (!faltouMemoria) registrar_falta_de_memoria("a tradução incremental");
+        free(nomeManifesto);
+        free(temporarioSaida);
+        free(temporarioManifesto);
+        free(inicioBloco);
+        free(tamanhoBloco);
+        free(arena.bytes);
+        liberar_tabela(&estados);
+        free(alfabeto);
+        return -1;
+    }
+    sprintf(nomeManifesto, "%s.manifesto", nomeSaida);
+    sprintf(temporarioSaida, "%s.tmp", nomeSaida);
+    sprintf(temporarioManifesto, "%s.manifesto.tmp", nomeSaida);
+
+    SaidaAnterior anterior;
+    int temAnterior = carregar_saida_anterior(&anterior, nomeSaida, nomeManifesto, alfabeto, k, esquerdo, direito) == 0;
+    estatisticas->completa = !temAnterior;
+
+    // A nova saída vai para um arquivo temporário, porque a anterior continua mapeada durante a cópia
+    EscritorSaida escritor;
+    int resultado = escritor_abrir(&escritor, temporarioSaida, NULL);
+    if (resultado == 0) {
+        escrever_inicio_I_para_S(&escritor, maquinaOriginal, alfabeto, k, esquerdo, direito);
+        for (IdNome e = 0; e < estados.numNomes && !escritor.falhou; e++) {
+            const char* nome = arena.bytes + estados.deslocamentos[e];
+            IdNome antigo = temAnterior ? buscar_nome(&anterior.estados, &anterior.arena, nome, estados.tamanhos[e]) : ID_INEXISTENTE;
+            inicioBloco[e] = escritor_posicao(&escritor);
+            if (antigo != ID_INEXISTENTE) {
+                escritor_bytes(&escritor, anterior.saida + anterior.inicioBloco[antigo], anterior.tamanhoBloco[antigo]);
+                estatisticas->blocosReaproveitados++;
+            } else {
+                escrever_bloco_I_para_S(&escritor, nome, alfabeto, k, esquerdo, direito);
+                estatisticas->blocosGerados++;
+            }
+            tamanhoBloco[e] = escritor_posicao(&escritor) - inicioBloco[e];
+        }
+        if (temAnterior) estatisticas->blocosRemovidos = (int) anterior.estados.numNomes - estatisticas->blocosReaproveitados;
+        resultado = escritor_fechar(&escritor, temporarioSaida);
+    }
+    if (temAnterior) liberar_saida_anterior(&anterior);
+
+    // Manifesto da nova saída; ele guarda o tamanho e a data da saída para detectar edições feitas por fora
+    struct stat info;
+    if (resultado == 0 && stat(temporarioSaida, &info) != 0) {
+        registrar_erro(TRADUTOR_ERRO_ARQUIVO, "Não foi possível consultar o arquivo '%s': %s", temporarioSaida, strerror(errno));
+        resultado = -1;
+    }
+    if (resultado == 0) resultado = escritor_abrir(&escritor, temporarioManifesto, NULL);
+    if (resultado == 0) {
+        char linha[160];
+        int n = snprintf(linha, sizeof(linha), ";manifesto I->S 1\nsaida %llu %llu %llu\nmarcadores %s %s\nalfabeto",
+                         (unsigned long long) info.st_size, (unsigned long long) info.st_mtim.tv_sec,
+                         (unsigned long long) info.st_mtim.tv_nsec, esquerdo, direito);
+        escritor_bytes(&escritor, linha, (size_t) n);
+        for (int a = 0; a < k; a++) {
+            escritor_bytes(&escritor, " ", 1);
+            escritor_bytes(&escritor, alfabeto[a], strlen(alfabeto[a]));
+        }
+        escritor_bytes(&escritor, "\n", 1);
+        for (IdNome e = 0; e < estados.numNomes; e++) {
+            n = snprintf(linha, sizeof(linha), "%llu %llu ", (unsigned long long) inicioBloco[e], (unsigned long long) tamanhoBloco[e]);
+            escritor_bytes(&escritor, linha, (size_t) n);
+            escritor_bytes(&escritor, arena.bytes + estados.deslocamentos[e], estados.tamanhos[e]);
+            escritor_bytes(&escritor, "\n", 1);
+        }
+        resultado = escritor_fechar(&escritor, temporarioManifesto);
+    }
+    // A saída é trocada antes do manifesto: se o processo parar no meio, o manifesto antigo não
+    // corresponde mais à saída e a próxima execução gera tudo de novo
+    if (resultado == 0 && (rename(temporarioSaida, nomeSaida) != 0 || rename(temporarioManifesto, nomeManifesto) != 0)) {
+        registrar_erro(TRADUTOR_ERRO_ARQUIVO, "Não foi possível substituir o arquivo '%s': %s", nomeSaida, strerror(errno));
+        resultado = -1;
+    }
+    if (resultado != 0) {
+        unlink(temporarioSaida);
+        unlink(temporarioManifesto);
+    }
+
+    free(nomeManifesto);
+    free(temporarioSaida);
+    free(temporarioManifesto);
+    free(inicioBloco);
+    free(tamanhoBloco);
+    free(arena.bytes);
+    liberar_tabela(&estados);
+    free(alfabeto);
+    return resultado;
+}
+
+
+// === Tradução I -> S com fita dobrada ===
+// A célula i da fita de Sipser guarda o par (original[i], original[-i-1]): a trilha da direita e a
+// da esquerda da fita original dobrada na origem. A célula 0 leva uma marca para o cabeçote saber
+// onde a dobra fica. O estado R_<q> ou L_<q> diz qual trilha está ativa, então cada passo da máquina
+// original vira um único passo, sem deslocar a fita.
+//
+// O par (a, _) sem marca é escrito como o próprio 'a', de modo que a palavra de entrada já é uma
+// fita válida; os demais pares recebem caracteres livres (fora do alfabeto da máquina), começando
+// pela pontuação para não colidir com letras e dígitos que só apareçam na palavra de entrada.
+// São 2k²-k pares para k símbolos (contando o branco) e há 91 candidatos, então a construção só vale
+// para alfabetos de até 6 símbolos; acima disso a tradução falha com TRADUTOR_ERRO_TRADUCAO.
+
+// Índice da regra que vale para (estado, símbolo) na prioridade do Morphett: estado e símbolo exatos,
+// depois símbolo '*', depois estado '*', depois ambos. 'simbolo' pode ser ID_INEXISTENTE (o branco que
+// a máquina nunca cita), que só os curingas leem. Retorna -1 se nenhuma regra se aplica.
+static int regra_aplicavel(const int* regras, const MaquinaTuring* maquina, IdNome estado, IdNome simbolo,
+                           IdNome coringaEstado, IdNome coringaSimbolo) {
+    uint32_t numSimbolos = maquina->simbolos.numNomes;
+    IdNome estados[2] = { estado, coringaEstado };
+    for (int e = 0; e < 2; e++) {
+        if (estados[e] == ID_INEXISTENTE) continue;
+        if (simbolo != ID_INEXISTENTE && regras[(size_t) estados[e] * numSimbolos + simbolo] >= 0) {
+            return regras[(size_t) estados[e] * numSimbolos + simbolo];
+        }
+        if (coringaSimbolo != ID_INEXISTENTE && regras[(size_t) estados[e] * numSimbolos + coringaSimbolo] >= 0) {
+            return regras[(size_t) estados[e] * numSimbolos + coringaSimbolo];
+        }
+    }
+    return -1;
+}
+
+// Regras da máquina por (estado, símbolo), em uma tabela densa; a primeira de cada par vence, como
+// no Morphett. NULL se faltar memória.
+static int* tabela_de_regras(const MaquinaTuring* maquina) {
+    size_t numEntradas = (size_t) maquina->estados.numNomes * maquina->simbolos.numNomes;
+    int* regras = (int*) alocar((numEntradas + 1) * sizeof(int));
+    if (!regras) {
+        registrar_falta_de_memoria("a tabela de regras");
+        return NULL;
+    }
+    for (size_t i = 0; i < numEntradas; i++) regras[i] = -1;
+    for (int i = maquina->numTransicoes - 1; i >= 0; i--) {
+        const Transicao* t = &maquina->transicoes[i];
+        regras[(size_t) t->estadoAtual * maquina->simbolos.numNomes + t->simboloAtual] = i;
+    }
+    return regras;
+}
+
+// Índice do branco no alfabeto montado por coletar_alfabeto, que sempre o inclui
+static int indice_do_branco(const char** alfabeto) {
+    int indice = 0;
+    while (strcmp(alfabeto[indice], "_") != 0) indice++;
+    return indice;
+}
+
+// Caracteres livres para os 2k² pares, na ordem dos índices; o par (a, _) sem marca fica de fora (ver
+// nome_do_par). A verificação repete esta escolha para decodificar a fita. Retorna -1 se não couberem.
+static int nomear_pares(const char** alfabeto, int k, int indiceBranco, char (*nomesPares)[2]) {
+    char usado[256] = { 0 };
+    usado[(unsigned char) '*'] = usado[(unsigned char) ';'] = 1;
+    for (int a = 0; a < k; a++) {
+        if (alfabeto[a][1] == '\0') usado[(unsigned char) alfabeto[a][0]] = 1;
+    }
+    static const char candidatos[] = "!\"$%'()+,-./:<=>?@[\\]^`{|}~"
+                                     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789#&";
+    const char* proximoLivre = candidatos;
+    int numPares = 2 * k * k;
+    for (int p = 0; p < numPares; p++) {
+        int marca = p / (k * k), b = p % k;
+        if (!marca && b == indiceBranco) continue; // (a, _) sem marca é o próprio 'a'
+        while (*proximoLivre && usado[(unsigned char) *proximoLivre]) proximoLivre++;
+        if (!*proximoLivre) {
+            int livres = 0;
+            for (const char* c = candidatos; *c; c++) livres += !usado[(unsigned char) *c];
+            registrar_erro(TRADUTOR_ERRO_TRADUCAO, "Alfabeto grande demais para a fita dobrada: %d símbolos precisam de %d "
+                           "pares de um caractere e só há %d livres. Use a construção padrão ou a compartilhada (-c).",
+                           k, numPares - k, livres);
+            return -1;
+        }
+        nomesPares[p][0] = *proximoLivre++;
+        nomesPares[p][1] = '\0';
+    }
+    return 0;
+}
+
+static const char* nome_do_par(const char** alfabeto, int k, int indiceBranco, char (*nomesPares)[2], int p) {
+    int marca = p / (k * k), a = p / k % k, b = p % k;
+    return (!marca && b == indiceBranco) ? alfabeto[a] : nomesPares[p];
+}
+
+MaquinaTuring* traduzir_I_para_S_dobrada(const MaquinaTuring* maquinaOriginal) {
+    MarcaTempo marca = etapa_inicio();
+
+    // Alfabeto da original e caracteres livres para os pares
+    int numEstadosOriginal = (int) maquinaOriginal->estados.numNomes;
+    int k;
+    const char** alfabeto = alfabeto_da_maquina(maquinaOriginal, &k);
+    int numPares = 2 * k * k;  // o par (a, b) com marca m tem índice (m * k + a) * k + b
+    char (*nomesPares)[2] = (char (*)[2]) alocar(numPares * sizeof(*nomesPares));
+    IdNome* idPares = (IdNome*) alocar(numPares * sizeof(IdNome));
+    IdNome* idAlfabeto = (IdNome*) alocar(k * sizeof(IdNome));
+    IdNome* idTrilhas = (IdNome*) alocar(2 * (size_t) numEstadosOriginal * sizeof(IdNome));
+    if (!alfabeto || !nomesPares || !idPares || !idAlfabeto || !idTrilhas) {
+        if (alfabeto) registrar_falta_de_memoria("os pares da fita dobrada");
+        free(alfabeto);
+        free(nomesPares);
+        free(idPares);
+        free(idAlfabeto);
+        free(idTrilhas);
+        return NULL;
+    }
+
+    int indiceBranco = indice_do_branco(alfabeto);
+    int resultado = nomear_pares(alfabeto, k, indiceBranco, nomesPares);
+
+    MaquinaTuring* maquinaTraduzida = resultado == 0 ? criar_maquina('S', 2 * k * k * 2 * numEstadosOriginal + k) : NULL;
+    int* regras = maquinaTraduzida ? tabela_de_regras(maquinaOriginal) : NULL;
+    if (!regras) {
+        liberar_maquina(maquinaTraduzida);
+        free(alfabeto);
+        free(nomesPares);
+        free(idPares);
+        free(idAlfabeto);
+        free(idTrilhas);
+        return NULL;
+    }
+    for (int p = 0; p < numPares; p++) {
+        idPares[p] = internar_simbolo(maquinaTraduzida, nome_do_par(alfabeto, k, indiceBranco, nomesPares, p));
+    }
+
+    IdNome coringaEstado = buscar_nome(&maquinaOriginal->estados, &maquinaOriginal->arena, "*", 1);
+    IdNome coringaSimbolo = buscar_nome(&maquinaOriginal->simbolos, &maquinaOriginal->arena, "*", 1);
+    for (int a = 0; a < k; a++) {
+        idAlfabeto[a] = buscar_nome(&maquinaOriginal->simbolos, &maquinaOriginal->arena, alfabeto[a], strlen(alfabeto[a]));
+    }
+
+    // Estados R_<q> e L_<q>; os de parada mantêm o nome
+    NomeDerivado nomeTrilha = { 0 };
+    for (int q = 0; q < numEstadosOriginal; q++) {
+        const char* nome = nome_estado(maquinaOriginal, q);
+        for (int trilha = 0; trilha < 2; trilha++) {
+            if (eh_estado_de_parada(maquinaOriginal, q)) {
+                idTrilhas[2 * q + trilha] = internar_estado(maquinaTraduzida, nome);
+            } else {
+                idTrilhas[2 * q + trilha] = internar_estado(maquinaTraduzida, nome_derivado(&nomeTrilha, "%c_%s", trilha == 0 ? 'R' : 'L', nome));
+            }
+        }
+    }
+    if (nomeTrilha.falhou) maquinaTraduzida->erro = TRADUTOR_ERRO_MEMORIA;
+    liberar_nome_derivado(&nomeTrilha);
+
+    etapa_fim(ETAPA_COLETA_ESTADOS, marca);
+    marca = etapa_inicio();
+
+    // Pré-processamento: o estado "0" marca a célula 0 e entrega a fita ao estado inicial original
+    IdNome inicial = buscar_nome(&maquinaOriginal->estados, &maquinaOriginal->arena, "0", 1);
+    IdNome zero = internar_estado(maquinaTraduzida, "0");
+    IdNome destinoInicial = inicial != ID_INEXISTENTE ? idTrilhas[2 * inicial] : internar_estado(maquinaTraduzida, "R_0");
+    for (int a = 0; a < k; a++) {
+        adicionar_transicao_ids(maquinaTraduzida, zero, idPares[a * k + indiceBranco],
+                                idPares[(k + a) * k + indiceBranco], '*', destinoInicial);
+    }
+    contar_regras(REGRAS_PREPARACAO, maquinaTraduzida, 0);
+    marcar_origem(maquinaTraduzida, 0, ORIGEM_AUXILIAR(REGRAS_PREPARACAO));
+    int antes = maquinaTraduzida->numTransicoes;
+
+    // Cada (estado, trilha, par) da fita dobrada executa a regra da original sobre o símbolo da trilha ativa
+    for (int q = 0; q < numEstadosOriginal; q++) {
+        if ((IdNome) q == coringaEstado || eh_estado_de_parada(maquinaOriginal, q)) continue;
+        for (int trilha = 0; trilha < 2; trilha++) {
+            for (int p = 0; p < numPares; p++) {
+                int marca = p / (k * k), a = p / k % k, b = p % k;
+                int ativo = trilha == 0 ? a : b;
+                int r = regra_aplicavel(regras, maquinaOriginal, q, idAlfabeto[ativo], coringaEstado, coringaSimbolo);
+                if (r < 0) continue;
+                const Transicao* t = &maquinaOriginal->transicoes[r];
+
+                int escrito = ativo;
+                if (t->novoSimbolo != coringaSimbolo) {
+                    const char* novo = nome_simbolo(maquinaOriginal, t->novoSimbolo);
+                    for (escrito = 0; strcmp(alfabeto[escrito], novo) != 0; escrito++) {}
+                }
+                int novoPar = trilha == 0 ? (marca * k + escrito) * k + b : (marca * k + a) * k + escrito;
+
+                // Na trilha da esquerda as direções se invertem; sair da origem troca de trilha sem mover
+                char direcao = '*';
+                int novaTrilha = trilha;
+                char paraFora = trilha == 0 ? 'l' : 'r';
+                if (t->direcao == 'l' || t->direcao == 'r') {
+                    if (t->direcao == paraFora && marca) novaTrilha = 1 - trilha;
+                    else if (t->direcao == paraFora) direcao = 'l';
+                    else direcao = 'r';
+                }
+                IdNome destino = t->novoEstado == coringaEstado ? (IdNome) q : t->novoEstado;
+                adicionar_transicao_ids(maquinaTraduzida, idTrilhas[2 * q + trilha], idPares[p], idPares[novoPar],
+                                        direcao, idTrilhas[2 * destino + novaTrilha]);
+                marcar_origem(maquinaTraduzida, maquinaTraduzida->numTransicoes - 1, r);
+            }
+        }
+    }
+    contar_regras(REGRAS_COPIADAS, maquinaTraduzida, antes);
+    etapa_fim(ETAPA_FASE1, marca);
+
+    free(alfabeto);
+    free(nomesPares);
+    free(idPares);
+    free(regras);
+    free(idAlfabeto);
+    free(idTrilhas);
+    return concluir_maquina(maquinaTraduzida);
+}
+
+// === Tradução I -> S com deslocamento compartilhado ===
+// Mesmo formato de fita da tradução por deslocamento ('#' antes do conteúdo, '&' depois, ou os
+// marcadores livres que escolher_marcadores encontrar), mas com uma única sub-rotina de deslocamento
+// para a máquina toda. O endereço de retorno fica em D células de dígitos à esquerda do '#', cada uma
+// com um de B símbolos de um caractere fora do alfabeto (B^D >= número de estados):
+//   [d(D-1)] ... [d1] [d0] [#] [conteúdo] [&]
+// Ao cair no '#', o estado e escreve o seu índice nos dígitos e entra na sub-rotina, que empurra a fita
+// uma célula para a direita; no fim, o estado 'volta' lê os dígitos e devolve o cabeçote a e. Todos
+// os símbolos da saída têm um caractere, como o simulador do Morphett exige, e o tamanho da saída
+// cresce com O((|Q| + |Σ|²)·D) em vez de O(|Q|·|Σ|²).
+
+#define MAX_DIGITOS_RETORNO 16
+
+// Até MAX_DIGITOS_RETORNO caracteres imprimíveis que não são símbolos da máquina nem estão em 'usados'.
+// '*', '_' e ';' ficam de fora por terem significado no formato do Morphett, e aspas e barra invertida
+// para a fita impressa continuar legível.
+static int escolher_digitos(const char** alfabeto, int k, const char* usados, char digitos[][2]) {
+    int b = 0;
+    for (int c = '!'; c <= '~' && b < MAX_DIGITOS_RETORNO; c++) {
+        if (strchr("*_;\"'`\\", c) || strchr(usados, c)) continue;
+        int colide = 0;
+        for (int a = 0; a < k && !colide; a++) colide = alfabeto[a][0] == c && alfabeto[a][1] == '\0';
+        if (colide) continue;
+        digitos[b][0] = (char) c;
+        digitos[b][1] = '\0';
+        b++;
+    }
+    return b;
+}
+
+// Adiciona a regra se ainda não houver uma para (estado, símbolo); a primeira vence, como no Morphett
+static void adicionar_regra_unica(MaquinaTuring* maquina, ConjuntoIds* regras, const char* estA, const char* simA,
+                                  const char* simN, char dir, const char* estN) {
+    IdNome estado = internar_estado(maquina, estA);
+    IdNome simbolo = internar_simbolo(maquina, simA);
+    if (!conjunto_inserir(regras, (uint64_t) estado << 32 | simbolo)) {
+        if (regras->falhou) maquina->erro = TRADUTOR_ERRO_MEMORIA;
+        return;
+    }
+    IdNome novoSimbolo = internar_simbolo(maquina, simN);
+    IdNome novoEstado = internar_estado(maquina, estN);
+    adicionar_transicao_ids(maquina, estado, simbolo, novoSimbolo, dir, novoEstado);
+}
+
+MaquinaTuring* traduzir_I_para_S_compartilhada(const MaquinaTuring* maquinaOriginal) {
+    MarcaTempo marca = etapa_inicio();
+    MaquinaTuring* maquinaTraduzida = criar_maquina('S', maquinaOriginal->numTransicoes + 64);
+    if (!maquinaTraduzida) return NULL;
+    ConjuntoIds regras;
+    conjunto_iniciar(&regras, maquinaOriginal->numTransicoes + 64);
+
+    int k;
+    const char** alfabeto = alfabeto_da_maquina(maquinaOriginal, &k);
+    // Estados que recebem sub-rotinas de borda; a posição no vetor é o endereço de retorno
+    const char** estados = (const char**) alocar((maquinaOriginal->estados.numNomes + 1) * sizeof(const char*));
+    char marcadores[2][2];
+    if (regras.falhou || !alfabeto || !estados || escolher_marcadores(alfabeto, k, marcadores, 2) != 0) {
+        if (!estados) registrar_falta_de_memoria("os estados");
+        free(alfabeto);
+        free(estados);
+        conjunto_liberar(&regras);
+        liberar_maquina(maquinaTraduzida);
+        return NULL;
+    }
+    const char* esquerdo = marcadores[0];
+    const char* direito = marcadores[1];
+    // Os nomes derivados crescem com os nomes da original; 'nome' e 'destino' apontam para o último montado
+    NomeDerivado bufferNome = { 0 }, bufferDestino = { 0 }, bufferPassada = { 0 }, bufferProxima = { 0 };
+    const char* nome = "";
+    const char* destino = "";
+
+    uint32_t numEstados = 0;
+    for (IdNome q = 0; q < maquinaOriginal->estados.numNomes; q++) {
+        const char* e = nome_estado_I_para_S(maquinaOriginal, q);
+        if (strcmp(e, "*") != 0 && !eh_estado_de_parada(maquinaOriginal, q)) estados[numEstados++] = e;
+    }
+
+    // B dígitos e D células, o menor D com B^D >= numEstados
+    char digitos[MAX_DIGITOS_RETORNO][2];
+    char usados[3] = { esquerdo[0], direito[0], '\0' };
+    int b = escolher_digitos(alfabeto, k, usados, digitos);
+    int d = 1;
+    uint64_t enderecos = (uint64_t) b;
+    while (b > 1 && enderecos < numEstados) {
+        enderecos *= (uint64_t) b;
+        d++;
+    }
+    if (b == 0 || enderecos < numEstados) {
+        registrar_erro(TRADUTOR_ERRO_TRADUCAO, "Não há marcadores livres fora do alfabeto da máquina para os endereços de retorno.");
+        free(alfabeto);
+        free(estados);
+        conjunto_liberar(&regras);
+        liberar_maquina(maquinaTraduzida);
+        return NULL;
+    }
+    etapa_fim(ETAPA_COLETA_ESTADOS, marca);
+    marca = etapa_inicio();
+
+    // Pré-processamento: D passadas deslocam a palavra uma célula para a direita cada uma, deixando um
+    // dígito para trás; a última deixa o '#' e escreve o '&' depois da palavra
+    for (int passada = 0; passada < d; passada++) {
+        const char* inicioPassada = passada == 0 ? "0" : nome_derivado(&bufferPassada, "pre%d", passada);
+        const char* proxima = nome_derivado(&bufferProxima, "pre%d", passada + 1);
+        for (int a = 0; a < k; a++) {
+            if (strcmp(alfabeto[a], "_") == 0) {
+                adicionar_regra_unica(maquinaTraduzida, &regras, inicioPassada, "_", digitos[0], 'r', proxima);
+                continue;
+            }
+            destino = nome_derivado(&bufferDestino, "pre%d_%s", passada, alfabeto[a]);
+            adicionar_regra_unica(maquinaTraduzida, &regras, inicioPassada, alfabeto[a], digitos[0], 'r', destino);
+        }
+        for (int x = 0; x < k; x++) {
+            if (strcmp(alfabeto[x], "_") == 0) continue;
+            nome = nome_derivado(&bufferNome, "pre%d_%s", passada, alfabeto[x]);
+            for (int a = 0; a < k; a++) {
+                if (strcmp(alfabeto[a], "_") == 0) {
+                    destino = nome_derivado(&bufferDestino, "pre%d_volta", passada);
+                    adicionar_regra_unica(maquinaTraduzida, &regras, nome, "_", alfabeto[x], 'l', destino);
+                    continue;
+                }
+                destino = nome_derivado(&bufferDestino, "pre%d_%s", passada, alfabeto[a]);
+                adicionar_regra_unica(maquinaTraduzida, &regras, nome, alfabeto[a], alfabeto[x], 'r', destino);
+            }
+        }
+        nome = nome_derivado(&bufferNome, "pre%d_volta", passada);
+        for (int a = 0; a < k; a++) {
+            adicionar_regra_unica(maquinaTraduzida, &regras, nome, alfabeto[a], alfabeto[a], 'l', nome);
+        }
+        adicionar_regra_unica(maquinaTraduzida, &regras, nome, digitos[0], digitos[0], 'r', proxima);
+    }
+    nome = nome_derivado(&bufferNome, "pre%d", d);
+    for (int a = 0; a < k; a++) {
+        if (strcmp(alfabeto[a], "_") == 0) {
+            adicionar_regra_unica(maquinaTraduzida, &regras, nome, "_", esquerdo, 'r', "ini_fim");
+            continue;
+        }
+        destino = nome_derivado(&bufferDestino, "ini_%s", alfabeto[a]);
+        adicionar_regra_unica(maquinaTraduzida, &regras, nome, alfabeto[a], esquerdo, 'r', destino);
+    }
+    for (int x = 0; x < k; x++) {
+        if (strcmp(alfabeto[x], "_") == 0) continue;
+        nome = nome_derivado(&bufferNome, "ini_%s", alfabeto[x]);
+        for (int a = 0; a < k; a++) {
+            if (strcmp(alfabeto[a], "_") == 0) destino = nome_derivado(&bufferDestino, "ini_fim");
+            else destino = nome_derivado(&bufferDestino, "ini_%s", alfabeto[a]);
+            adicionar_regra_unica(maquinaTraduzida, &regras, nome, alfabeto[a], alfabeto[x], 'r', destino);
+        }
+    }
+    adicionar_regra_unica(maquinaTraduzida, &regras, "ini_fim", "_", direito, 'l', "ini_volta");
+    for (int a = 0; a < k; a++) {
+        adicionar_regra_unica(maquinaTraduzida, &regras, "ini_volta", alfabeto[a], alfabeto[a], 'l', "ini_volta");
+    }
+    adicionar_regra_unica(maquinaTraduzida, &regras, "ini_volta", esquerdo, esquerdo, 'r', "inicio");
+    contar_regras(REGRAS_PREPARACAO, maquinaTraduzida, 0);
+    marcar_origem(maquinaTraduzida, 0, ORIGEM_AUXILIAR(REGRAS_PREPARACAO));
+    etapa_fim(ETAPA_FASE1, marca);
+    marca = etapa_inicio();
+
+    // Regras da original; as regras dos marcadores de cada estado vêm antes para terem prioridade sobre os curingas
+    for (uint32_t i = 0; i < numEstados; i++) {
+        const char* e = estados[i];
+
+        // Borda esquerda: escreve o endereço i nos dígitos, do menos significativo (junto ao '#') para o
+        // mais significativo, e entra na sub-rotina pela célula seguinte ao '#'
+        int antes = maquinaTraduzida->numTransicoes;
+        destino = nome_derivado(&bufferDestino, "esc0_%s", e);
+        adicionar_regra_unica(maquinaTraduzida, &regras, e, esquerdo, esquerdo, 'l', destino);
+        uint32_t resto = i;
+        for (int j = 0; j < d; j++) {
+            nome = nome_derivado(&bufferNome, "esc%d_%s", j, e);
+            if (j + 1 < d) destino = nome_derivado(&bufferDestino, "esc%d_%s", j + 1, e);
+            adicionar_regra_unica(maquinaTraduzida, &regras, nome, "*", digitos[resto % (uint32_t) b], j + 1 < d ? 'l' : 'r',
+                                  j + 1 < d ? destino : "pula");
+            resto /= (uint32_t) b;
+        }
+        // Retorno: do dígito mais significativo até o '#', e dali para a célula seguinte já no estado e
+        nome = nome_derivado(&bufferNome, "ret_%s", e);
+        adicionar_regra_unica(maquinaTraduzida, &regras, nome, esquerdo, esquerdo, 'r', e);
+        adicionar_regra_unica(maquinaTraduzida, &regras, nome, "*", "*", 'r', nome);
+        contar_regras(REGRAS_DESLOCAMENTO, maquinaTraduzida, antes);
+        marcar_origem(maquinaTraduzida, antes, ORIGEM_AUXILIAR(REGRAS_DESLOCAMENTO));
+
+        // Borda direita: o '&' avança uma célula
+        antes = maquinaTraduzida->numTransicoes;
+        destino = nome_derivado(&bufferDestino, "ext_%s", e);
+        adicionar_regra_unica(maquinaTraduzida, &regras, e, direito, "_", 'r', destino);
+        adicionar_regra_unica(maquinaTraduzida, &regras, destino, "_", direito, 'l', e);
+        contar_regras(REGRAS_EXTENSAO, maquinaTraduzida, antes);
+        marcar_origem(maquinaTraduzida, antes, ORIGEM_AUXILIAR(REGRAS_EXTENSAO));
+    }
+    etapa_fim(ETAPA_FASE2, marca);
+    marca = etapa_inicio();
+    int antes = maquinaTraduzida->numTransicoes;
+
+    for (int i = 0; i < maquinaOriginal->numTransicoes; i++) {
+        const Transicao* t = &maquinaOriginal->transicoes[i];
+        char direcao = (t->direcao == 'l' || t->direcao == 'r') ? t->direcao : '*';
+        int antesRegra = maquinaTraduzida->numTransicoes;
+        adicionar_regra_unica(maquinaTraduzida, &regras,
+                              nome_estado_I_para_S(maquinaOriginal, t->estadoAtual), nome_simbolo(maquinaOriginal, t->simboloAtual),
+                              nome_simbolo(maquinaOriginal, t->novoSimbolo), direcao,
+                              nome_estado_I_para_S(maquinaOriginal, t->novoEstado));
+        marcar_origem(maquinaTraduzida, antesRegra, i);
+    }
+    contar_regras(REGRAS_COPIADAS, maquinaTraduzida, antes);
+    etapa_fim(ETAPA_FASE1, marca);
+    marca = etapa_inicio();
+    antes = maquinaTraduzida->numTransicoes;
+
+    // Sub-rotina compartilhada: 'pula' atravessa os dígitos e desl_X carrega o símbolo X da célula anterior
+    adicionar_regra_unica(maquinaTraduzida, &regras, "pula", esquerdo, esquerdo, 'r', "desl__");
+    adicionar_regra_unica(maquinaTraduzida, &regras, "pula", "*", "*", 'r', "pula");
+    for (int x = 0; x < k; x++) {
+        nome = nome_derivado(&bufferNome, "desl_%s", alfabeto[x]);
+        for (int a = 0; a < k; a++) {
+            destino = nome_derivado(&bufferDestino, "desl_%s", alfabeto[a]);
+            adicionar_regra_unica(maquinaTraduzida, &regras, nome, alfabeto[a], alfabeto[x], 'r', destino);
+        }
+        adicionar_regra_unica(maquinaTraduzida, &regras, nome, direito, alfabeto[x], 'r', "desl_amp");
+    }
+    adicionar_regra_unica(maquinaTraduzida, &regras, "desl_amp", "_", direito, 'l', "volta");
+    for (int a = 0; a < k; a++) {
+        adicionar_regra_unica(maquinaTraduzida, &regras, "volta", alfabeto[a], alfabeto[a], 'l', "volta");
+    }
+    adicionar_regra_unica(maquinaTraduzida, &regras, "volta", esquerdo, esquerdo, 'l', "dec0_0");
+
+    // Leitura do endereço: dec<j>_<v> está no dígito j e já leu v dos dígitos 0..j-1. Só existem os
+    // prefixos de endereços válidos, então a árvore tem O(numEstados) nós.
+    uint64_t peso = 1;
+    for (int j = 0; j < d; j++, peso *= (uint64_t) b) {
+        for (uint64_t v = 0; v < peso && v < numEstados; v++) {
+            nome = nome_derivado(&bufferNome, "dec%d_%llu", j, (unsigned long long) v);
+            for (int digito = 0; digito < b; digito++) {
+                uint64_t w = v + (uint64_t) digito * peso;
+                if (w >= numEstados) break;
+                if (j + 1 < d) {
+                    destino = nome_derivado(&bufferDestino, "dec%d_%llu", j + 1, (unsigned long long) w);
+                    adicionar_regra_unica(maquinaTraduzida, &regras, nome, digitos[digito], digitos[digito], 'l', destino);
+                } else {
+                    destino = nome_derivado(&bufferDestino, "ret_%s", estados[w]);
+                    adicionar_regra_unica(maquinaTraduzida, &regras, nome, digitos[digito], digitos[digito], 'r', destino);
+                }
+            }
+        }
+    }
+    contar_regras(REGRAS_DESLOCAMENTO, maquinaTraduzida, antes);
+    marcar_origem(maquinaTraduzida, antes, ORIGEM_AUXILIAR(REGRAS_DESLOCAMENTO));
+    etapa_fim(ETAPA_FASE2, marca);
+    if ((bufferNome.falhou || bufferDestino.falhou || bufferPassada.falhou || bufferProxima.falhou) && maquinaTraduzida->erro == TRADUTOR_OK) {
+        maquinaTraduzida->erro = TRADUTOR_ERRO_MEMORIA;
+    }
+
+    liberar_nome_derivado(&bufferNome);
+    liberar_nome_derivado(&bufferDestino);
+    liberar_nome_derivado(&bufferPassada);
+    liberar_nome_derivado(&bufferProxima);
+    conjunto_liberar(&regras);
+    free(alfabeto);
+    free(estados);
+    return concluir_maquina(maquinaTraduzida);
+}
+
+// === Otimização ===
+// Passada opcional entre a tradução e a gravação: remove regras de estados que nunca executam,
+// regras sombreadas por uma anterior do mesmo (estado, símbolo) e funde grupos de regras iguais
+// em uma regra com o curinga '*'. A execução a partir do estado "0", sobre palavras do alfabeto
+// da máquina, é a mesma da máquina de entrada.
+
+// Chave de agrupamento de uma regra exata: o que ela escreve, para onde anda e para que estado vai
+typedef struct {
+    uint32_t escrita;   // símbolo escrito, ou ID_INEXISTENTE se a regra mantém o símbolo lido
+    uint32_t destino;
+    char direcao;
+    int indice;         // posição da regra na máquina
+} ChaveRegra;
+
+static int comparar_chaves(const void* a, const void* b) {
+    const ChaveRegra* x = (const ChaveRegra*) a;
+    const ChaveRegra* y = (const ChaveRegra*) b;
+    if (x->escrita != y->escrita) return x->escrita < y->escrita ? -1 : 1;
+    if (x->destino != y->destino) return x->destino < y->destino ? -1 : 1;
+    if (x->direcao != y->direcao) return x->direcao < y->direcao ? -1 : 1;
+    return x->indice - y->indice;
+}
+
+MaquinaTuring* otimizar_maquina(const MaquinaTuring* maquina, EstatisticasOtimizacao* estatisticas) {
+    int n = maquina->numTransicoes;
+    uint32_t numEstados = maquina->estados.numNomes;
+    uint32_t numSimbolos = maquina->simbolos.numNomes;
+    IdNome coringaEstado = buscar_nome(&maquina->estados, &maquina->arena, "*", 1);
+    IdNome coringaSimbolo = buscar_nome(&maquina->simbolos, &maquina->arena, "*", 1);
+    IdNome branco = buscar_nome(&maquina->simbolos, &maquina->arena, "_", 1);
+    IdNome inicial = buscar_nome(&maquina->estados, &maquina->arena, "0", 1);
+    memset(estatisticas, 0, sizeof(*estatisticas));
+    estatisticas->regrasAntes = n;
+
+    // Regras agrupadas por estado (ordenação por contagem, mantendo a ordem original dentro do estado)
+    int* inicioEstado = (int*) alocar_zerado(numEstados + 1, sizeof(int));
+    int* porEstado = (int*) alocar((n + 1) * sizeof(int));
+    uint8_t* alcancavel = (uint8_t*) alocar_zerado(numEstados + 1, 1);
+    uint32_t* fila = (uint32_t*) alocar((numEstados + 1) * sizeof(uint32_t));
+    uint8_t* manter = (uint8_t*) alocar(n + 1);
+    int* fusao = (int*) alocar((n + 1) * sizeof(int));  // escrita do grupo fundido que começa na regra (-2: mantém; -1: sem fusão)
+    ChaveRegra* chaves = (ChaveRegra*) alocar((n + 1) * sizeof(ChaveRegra));
+    int* proximo = (int*) alocar((numEstados + 1) * sizeof(int));
+    if (!inicioEstado || !porEstado || !alcancavel || !fila || !manter || !fusao || !chaves || !proximo) {
+        registrar_falta_de_memoria("a otimização");
+        free(inicioEstado);
+        free(porEstado);
+        free(alcancavel);
+        free(fila);
+        free(manter);
+        free(fusao);
+        free(chaves);
+        free(proximo);
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) inicioEstado[maquina->transicoes[i].estadoAtual + 1]++;
+    for (uint32_t e = 0; e < numEstados; e++) inicioEstado[e + 1] += inicioEstado[e];
+    memcpy(proximo, inicioEstado, numEstados * sizeof(int));
+    for (int i = 0; i < n; i++) porEstado[proximo[maquina->transicoes[i].estadoAtual]++] = i;
+    free(proximo);
+
+    // Estados alcançáveis a partir de "0"; as regras do estado '*' valem para todos os estados
+    int tamanhoFila = 0;
+    if (inicial != ID_INEXISTENTE) {
+        alcancavel[inicial] = 1;
+        fila[tamanhoFila++] = inicial;
+    } else {
+        for (uint32_t e = 0; e < numEstados; e++) alcancavel[e] = 1; // sem estado inicial conhecido, nada é podado
+    }
+    for (int f = 0; f < tamanhoFila; f++) {
+        uint32_t q = fila[f];
+        if (eh_estado_de_parada(maquina, q)) continue;
+        for (int passo = 0; passo < 2; passo++) {
+            uint32_t origem = passo == 0 ? q : coringaEstado;
+            if (origem == ID_INEXISTENTE) continue;
+            for (int j = inicioEstado[origem]; j < inicioEstado[origem + 1]; j++) {
+                IdNome destino = maquina->transicoes[porEstado[j]].novoEstado;
+                if (destino == coringaEstado) continue;  // '*' mantém o estado atual
+                if (!alcancavel[destino]) {
+                    alcancavel[destino] = 1;
+                    fila[tamanhoFila++] = destino;
+                }
+            }
+        }
+    }
+
+    // Regras que executam: estado alcançável e não de parada, e primeira do seu (estado, símbolo)
+    ConjuntoIds vistas;
+    conjunto_iniciar(&vistas, n);
+    for (int i = 0; i < n; i++) {
+        const Transicao* t = &maquina->transicoes[i];
+        fusao[i] = -1;
+        manter[i] = 0;
+        if (t->estadoAtual != coringaEstado && (!alcancavel[t->estadoAtual] || eh_estado_de_parada(maquina, t->estadoAtual))) {
+            estatisticas->inalcancaveis++;
+        } else if (!conjunto_inserir(&vistas, (uint64_t) t->estadoAtual << 32 | t->simboloAtual)) {
+            estatisticas->duplicadas++;
+        } else {
+            manter[i] = 1;
+        }
+    }
+    int faltouMemoria = vistas.falhou;
+    conjunto_liberar(&vistas);
+
+    // Fusão em curinga: só em estados cujas regras exatas cobrem todo o alfabeto (com o branco), para
+    // que a regra '*' não passe a valer para um símbolo que antes não tinha regra. O maior grupo de
+    // regras com a mesma ação vira 'q * ...'; uma regra 'q * ...' anterior já não executava.
+    uint32_t tamanhoAlfabeto = numSimbolos - (coringaSimbolo != ID_INEXISTENTE);
+    for (uint32_t q = 0; q < numEstados && branco != ID_INEXISTENTE; q++) {
+        if (q == coringaEstado || !alcancavel[q] || eh_estado_de_parada(maquina, q)) continue;
+        int numChaves = 0;
+        int regraCoringa = -1;
+        for (int j = inicioEstado[q]; j < inicioEstado[q + 1]; j++) {
+            int i = porEstado[j];
+            if (!manter[i]) continue;
+            const Transicao* t = &maquina->transicoes[i];
+            if (t->simboloAtual == coringaSimbolo) {
+                regraCoringa = i;
+                continue;
+            }
+            ChaveRegra chave;
+            chave.escrita = (t->novoSimbolo == t->simboloAtual || t->novoSimbolo == coringaSimbolo) ? ID_INEXISTENTE : t->novoSimbolo;
+            chave.destino = t->novoEstado == coringaEstado ? q : t->novoEstado;
+            chave.direcao = t->direcao;
+            chave.indice = i;
+            chaves[numChaves++] = chave;
+        }
+        if ((uint32_t) numChaves != tamanhoAlfabeto || numChaves < 2) continue;
+
+        qsort(chaves, numChaves, sizeof(ChaveRegra), comparar_chaves);
+        int melhorInicio = 0, melhorTamanho = 1;
+        for (int c = 0; c < numChaves;) {
+            int fim = c + 1;
+            while (fim < numChaves && chaves[fim].escrita == chaves[c].escrita && chaves[fim].destino == chaves[c].destino &&
+                   chaves[fim].direcao == chaves[c].direcao) fim++;
+            if (fim - c > melhorTamanho) {
+                melhorInicio = c;
+                melhorTamanho = fim - c;
+            }
+            c = fim;
+        }
+        if (melhorTamanho < 2) continue;
+
+        // A regra fundida fica na posição da primeira regra do grupo (as chaves do grupo estão em ordem de índice)
+        for (int c = melhorInicio; c < melhorInicio + melhorTamanho; c++) manter[chaves[c].indice] = 0;
+        int primeira = chaves[melhorInicio].indice;
+        manter[primeira] = 1;
+        fusao[primeira] = chaves[melhorInicio].escrita == ID_INEXISTENTE ? -2 : (int) chaves[melhorInicio].escrita;
+        estatisticas->fundidas += melhorTamanho - 1;
+        if (regraCoringa >= 0) {
+            manter[regraCoringa] = 0;
+            estatisticas->duplicadas++;
+        }
+    }
+
+    MaquinaTuring* otimizada = faltouMemoria ? NULL : criar_maquina(maquina->tipo, n);
+    for (int i = 0; i < n && otimizada; i++) {
+        if (!manter[i]) continue;
+        const Transicao* t = &maquina->transicoes[i];
+        if (fusao[i] == -1) {
+            adicionar_transicao(otimizada, nome_estado(maquina, t->estadoAtual), nome_simbolo(maquina, t->simboloAtual),
+                                nome_simbolo(maquina, t->novoSimbolo), t->direcao, nome_estado(maquina, t->novoEstado));
+        } else {
+            const char* escrita = fusao[i] == -2 ? "*" : nome_simbolo(maquina, (IdNome) fusao[i]);
+            adicionar_transicao(otimizada, nome_estado(maquina, t->estadoAtual), "*", escrita, t->direcao,
+                                nome_estado(maquina, t->novoEstado));
+        }
+    }
+    if (otimizada) estatisticas->regrasDepois = otimizada->numTransicoes;
+
+    free(inicioEstado);
+    free(porEstado);
+    free(alcancavel);
+    free(fila);
+    free(manter);
+    free(fusao);
+    free(chaves);
+    return concluir_maquina(otimizada);
+}
+
+
+// === Minimização ===
+// Passada opcional que funde estados equivalentes: dois estados são equivalentes quando, para todo
+// símbolo, fazem a mesma ação (escrita e direção) e vão para estados equivalentes. É o algoritmo de
+// Hopcroft sobre a tabela [estado][símbolo] já com os curingas resolvidos, com uma coluna extra para
+// os símbolos que a máquina nunca cita (lidos só pelos curingas) e um sumidouro para "sem regra".
+// O nome do estado final faz parte do resultado, então nunca são fundidos os estados em que uma
+// execução pode terminar: os de parada e os que não têm regra para algum símbolo.
+// Cada classe mantém o nome de um representante (o "0", se ele estiver na classe) e só as regras
+// dele; o custo é O(k n log n) para n estados e k símbolos.
+
+// Assinatura de um estado para a partição inicial: a ação em cada coluna, sem os destinos
+static uint64_t hash_assinatura(const uint64_t* acoes, uint32_t numColunas) {
+    uint64_t h = 1469598103934665603ull;
+    for (uint32_t c = 0; c < numColunas; c++) h = hash_chave(h ^ acoes[c]);
+    return h;
+}
+
+typedef struct {
+    uint64_t hash;
+    uint32_t estado;
+} AssinaturaEstado;
+
+static int comparar_assinaturas(const void* a, const void* b) {
+    const AssinaturaEstado* x = (const AssinaturaEstado*) a;
+    const AssinaturaEstado* y = (const AssinaturaEstado*) b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return x->estado < y->estado ? -1 : (x->estado > y->estado);
+}
+
+MaquinaTuring* minimizar_maquina(const MaquinaTuring* maquina, EstatisticasMinimizacao* estatisticas) {
+    uint32_t numEstados = maquina->estados.numNomes;
+    uint32_t numSimbolos = maquina->simbolos.numNomes;
+    IdNome coringaEstado = buscar_nome(&maquina->estados, &maquina->arena, "*", 1);
+    IdNome coringaSimbolo = buscar_nome(&maquina->simbolos, &maquina->arena, "*", 1);
+    IdNome inicial = buscar_nome(&maquina->estados, &maquina->arena, "0", 1);
+    memset(estatisticas, 0, sizeof(*estatisticas));
+    estatisticas->estadosAntes = (int) numEstados - (coringaEstado != ID_INEXISTENTE);
+    estatisticas->regrasAntes = maquina->numTransicoes;
+
+    // Colunas: os símbolos da máquina (menos o '*') e uma coluna para qualquer outro símbolo.
+    // Estados: os da máquina e o sumidouro 'numEstados', destino de todo par sem regra.
+    uint32_t numColunas = numSimbolos - (coringaSimbolo != ID_INEXISTENTE) + 1;
+    uint32_t numNos = numEstados + 1;
+    uint32_t sumidouro = numEstados;
+    size_t numPares = (size_t) numNos * numColunas;
+
+    // Tudo é alocado de uma vez: cada divisão empilha numColunas divisores e há no máximo numNos
+    // classes, então a pilha cabe em numPares; um divisor atinge no máximo um estado por estado.
+    IdNome* simboloDaColuna = (IdNome*) alocar(numColunas * sizeof(IdNome));
+    int* regras = tabela_de_regras(maquina);
+    uint32_t* destino = (uint32_t*) alocar(numPares * sizeof(uint32_t));
+    uint64_t* acoes = (uint64_t*) alocar(numPares * sizeof(uint64_t));
+    uint32_t* elementos = (uint32_t*) alocar(numNos * sizeof(uint32_t));
+    uint32_t* posicao = (uint32_t*) alocar(numNos * sizeof(uint32_t));
+    uint32_t* classe = (uint32_t*) alocar(numNos * sizeof(uint32_t));
+    uint32_t* inicio = (uint32_t*) alocar(numNos * sizeof(uint32_t));
+    uint32_t* fim = (uint32_t*) alocar(numNos * sizeof(uint32_t));
+    uint32_t* marcados = (uint32_t*) alocar_zerado(numNos, sizeof(uint32_t));
+    uint32_t* tocadas = (uint32_t*) alocar(numNos * sizeof(uint32_t));
+    AssinaturaEstado* assinaturas = (AssinaturaEstado*) alocar(numNos * sizeof(AssinaturaEstado));
+    uint32_t* inicioPredecessores = (uint32_t*) alocar_zerado(numPares + 1, sizeof(uint32_t));
+    uint32_t* predecessores = (uint32_t*) alocar(numPares * sizeof(uint32_t));
+    uint32_t* proximo = (uint32_t*) alocar(numPares * sizeof(uint32_t));
+    uint64_t* pendentes = (uint64_t*) alocar(numPares * sizeof(uint64_t));
+    uint32_t* divisor = (uint32_t*) alocar(numNos * sizeof(uint32_t));
+    uint32_t* atingidos = (uint32_t*) alocar(numNos * sizeof(uint32_t));
+    uint32_t* representante = (uint32_t*) alocar(numNos * sizeof(uint32_t));
+    if (!simboloDaColuna || !regras || !destino || !acoes || !elementos || !posicao || !classe || !inicio || !fim ||
+        !marcados || !tocadas || !assinaturas || !inicioPredecessores || !predecessores || !proximo || !pendentes ||
+        !divisor || !atingidos || !representante) {
+        registrar_falta_de_memoria("a minimização");
+        free(simboloDaColuna);
+        free(regras);
+        free(destino);
+        free(acoes);
+        free(elementos);
+        free(posicao);
+        free(classe);
+        free(inicio);
+        free(fim);
+        free(marcados);
+        free(tocadas);
+        free(assinaturas);
+        free(inicioPredecessores);
+        free(predecessores);
+        free(proximo);
+        free(pendentes);
+        free(divisor);
+        free(atingidos);
+        free(representante);
+        return NULL;
+    }
+    uint32_t coluna = 0;
+    for (IdNome s = 0; s < numSimbolos; s++) {
+        if (s != coringaSimbolo) simboloDaColuna[coluna++] = s;
+    }
+    simboloDaColuna[coluna] = ID_INEXISTENTE;
+
+    // Tabela de ações e destinos. Ação 0 é "sem regra"; as demais codificam escrita e direção,
+    // com 'mantém o símbolo' e 's'/'*' normalizados para que regras iguais na prática coincidam.
+    for (uint32_t q = 0; q < numNos; q++) {
+        int semRegras = q == sumidouro || q == coringaEstado || eh_estado_de_parada(maquina, q);
+        for (uint32_t c = 0; c < numColunas; c++) {
+            size_t par = (size_t) q * numColunas + c;
+            int r = semRegras ? -1 : regra_aplicavel(regras, maquina, q, simboloDaColuna[c], coringaEstado, coringaSimbolo);
+            if (r < 0) {
+                acoes[par] = 0;
+                destino[par] = sumidouro;
+                continue;
+            }
+            const Transicao* t = &maquina->transicoes[r];
+            uint64_t escrita = (t->novoSimbolo == coringaSimbolo || t->novoSimbolo == simboloDaColuna[c]) ? 0 : (uint64_t) t->novoSimbolo + 1;
+            char direcao = t->direcao == 's' ? '*' : t->direcao;
+            acoes[par] = escrita << 8 | (uint8_t) direcao;
+            destino[par] = t->novoEstado == coringaEstado ? q : t->novoEstado;
+        }
+    }
+    free(regras);
+
+    // Partição como permutação dos estados: a classe b ocupa elementos[inicio[b] .. fim[b]),
+    // e os marcados na rodada atual ficam no começo do intervalo.
+    // Partição inicial: estados com a mesma linha de ações; cada estado de parada ou com alguma coluna
+    // sem regra (e o próprio '*') fica sozinho (hash 0, que as demais linhas nunca têm).
+    for (uint32_t q = 0; q < numNos; q++) {
+        int isolado = q != sumidouro && (q == coringaEstado || eh_estado_de_parada(maquina, q));
+        for (uint32_t c = 0; c < numColunas && q != sumidouro && !isolado; c++) {
+            isolado = acoes[(size_t) q * numColunas + c] == 0;
+        }
+        assinaturas[q].hash = isolado ? 0 : hash_assinatura(&acoes[(size_t) q * numColunas], numColunas) | 1;
+        assinaturas[q].estado = q;
+    }
+    qsort(assinaturas, numNos, sizeof(AssinaturaEstado), comparar_assinaturas);
+    uint32_t numClasses = 0;
+    uint32_t cursor = 0;
+    for (uint32_t i = 0; i < numNos;) {
+        uint32_t j = i + 1;
+        if (assinaturas[i].hash != 0) {
+            while (j < numNos && assinaturas[j].hash == assinaturas[i].hash) j++;
+        }
+        // Dentro de um mesmo hash, separa as linhas realmente diferentes (colisões são raras): o
+        // primeiro estado restante abre uma classe e leva os iguais a ele; os demais ficam para a próxima
+        uint32_t restantes = j - i;
+        while (restantes > 0) {
+            uint32_t b = numClasses++;
+            inicio[b] = cursor;
+            const uint64_t* linha = &acoes[(size_t) assinaturas[i].estado * numColunas];
+            uint32_t ficam = 0;
+            for (uint32_t a = 0; a < restantes; a++) {
+                uint32_t q = assinaturas[i + a].estado;
+                if (a == 0 || memcmp(&acoes[(size_t) q * numColunas], linha, numColunas * sizeof(uint64_t)) == 0) {
+                    elementos[cursor] = q;
+                    posicao[q] = cursor++;
+                    classe[q] = b;
+                } else {
+                    assinaturas[i + ficam++] = assinaturas[i + a];
+                }
+            }
+            fim[b] = cursor;
+            restantes = ficam;
+        }
+        i = j;
+    }
+    free(assinaturas);
+    free(acoes);
+
+    // Predecessores por (estado, coluna), em formato compacto
+    for (size_t par = 0; par < numPares; par++) {
+        inicioPredecessores[(size_t) destino[par] * numColunas + par % numColunas + 1]++;
+    }
+    for (size_t i = 0; i < numPares; i++) inicioPredecessores[i + 1] += inicioPredecessores[i];
+    memcpy(proximo, inicioPredecessores, numPares * sizeof(uint32_t));
+    for (size_t par = 0; par < numPares; par++) {
+        predecessores[proximo[(size_t) destino[par] * numColunas + par % numColunas]++] = (uint32_t) (par / numColunas);
+    }
+    free(proximo);
+    free(destino);
+
+    // Lista de trabalho de divisores (classe, coluna); começa com todas as classes iniciais
+    size_t numPendentes = 0;
+    for (uint32_t b = 0; b < numClasses; b++) {
+        for (uint32_t c = 0; c < numColunas; c++) pendentes[numPendentes++] = (uint64_t) b << 32 | c;
+    }
+
+    while (numPendentes > 0) {
+        uint64_t item = pendentes[--numPendentes];
+        uint32_t s = (uint32_t) (item >> 32);
+        uint32_t c = (uint32_t) item;
+
+        // Copia o divisor antes de marcar, porque a marcação reordena as classes (inclusive a própria s)
+        uint32_t tamanhoDivisor = fim[s] - inicio[s];
+        memcpy(divisor, &elementos[inicio[s]], tamanhoDivisor * sizeof(uint32_t));
+        size_t numAtingidos = 0;
+        for (uint32_t i = 0; i < tamanhoDivisor; i++) {
+            size_t par = (size_t) divisor[i] * numColunas + c;
+            for (uint32_t p = inicioPredecessores[par]; p < inicioPredecessores[par + 1]; p++) {
+                atingidos[numAtingidos++] = predecessores[p];
+            }
+        }
+
+        // Marca: cada estado atingido vai para a parte da frente da sua classe
+        uint32_t numTocadas = 0;
+        for (size_t i = 0; i < numAtingidos; i++) {
+            uint32_t q = atingidos[i];
+            uint32_t b = classe[q];
+            uint32_t limite = inicio[b] + marcados[b];
+            if (posicao[q] < limite) continue;
+            uint32_t outro = elementos[limite];
+            elementos[posicao[q]] = outro;
+            posicao[outro] = posicao[q];
+            elementos[limite] = q;
+            posicao[q] = limite;
+            if (marcados[b]++ == 0) tocadas[numTocadas++] = b;
+        }
+
+        // Divide cada classe tocada em marcados e não marcados; a parte menor vira a classe nova e
+        // entra na lista para todas as colunas (se a antiga já estava pendente, continua pendente)
+        for (uint32_t t = 0; t < numTocadas; t++) {
+            uint32_t b = tocadas[t];
+            uint32_t m = marcados[b];
+            marcados[b] = 0;
+            if (m == fim[b] - inicio[b]) continue;
+
+            uint32_t nova = numClasses++;
+            if (m <= fim[b] - inicio[b] - m) {
+                inicio[nova] = inicio[b];
+                fim[nova] = inicio[b] + m;
+                inicio[b] += m;
+            } else {
+                inicio[nova] = inicio[b] + m;
+                fim[nova] = fim[b];
+                fim[b] = inicio[b] + m;
+            }
+            for (uint32_t i = inicio[nova]; i < fim[nova]; i++) classe[elementos[i]] = nova;
+
+            for (uint32_t col = 0; col < numColunas; col++) pendentes[numPendentes++] = (uint64_t) nova << 32 | col;
+        }
+    }
+    free(pendentes);
+    free(divisor);
+    free(atingidos);
+    free(inicioPredecessores);
+    free(predecessores);
+
+    // Representante de cada classe: o estado inicial, se estiver nela, senão o de menor ID
+    for (uint32_t b = 0; b < numClasses; b++) representante[b] = ID_INEXISTENTE;
+    for (uint32_t q = 0; q < numEstados; q++) {
+        uint32_t b = classe[q];
+        if (representante[b] == ID_INEXISTENTE || q == inicial) representante[b] = q;
+    }
+
+    // Reconstrução: regras do '*' e dos representantes, com os destinos trocados pelos representantes
+    MaquinaTuring* minimizada = criar_maquina(maquina->tipo, maquina->numTransicoes > 0 ? maquina->numTransicoes : 1);
+    for (int i = 0; i < maquina->numTransicoes && minimizada; i++) {
+        const Transicao* t = &maquina->transicoes[i];
+        if (t->estadoAtual != coringaEstado && representante[classe[t->estadoAtual]] != t->estadoAtual) continue;
+        IdNome novoEstado = t->novoEstado == coringaEstado ? t->novoEstado : representante[classe[t->novoEstado]];
+        adicionar_transicao(minimizada, nome_estado(maquina, t->estadoAtual), nome_simbolo(maquina, t->simboloAtual),
+                            nome_simbolo(maquina, t->novoSimbolo), t->direcao, nome_estado(maquina, novoEstado));
+    }
+    if (minimizada) estatisticas->regrasDepois = minimizada->numTransicoes;
+    for (uint32_t b = 0; b < numClasses; b++) {
+        if (representante[b] != ID_INEXISTENTE && representante[b] != coringaEstado) estatisticas->estadosDepois++;
+    }
+
+    free(simboloDaColuna);
+    free(elementos);
+    free(posicao);
+    free(classe);
+    free(inicio);
+    free(fim);
+    free(marcados);
+    free(tocadas);
+    free(representante);
+    return concluir_maquina(minimizada);
+}
+
+
+// === Gerador de máquinas ===
+// Máquinas sintéticas de qualquer tamanho, para medir como carga, tradução e gravação escalam.
+
+static uint64_t proximo_aleatorio(uint64_t* estado) {
+    *estado += 0x9e3779b97f4a7c15ULL;
+    return hash_chave(*estado);
+}
+
+static uint64_t mdc(uint64_t a, uint64_t b) {
+    while (b) {
+        uint64_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+MaquinaTuring* gerar_maquina(const ParametrosGerador* parametros) {
+    static const char simbolosGerador[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    const ParametrosGerador* p = parametros;
+    int somaPesos = p->pesoEsquerda + p->pesoDireita + p->pesoParado;
+    if ((p->tipo != 'S' && p->tipo != 'I') || p->numEstados < 1 || p->numSimbolos < 2 ||
+        p->numSimbolos > (int) sizeof(simbolosGerador) || p->numTransicoes < 1 ||
+        p->pesoEsquerda < 0 || p->pesoDireita < 0 || p->pesoParado < 0 || somaPesos <= 0) {
+        registrar_erro(TRADUTOR_ERRO_ENTRADA, "Parâmetros inválidos para o gerador (tipo S ou I, ao menos 1 estado, 2 a %d símbolos, "
+                       "ao menos 1 transição e pesos de movimento não negativos).", (int) sizeof(simbolosGerador));
+        return NULL;
+    }
+    if (!p->permitirRepetidos && (int64_t) p->numTransicoes > (int64_t) p->numEstados * p->numSimbolos) {
+        registrar_erro(TRADUTOR_ERRO_ENTRADA, "%d transições não cabem em %d estados x %d símbolos sem repetir pares "
+                       "(estado, símbolo); as repetidas nunca executariam.", p->numTransicoes, p->numEstados, p->numSimbolos);
+        return NULL;
+    }
+    MaquinaTuring* maquina = criar_maquina(p->tipo, p->numTransicoes);
+    if (!maquina) return NULL;
+
+    // Os estados recebem os IDs 0 a numEstados - 1 e "halt-accept" o seguinte; o branco é o símbolo 0
+    char nome[16];
+    for (int e = 0; e < p->numEstados && maquina->erro == TRADUTOR_OK; e++) {
+        snprintf(nome, sizeof(nome), "%d", e);
+        if (internar_estado(maquina, nome) == ID_INEXISTENTE) maquina->erro = ultimo_codigo_erro();
+    }
+    if (internar_estado(maquina, "halt-accept") == ID_INEXISTENTE || internar_simbolo(maquina, "_") == ID_INEXISTENTE) {
+        maquina->erro = ultimo_codigo_erro();
+    }
+    for (int a = 0; a + 1 < p->numSimbolos && maquina->erro == TRADUTOR_OK; a++) {
+        if (internar_nome(&maquina->simbolos, &maquina->arena, &simbolosGerador[a], 1) == ID_INEXISTENTE) maquina->erro = ultimo_codigo_erro();
+    }
+
+    // Os pares (estado, símbolo) são percorridos numa ordem embaralhada: somar um 'passo' primo com N
+    // módulo N só repete um par depois de passar pelos N
+    uint64_t aleatorio = p->semente;
+    uint64_t numPares = (uint64_t) p->numEstados * (uint64_t) p->numSimbolos;
+    uint64_t passo = proximo_aleatorio(&aleatorio) % numPares;
+    while (mdc(passo, numPares) != 1) passo = (passo + 1) % numPares;
+    uint64_t proximoPar = proximo_aleatorio(&aleatorio) % numPares;
+    for (int r = 0; r < p->numTransicoes && maquina->erro == TRADUTOR_OK; r++) {
+        uint64_t par = proximoPar;
+        if ((uint64_t) r < numPares) proximoPar = (proximoPar + passo) % numPares;
+        else par = proximo_aleatorio(&aleatorio) % numPares;
+        IdNome estado = (IdNome) (par / (uint64_t) p->numSimbolos);
+        IdNome simbolo = (IdNome) (par % (uint64_t) p->numSimbolos);
+        IdNome novoSimbolo = (IdNome) (proximo_aleatorio(&aleatorio) % (uint64_t) p->numSimbolos);
+        IdNome novoEstado = (IdNome) (proximo_aleatorio(&aleatorio) % (uint64_t) (p->numEstados + 1));
+        int movimento = (int) (proximo_aleatorio(&aleatorio) % (uint64_t) somaPesos);
+        char direcao = movimento < p->pesoEsquerda ? 'l' : (movimento < p->pesoEsquerda + p->pesoDireita ? 'r' : '*');
+        adicionar_transicao_ids(maquina, estado, simbolo, novoSimbolo, direcao, novoEstado);
+    }
+    return concluir_maquina(maquina);
+}
+
+
+// === Simulador ===
+// A máquina é compilada para uma tabela densa [estado][símbolo], já com os curingas '*' do Morphett
+// resolvidos, e executada sobre uma fita de IDs de símbolos que cresce para os dois lados.
+
+const char* nome_coluna(const ProgramaCompilado* programa, uint32_t coluna) {
+    if (coluna < programa->maquina->simbolos.numNomes) return nome_simbolo(programa->maquina, coluna);
+    return programa->extras[coluna - programa->maquina->simbolos.numNomes];
+}
+
+// Aplica a transição 'i' à entrada (estado, coluna) se ela tiver prioridade maior que a regra atual.
+// Com 'regras', só registra nele o índice da transição, sem mexer na tabela de ações.
+static void aplicar_regra(const ProgramaCompilado* programa, int32_t* regras, uint8_t* prioridades, const Transicao* t, int i,
+                          uint8_t prioridade, uint32_t estado, uint32_t coluna, uint32_t coringaSimbolo, uint32_t coringaEstado) {
+    size_t pos = (size_t) estado * programa->numColunas + coluna;
+    if (prioridade >= prioridades[pos]) return; // a primeira regra de cada classe vence
+    prioridades[pos] = prioridade;
+    if (regras) {
+        regras[pos] = i;
+        return;
+    }
+
+    AcaoCompilada* acao = &programa->acoes[pos];
+    acao->flags = 0;
+    acao->proximaLinha = (t->novoEstado == coringaEstado ? estado : t->novoEstado) * programa->numColunas;
+    if (t->novoSimbolo == coringaSimbolo) {
+        acao->mascara = UINT32_MAX;
+        acao->valor = 0;
+    } else {
+        acao->mascara = 0;
+        acao->valor = t->novoSimbolo;
+    }
+    acao->movimento = t->direcao == 'l' ? -1 : (t->direcao == 'r' ? 1 : 0); // '*' (e 's') ficam parados
+}
+
+// Resolve os curingas na prioridade do Morphett: estado e símbolo exatos, depois símbolo '*', depois
+// estado '*', depois ambos '*'. 'prioridades' tem uma posição por entrada da tabela, começando em 4.
+static void aplicar_regras(const ProgramaCompilado* programa, int32_t* regras, uint8_t* prioridades) {
+    const MaquinaTuring* maquina = programa->maquina;
+    IdNome coringaEstado = buscar_nome(&maquina->estados, &maquina->arena, "*", 1);
+    IdNome coringaSimbolo = buscar_nome(&maquina->simbolos, &maquina->arena, "*", 1);
+    for (int i = 0; i < maquina->numTransicoes; i++) {
+        const Transicao* t = &maquina->transicoes[i];
+        int estadoCuringa = t->estadoAtual == coringaEstado;
+        int simboloCuringa = t->simboloAtual == coringaSimbolo;
+        uint8_t prioridade = (uint8_t) (estadoCuringa * 2 + simboloCuringa);
+
+        uint32_t estadoInicio = estadoCuringa ? 0 : t->estadoAtual;
+        uint32_t estadoFim = estadoCuringa ? programa->numEstados : t->estadoAtual + 1;
+        for (uint32_t e = estadoInicio; e < estadoFim; e++) {
+            if (simboloCuringa) {
+                for (uint32_t c = 0; c < programa->numColunas; c++) {
+                    if (c != coringaSimbolo) aplicar_regra(programa, regras, prioridades, t, i, prioridade, e, c, coringaSimbolo, coringaEstado);
+                }
+            } else {
+                aplicar_regra(programa, regras, prioridades, t, i, prioridade, e, t->simboloAtual, coringaSimbolo, coringaEstado);
+            }
+        }
+    }
+}
+
+// Compila a máquina. 'alfabetoEntrada' lista os caracteres que podem aparecer nas palavras de
+// entrada; os que não são símbolos da máquina ganham colunas extras (só regras com '*' os leem).
+ProgramaCompilado* compilar_maquina(const MaquinaTuring* maquina, const char* alfabetoEntrada, const char* estadoInicial) {
+    ProgramaCompilado* programa = (ProgramaCompilado*) alocar_zerado(1, sizeof(ProgramaCompilado));
+    if (!programa) {
+        registrar_falta_de_memoria("o programa compilado");
+        return NULL;
+    }
+    programa->maquina = maquina;
+    programa->semiInfinita = maquina->tipo == 'S';
+
+    IdNome coringaSimbolo = buscar_nome(&maquina->simbolos, &maquina->arena, "*", 1);
+    programa->estadoInicial = buscar_nome(&maquina->estados, &maquina->arena, estadoInicial, strlen(estadoInicial));
+    if (programa->estadoInicial == ID_INEXISTENTE) {
+        registrar_erro(TRADUTOR_ERRO_ENTRADA, "O estado inicial '%s' não aparece em nenhuma transição.", estadoInicial);
+        free(programa);
+        return NULL;
+    }
+
+    // Colunas: os símbolos da máquina (o ID é a própria coluna), depois o branco e os extras da entrada
+    uint32_t numSimbolos = maquina->simbolos.numNomes;
+    uint32_t numExtras = 0;
+    for (int b = 0; b < 256; b++) programa->mapaBytes[b] = ID_INEXISTENTE;
+    for (IdNome id = 0; id < numSimbolos; id++) {
+        if (maquina->simbolos.tamanhos[id] == 1 && id != coringaSimbolo) {
+            programa->mapaBytes[(unsigned char) nome_simbolo(maquina, id)[0]] = id;
+        }
+    }
+    char textoBranco[2] = "_";
+    const char* fontes[2] = { textoBranco, alfabetoEntrada ? alfabetoEntrada : "" };
+    for (int f = 0; f < 2; f++) {
+        for (const unsigned char* c = (const unsigned char*) fontes[f]; *c; c++) {
+            if (programa->mapaBytes[*c] != ID_INEXISTENTE || *c == '*') continue;
+            programa->extras[numExtras][0] = (char) *c;
+            programa->extras[numExtras][1] = '\0';
+            programa->mapaBytes[*c] = numSimbolos + numExtras++;
+        }
+    }
+    // ' ' na entrada é o branco, como no simulador do Morphett
+    programa->mapaBytes[(unsigned char) ' '] = programa->mapaBytes[(unsigned char) '_'];
+    programa->colunaBranco = programa->mapaBytes[(unsigned char) '_'];
+
+    programa->numEstados = maquina->estados.numNomes;
+    programa->numColunas = numSimbolos + numExtras;
+    size_t numEntradas = (size_t) programa->numEstados * programa->numColunas;
+    if (numEntradas > UINT32_MAX) {
+        registrar_erro(TRADUTOR_ERRO_LIMITE, "Máquina grande demais para a tabela densa (%u estados x %u símbolos).", programa->numEstados, programa->numColunas);
+        free(programa);
+        return NULL;
+    }
+    programa->acoes = (AcaoCompilada*) alocar(numEntradas * sizeof(AcaoCompilada));
+    uint8_t* prioridades = (uint8_t*) alocar(numEntradas);
+    if (!programa->acoes || !prioridades) {
+        registrar_erro(TRADUTOR_ERRO_MEMORIA, "Falha na alocação de memória para a tabela de transições (%u estados x %u símbolos).",
+                       programa->numEstados, programa->numColunas);
+        free(prioridades);
+        liberar_programa(programa);
+        return NULL;
+    }
+    for (size_t i = 0; i < numEntradas; i++) {
+        AcaoCompilada semRegra = { 0, UINT32_MAX, 0, 0, ACAO_SEM_REGRA };
+        programa->acoes[i] = semRegra;
+        prioridades[i] = 4;
+    }
+
+    aplicar_regras(programa, NULL, prioridades);
+    free(prioridades);
+
+    // Estados 'halt*' param assim que são alcançados
+    for (uint32_t e = 0; e < programa->numEstados; e++) {
+        if (!eh_estado_de_parada(maquina, e)) continue;
+        AcaoCompilada* linha = &programa->acoes[(size_t) e * programa->numColunas];
+        for (uint32_t c = 0; c < programa->numColunas; c++) {
+            AcaoCompilada parada = { e * programa->numColunas, UINT32_MAX, 0, 0, ACAO_PARADA };
+            linha[c] = parada;
+        }
+    }
+
+    return programa;
+}
+
+void liberar_programa(ProgramaCompilado* programa) {
+    if (!programa) return;
+    free(programa->acoes);
+    free(programa->simbolosDeslocamento);
+    free(programa);
+}
+
+int32_t* regras_do_programa(const ProgramaCompilado* programa) {
+    size_t numEntradas = (size_t) programa->numEstados * programa->numColunas;
+    int32_t* regras = (int32_t*) alocar((numEntradas + 1) * sizeof(int32_t));
+    uint8_t* prioridades = (uint8_t*) alocar(numEntradas + 1);
+    if (!regras || !prioridades) {
+        registrar_falta_de_memoria("as regras da tabela de transições");
+        free(regras);
+        free(prioridades);
+        return NULL;
+    }
+    memset(regras, 0xff, numEntradas * sizeof(int32_t));
+    memset(prioridades, 4, numEntradas);
+    aplicar_regras(programa, regras, prioridades);
+    free(prioridades);
+
+    // Estados 'halt*' param antes de executar qualquer regra
+    for (uint32_t e = 0; e < programa->numEstados; e++) {
+        if (eh_estado_de_parada(programa->maquina, e)) memset(&regras[(size_t) e * programa->numColunas], 0xff, programa->numColunas * sizeof(int32_t));
+    }
+    return regras;
+}
+
+static uint32_t raiz_grupo(uint32_t* pais, uint32_t e) {
+    while (pais[e] != e) {
+        pais[e] = pais[pais[e]];
+        e = pais[e];
+    }
+    return e;
+}
+
+// Marca na tabela os laços que podem ser executados de uma vez (macropassos):
+//
+// - Famílias de deslocamento: cada estado e "carrega" um símbolo c(e) e, para todo símbolo x de um
+//   conjunto A comum à família, escreve c(e), anda sempre para o mesmo lado e vai para o estado que
+//   carrega x. É a sub-rotina q1_X que a tradução I -> S usa para empurrar a fita; uma varredura
+//   inteira sobre células em A vira um memmove.
+// - Sequências: um estado que, lendo x, anda e continua no mesmo estado. A varredura segue pelas
+//   células seguintes enquanto as entradas delas também são laços para o mesmo lado, como a volta
+//   '* * l' da tradução sobre uma fita com símbolos misturados, e vira um só laço sem despacho.
+//
+// Só as entradas marcadas saem do laço rápido, e cada macropasso conta exatamente os passos que
+// a execução passo a passo faria. Famílias exigem no máximo 64 colunas (A cabe em um uint64_t).
+// Retorna o número de entradas da tabela marcadas, ou -1 sem memória (a tabela fica como estava).
+int acelerar_programa(ProgramaCompilado* programa) {
+    uint32_t numEstados = programa->numEstados;
+    uint32_t numColunas = programa->numColunas;
+    AcaoCompilada* acoes = programa->acoes;
+    int marcadas = 0;
+
+    if (numColunas <= 64 && numEstados > 0) {
+        uint32_t* carrega = (uint32_t*) alocar(numEstados * sizeof(uint32_t));
+        int16_t* lado = (int16_t*) alocar(numEstados * sizeof(int16_t));
+        uint64_t* conjuntos = (uint64_t*) alocar_zerado(numEstados, sizeof(uint64_t));
+        uint32_t* pais = (uint32_t*) alocar(numEstados * sizeof(uint32_t));
+        uint32_t* representantes = (uint32_t*) alocar(numEstados * sizeof(uint32_t));
+        uint8_t* invalidos = (uint8_t*) alocar_zerado(numEstados, 1);
+        uint64_t* simbolosDeslocamento = (uint64_t*) alocar_zerado(numEstados, sizeof(uint64_t));
+        if (!carrega || !lado || !conjuntos || !pais || !representantes || !invalidos || !simbolosDeslocamento) {
+            registrar_falta_de_memoria("a análise de macropassos");
+            free(carrega);
+            free(lado);
+            free(conjuntos);
+            free(pais);
+            free(representantes);
+            free(invalidos);
+            free(simbolosDeslocamento);
+            return -1;
+        }
+
+        // Símbolo carregado: o valor escrito pela primeira regra que sobrescreve a célula e anda
+        for (uint32_t e = 0; e < numEstados; e++) {
+            carrega[e] = ID_INEXISTENTE;
+            lado[e] = 0;
+            pais[e] = e;
+            representantes[e] = ID_INEXISTENTE;
+            const AcaoCompilada* linha = &acoes[(size_t) e * numColunas];
+            for (uint32_t x = 0; x < numColunas; x++) {
+                if (linha[x].flags == 0 && linha[x].mascara == 0 && linha[x].movimento != 0) {
+                    carrega[e] = linha[x].valor;
+                    lado[e] = linha[x].movimento;
+                    break;
+                }
+            }
+        }
+
+        // A(e): símbolos x em que e escreve c(e), anda para o seu lado e vai para um estado que carrega x
+        for (uint32_t e = 0; e < numEstados; e++) {
+            if (carrega[e] == ID_INEXISTENTE) continue;
+            const AcaoCompilada* linha = &acoes[(size_t) e * numColunas];
+            for (uint32_t x = 0; x < numColunas; x++) {
+                const AcaoCompilada* acao = &linha[x];
+                uint32_t proximo = acao->proximaLinha / numColunas;
+                if (acao->flags == 0 && acao->mascara == 0 && acao->valor == carrega[e] && acao->movimento == lado[e] &&
+                    carrega[proximo] == x && lado[proximo] == lado[e]) {
+                    conjuntos[e] |= 1ULL << x;
+                    pais[raiz_grupo(pais, e)] = raiz_grupo(pais, proximo);
+                }
+            }
+        }
+
+        // Uma família só vale se todos os estados têm o mesmo A e vão para o mesmo estado para cada x
+        for (uint32_t e = 0; e < numEstados; e++) {
+            if (!conjuntos[e]) continue;
+            uint32_t raiz = raiz_grupo(pais, e);
+            if (representantes[raiz] == ID_INEXISTENTE) representantes[raiz] = e;
+            uint32_t r = representantes[raiz];
+            if (conjuntos[e] != conjuntos[r]) invalidos[raiz] = 1;
+            for (uint32_t x = 0; x < numColunas && !invalidos[raiz]; x++) {
+                if (!(conjuntos[e] >> x & 1)) continue;
+                uint32_t proximaLinha = acoes[(size_t) e * numColunas + x].proximaLinha;
+                if (proximaLinha != acoes[(size_t) r * numColunas + x].proximaLinha ||
+                    conjuntos[proximaLinha / numColunas] != conjuntos[e]) {
+                    invalidos[raiz] = 1;
+                }
+            }
+        }
+
+        free(programa->simbolosDeslocamento);
+        programa->simbolosDeslocamento = simbolosDeslocamento;
+        for (uint32_t e = 0; e < numEstados; e++) {
+            if (!conjuntos[e] || invalidos[raiz_grupo(pais, e)]) continue;
+            programa->simbolosDeslocamento[e] = conjuntos[e];
+            for (uint32_t x = 0; x < numColunas; x++) {
+                if (conjuntos[e] >> x & 1) {
+                    acoes[(size_t) e * numColunas + x].flags |= ACAO_DESLOCAMENTO;
+                    marcadas++;
+                }
+            }
+        }
+
+        free(carrega);
+        free(lado);
+        free(conjuntos);
+        free(pais);
+        free(representantes);
+        free(invalidos);
+    }
+
+    // Sequências: o estado lê x, anda e continua nele mesmo
+    for (uint32_t e = 0; e < numEstados; e++) {
+        AcaoCompilada* linha = &acoes[(size_t) e * numColunas];
+        for (uint32_t x = 0; x < numColunas; x++) {
+            if (linha[x].flags == 0 && linha[x].movimento != 0 && linha[x].proximaLinha == e * numColunas) {
+                linha[x].flags |= ACAO_SEQUENCIA;
+                marcadas++;
+            }
+        }
+    }
+    return marcadas;
+}
+
+// Prepara a fita com 'palavra' a partir da célula de origem. A fita deve começar zerada; o buffer de
+// uma execução anterior é reaproveitado se for grande o bastante. Retorna -1 se um caractere não tem
+// coluna ou se falta memória.
+int fita_iniciar(Fita* fita, const ProgramaCompilado* programa, const char* palavra) {
+    size_t tamanho = strlen(palavra);
+    int64_t capacidadeMinima = (int64_t) tamanho * 2 + 64;
+    if (!fita->celulas || fita->capacidade < capacidadeMinima) {
+        free(fita->celulas);
+        fita->capacidade = capacidadeMinima;
+        fita->celulas = (uint32_t*) alocar((size_t) fita->capacidade * sizeof(uint32_t));
+        if (!fita->celulas) {
+            fita->capacidade = 0;
+            registrar_falta_de_memoria("a fita");
+            return -1;
+        }
+    }
+    // Na fita duplamente infinita a palavra fica no meio do buffer, com folga para os dois lados
+    fita->origem = programa->semiInfinita ? 0 : (fita->capacidade - (int64_t) tamanho) / 2;
+    fita->cabeca = fita->origem;
+    for (int64_t i = 0; i < fita->capacidade; i++) fita->celulas[i] = programa->colunaBranco;
+    for (size_t i = 0; i < tamanho; i++) {
+        uint32_t coluna = programa->mapaBytes[(unsigned char) palavra[i]];
+        if (coluna == ID_INEXISTENTE) {
+            registrar_erro(TRADUTOR_ERRO_ENTRADA, "O caractere '%c' da palavra de entrada não é um símbolo conhecido.", palavra[i]);
+            return -1;
+        }
+        fita->celulas[fita->origem + (int64_t) i] = coluna;
+    }
+    return 0;
+}
+
+void fita_liberar(Fita* fita) {
+    free(fita->celulas);
+    fita->celulas = NULL;
+}
+
+// Caminho raro do laço principal: o cabeçote saiu da região alocada (ou bateu na parede de Sipser).
+// Retorna -1 se a fita não pôde crescer; nesse caso ela fica como estava.
+static int fita_ajustar(Fita* fita, const ProgramaCompilado* programa) {
+    if (fita->cabeca < fita->origem && programa->semiInfinita) {
+        fita->cabeca = fita->origem;
+        return 0;
+    }
+    if (fita->cabeca >= 0 && fita->cabeca < fita->capacidade) return 0;
+
+    // Dobra a capacidade; ao crescer para a esquerda o conteúdo antigo vai para a metade da direita
+    int64_t novaCapacidade = fita->capacidade * 2;
+    int64_t deslocamento = fita->cabeca < 0 ? fita->capacidade : 0;
+    uint32_t* novas = (uint32_t*) alocar((size_t) novaCapacidade * sizeof(uint32_t));
+    if (!novas) {
+        registrar_erro(TRADUTOR_ERRO_MEMORIA, "Falha na realocação de memória para a fita.");
+        return -1;
+    }
+    for (int64_t i = 0; i < novaCapacidade; i++) novas[i] = programa->colunaBranco;
+    memcpy(novas + deslocamento, fita->celulas, (size_t) fita->capacidade * sizeof(uint32_t));
+    free(fita->celulas);
+    fita->celulas = novas;
+    fita->capacidade = novaCapacidade;
+    fita->cabeca += deslocamento;
+    fita->origem += deslocamento;
+    return 0;
+}
+
+// Executa a varredura ou sequência que começa em (linha, cabeca) e retorna quantos passos simples
+// ela equivale, no máximo 'maxPassos'. Para na borda da região alocada e na parede de Sipser, onde
+// o laço principal assume o próximo passo. Fica fora de linha para não pesar no laço principal.
+static __attribute__((noinline)) uint64_t executar_macropasso(const ProgramaCompilado* programa, const AcaoCompilada* acao, uint32_t* celulas,
+                                    int64_t* cabeca, uint32_t* linha, int64_t limiteEsquerdo, int64_t capacidade, uint64_t maxPassos) {
+    int64_t h = *cabeca;
+    int64_t d = acao->movimento;
+    uint64_t disponiveis = d > 0 ? (uint64_t) (capacidade - h) : (uint64_t) (h - limiteEsquerdo + 1);
+    if (disponiveis > maxPassos) disponiveis = maxPassos;
+
+    uint64_t n = 1;
+    if (acao->flags & ACAO_DESLOCAMENTO) {
+        // Cada célula recebe o símbolo da anterior; a primeira recebe o símbolo carregado pelo estado
+        uint64_t conjunto = programa->simbolosDeslocamento[*linha / programa->numColunas];
+        while (n < disponiveis && (conjunto >> celulas[h + (int64_t) n * d] & 1)) n++;
+        int64_t ultima = h + (int64_t) (n - 1) * d;
+        uint32_t saindo = celulas[ultima];
+        if (d > 0) memmove(&celulas[h + 1], &celulas[h], (size_t) (n - 1) * sizeof(uint32_t));
+        else memmove(&celulas[ultima], &celulas[ultima + 1], (size_t) (n - 1) * sizeof(uint32_t));
+        celulas[h] = acao->valor;
+        *linha = programa->acoes[*linha + saindo].proximaLinha;
+    } else {
+        // Laço de um só estado: o estado não muda enquanto a entrada de cada célula, na mesma linha,
+        // também é um laço para o mesmo lado. Cada trecho do mesmo símbolo vira um preenchimento.
+        const AcaoCompilada* linhaAcoes = &programa->acoes[*linha];
+        uint32_t simbolo = celulas[h];
+        uint32_t novo = (simbolo & acao->mascara) | acao->valor;
+        for (;;) {
+            uint64_t inicioTrecho = n - 1;
+            while (n < disponiveis && celulas[h + (int64_t) n * d] == simbolo) n++;
+            if (novo != simbolo) {
+                for (uint64_t k = inicioTrecho; k < n; k++) celulas[h + (int64_t) k * d] = novo;
+            }
+            if (n >= disponiveis) break;
+            simbolo = celulas[h + (int64_t) n * d];
+            const AcaoCompilada* proxima = &linhaAcoes[simbolo];
+            if (!(proxima->flags & ACAO_SEQUENCIA) || proxima->movimento != d) break;
+            novo = (simbolo & proxima->mascara) | proxima->valor;
+            n++;
+        }
+    }
+    *cabeca = h + (int64_t) n * d;
+    return n;
+}
+
+// Laço principal do simulador: sem alocação e com um único desvio por passo para a parada e os macropassos.
+// Continua a execução que está na linha 'linha' da tabela depois de 'passos' passos.
+static ResultadoExecucao continuar_execucao(const ProgramaCompilado* programa, Fita* fita, uint32_t linha, uint64_t passos,
+                                            uint64_t limitePassos) {
+    const AcaoCompilada* acoes = programa->acoes;
+    const size_t numColunas = programa->numColunas;
+    uint32_t* celulas = fita->celulas;
+    int64_t cabeca = fita->cabeca;
+    int64_t limiteEsquerdo = programa->semiInfinita ? fita->origem : 0;
+    int64_t capacidade = fita->capacidade;
+    ResultadoExecucao resultado;
+    resultado.motivo = MOTIVO_LIMITE;
+
+    while (passos < limitePassos) {
+        const AcaoCompilada* acao = &acoes[linha + celulas[cabeca]];
+        if (acao->flags) {
+            if (acao->flags & (ACAO_PARADA | ACAO_SEM_REGRA)) {
+                resultado.motivo = (acao->flags & ACAO_PARADA) ? MOTIVO_PARADA : MOTIVO_SEM_REGRA;
+                break;
+            }
+            passos += executar_macropasso(programa, acao, celulas, &cabeca, &linha, limiteEsquerdo, capacidade, limitePassos - passos);
+        } else {
+            celulas[cabeca] = (celulas[cabeca] & acao->mascara) | acao->valor;
+            cabeca += acao->movimento;
+            linha = acao->proximaLinha;
+            passos++;
+        }
+
+        if (cabeca < limiteEsquerdo || cabeca >= capacidade) {
+            fita->cabeca = cabeca;
+            if (fita_ajustar(fita, programa) < 0) {
+                // O passo já foi contado; o cabeçote volta para a última célula da fita
+                cabeca = cabeca < 0 ? 0 : fita->capacidade - 1;
+                resultado.motivo = MOTIVO_SEM_MEMORIA;
+                break;
+            }
+            celulas = fita->celulas;
+            cabeca = fita->cabeca;
+            capacidade = fita->capacidade;
+            limiteEsquerdo = programa->semiInfinita ? fita->origem : 0;
+        }
+    }
+
+    fita->cabeca = cabeca;
+    resultado.estadoFinal = linha / (uint32_t) numColunas;
+    resultado.passos = passos;
+    return resultado;
+}
+
+ResultadoExecucao executar_programa(const ProgramaCompilado* programa, Fita* fita, uint64_t limitePassos) {
+    return continuar_execucao(programa, fita, programa->estadoInicial * programa->numColunas, 0, limitePassos);
+}
+
+// Como executar_programa, contando em contagens[entrada] os passos de cada entrada da tabela. Executa um
+// passo de cada vez, sem macropassos, e fica separado para não pesar no laço principal.
+ResultadoExecucao executar_programa_perfilado(const ProgramaCompilado* programa, Fita* fita, uint64_t limitePassos, uint64_t* contagens) {
+    const AcaoCompilada* acoes = programa->acoes;
+    const size_t numColunas = programa->numColunas;
+    uint32_t* celulas = fita->celulas;
+    int64_t cabeca = fita->cabeca;
+    int64_t limiteEsquerdo = programa->semiInfinita ? fita->origem : 0;
+    int64_t capacidade = fita->capacidade;
+    uint32_t linha = programa->estadoInicial * (uint32_t) numColunas;
+    uint64_t passos = 0;
+    ResultadoExecucao resultado;
+    resultado.motivo = MOTIVO_LIMITE;
+
+    while (passos < limitePassos) {
+        uint32_t entrada = linha + celulas[cabeca];
+        const AcaoCompilada* acao = &acoes[entrada];
+        if (acao->flags & (ACAO_PARADA | ACAO_SEM_REGRA)) {
+            resultado.motivo = (acao->flags & ACAO_PARADA) ? MOTIVO_PARADA : MOTIVO_SEM_REGRA;
+            break;
+        }
+        contagens[entrada]++;
+        celulas[cabeca] = (celulas[cabeca] & acao->mascara) | acao->valor;
+        cabeca += acao->movimento;
+        linha = acao->proximaLinha;
+        passos++;
+
+        if (cabeca < limiteEsquerdo || cabeca >= capacidade) {
+            fita->cabeca = cabeca;
+            if (fita_ajustar(fita, programa) < 0) {
+                cabeca = cabeca < 0 ? 0 : fita->capacidade - 1;
+                resultado.motivo = MOTIVO_SEM_MEMORIA;
+                break;
+            }
+            celulas = fita->celulas;
+            cabeca = fita->cabeca;
+            capacidade = fita->capacidade;
+            limiteEsquerdo = programa->semiInfinita ? fita->origem : 0;
+        }
+    }
+
+    fita->cabeca = cabeca;
+    resultado.estadoFinal = linha / (uint32_t) numColunas;
+    resultado.passos = passos;
+    return resultado;
+}
+
+// === Execução em lote ===
+// Várias palavras sobre o mesmo programa: cada pista tem a sua fita, e o estado das pistas fica em
+// vetores separados (linha, cabeçote, passos, ...), percorridos juntos a cada passo. Primeiro cada pista
+// calcula a entrada da tabela que vai executar e pede a linha de cache dela; depois todas executam. Assim
+// as faltas de cache das pistas se sobrepõem, em vez de uma palavra esperar a memória a cada passo.
+
+#define PASSOS_POR_RODADA 64  // passos de cada pista entre duas verificações de pistas paradas
+#define PISTA_ATIVA 0xff      // pista ainda executando; as paradas guardam o MotivoFim
+
+// Fitas que cresceram muito são liberadas antes de receber a próxima palavra, para que limpar a fita
+// não custe mais que executar a palavra
+#define CELULAS_MAXIMAS_REAPROVEITADAS (1 << 16)
+
+typedef struct {
+    Fita* fitas;
+    uint32_t** celulas;
+    int64_t* cabeca;
+    int64_t* limiteEsquerdo;
+    int64_t* capacidade;
+    uint32_t* linha;
+    uint32_t* entrada;
+    uint64_t* passos;
+    int* palavra;
+    uint8_t* motivo;
+} Pistas;
+
+static void liberar_pistas(Pistas* pistas, int numPistas) {
+    if (pistas->fitas) {
+        for (int p = 0; p < numPistas; p++) fita_liberar(&pistas->fitas[p]);
+    }
+    free(pistas->fitas);
+    free(pistas->celulas);
+    free(pistas->cabeca);
+    free(pistas->limiteEsquerdo);
+    free(pistas->capacidade);
+    free(pistas->linha);
+    free(pistas->entrada);
+    free(pistas->passos);
+    free(pistas->palavra);
+    free(pistas->motivo);
+}
+
+// Copia a fita da pista 'p' para os vetores (depois de iniciá-la ou de ela crescer)
+static void carregar_pista(Pistas* pistas, int p, const ProgramaCompilado* programa) {
+    Fita* fita = &pistas->fitas[p];
+    pistas->celulas[p] = fita->celulas;
+    pistas->cabeca[p] = fita->cabeca;
+    pistas->capacidade[p] = fita->capacidade;
+    pistas->limiteEsquerdo[p] = programa->semiInfinita ? fita->origem : 0;
+}
+
+// Põe na pista 'p' a próxima palavra que pode ser iniciada. Palavras com símbolos desconhecidos são
+// entregues a 'concluir' sem resultado. Retorna 0 se a pista recebeu uma palavra, 1 se acabaram e -1 se
+// faltou memória.
+static int abastecer_pista(Pistas* pistas, int p, const ProgramaCompilado* programa, const char* const* palavras,
+                           int numPalavras, int* proxima, ConcluirPalavra concluir, void* contexto) {
+    Fita* fita = &pistas->fitas[p];
+    while (*proxima < numPalavras) {
+        int indice = (*proxima)++;
+        int64_t necessarias = (int64_t) strlen(palavras[indice]) * 2 + 64;
+        if (fita->capacidade > CELULAS_MAXIMAS_REAPROVEITADAS && fita->capacidade > 4 * necessarias) fita_liberar(fita);
+        if (fita_iniciar(fita, programa, palavras[indice]) != 0) {
+            if (ultimo_codigo_erro() == TRADUTOR_ERRO_MEMORIA) return -1;
+            concluir(contexto, indice, NULL, NULL);
+            continue;
+        }
+        carregar_pista(pistas, p, programa);
+        pistas->linha[p] = programa->estadoInicial * programa->numColunas;
+        pistas->passos[p] = 0;
+        pistas->palavra[p] = indice;
+        pistas->motivo[p] = PISTA_ATIVA;
+        return 0;
+    }
+    return 1;
+}
+
+int executar_lote(const ProgramaCompilado* programa, const char* const* palavras, int numPalavras, int numPistas,
+                  uint64_t limitePassos, ConcluirPalavra concluir, void* contexto) {
+    if (numPistas < 1) numPistas = 1;
+    if (numPistas > numPalavras) numPistas = numPalavras > 0 ? numPalavras : 1;
+    Pistas pistas;
+    pistas.fitas = (Fita*) alocar_zerado(numPistas, sizeof(Fita));
+    pistas.celulas = (uint32_t**) alocar(numPistas * sizeof(uint32_t*));
+    pistas.cabeca = (int64_t*) alocar(numPistas * sizeof(int64_t));
+    pistas.limiteEsquerdo = (int64_t*) alocar(numPistas * sizeof(int64_t));
+    pistas.capacidade = (int64_t*) alocar(numPistas * sizeof(int64_t));
+    pistas.linha = (uint32_t*) alocar(numPistas * sizeof(uint32_t));
+    pistas.entrada = (uint32_t*) alocar(numPistas * sizeof(uint32_t));
+    pistas.passos = (uint64_t*) alocar(numPistas * sizeof(uint64_t));
+    pistas.palavra = (int*) alocar(numPistas * sizeof(int));
+    pistas.motivo = (uint8_t*) alocar(numPistas);
+    if (!pistas.fitas || !pistas.celulas || !pistas.cabeca || !pistas.limiteEsquerdo || !pistas.capacidade || !pistas.linha ||
+        !pistas.entrada || !pistas.passos || !pistas.palavra || !pistas.motivo) {
+        registrar_falta_de_memoria("as pistas da execução em lote");
+        liberar_pistas(&pistas, numPistas);
+        return -1;
+    }
+
+    // As pistas ativas ficam sempre em [0, ativas): uma pista parada recebe a próxima palavra ou a última ativa
+    int proxima = 0;
+    int ativas = 0;
+    int resultado = 0;
+    while (ativas < numPistas) {
+        int abastecida = abastecer_pista(&pistas, ativas, programa, palavras, numPalavras, &proxima, concluir, contexto);
+        if (abastecida < 0) resultado = -1;
+        if (abastecida != 0) break;
+        ativas++;
+    }
+
+    const AcaoCompilada* acoes = programa->acoes;
+    while (ativas > 0 && resultado == 0) {
+        // A última palavra não tem com quem sobrepor as faltas de cache: termina no laço principal
+        if (ativas == 1 && proxima >= numPalavras && pistas.motivo[0] == PISTA_ATIVA) {
+            Fita* fita = &pistas.fitas[0];
+            fita->cabeca = pistas.cabeca[0];
+            ResultadoExecucao fim = continuar_execucao(programa, fita, pistas.linha[0], pistas.passos[0], limitePassos);
+            concluir(contexto, pistas.palavra[0], &fim, fita);
+            break;
+        }
+        for (int rodada = 0; rodada < PASSOS_POR_RODADA; rodada++) {
+            // Entrada da tabela de cada pista, com a linha de cache pedida antes de ser usada
+            for (int p = 0; p < ativas; p++) {
+                pistas.entrada[p] = pistas.linha[p] + pistas.celulas[p][pistas.cabeca[p]];
+                __builtin_prefetch(&acoes[pistas.entrada[p]]);
+            }
+            for (int p = 0; p < ativas; p++) {
+                if (pistas.motivo[p] != PISTA_ATIVA) continue;
+                const AcaoCompilada* acao = &acoes[pistas.entrada[p]];
+                if (pistas.passos[p] >= limitePassos || (acao->flags & (ACAO_PARADA | ACAO_SEM_REGRA))) {
+                    pistas.motivo[p] = pistas.passos[p] >= limitePassos ? MOTIVO_LIMITE
+                                     : (acao->flags & ACAO_PARADA) ? MOTIVO_PARADA : MOTIVO_SEM_REGRA;
+                    continue;
+                }
+                uint32_t* celula = &pistas.celulas[p][pistas.cabeca[p]];
+                *celula = (*celula & acao->mascara) | acao->valor;
+                int64_t cabeca = pistas.cabeca[p] + acao->movimento;
+                pistas.linha[p] = acao->proximaLinha;
+                pistas.passos[p]++;
+                if (cabeca < pistas.limiteEsquerdo[p] || cabeca >= pistas.capacidade[p]) {
+                    Fita* fita = &pistas.fitas[p];
+                    fita->cabeca = cabeca;
+                    if (fita_ajustar(fita, programa) < 0) {
+                        fita->cabeca = cabeca < 0 ? 0 : fita->capacidade - 1;
+                        pistas.motivo[p] = MOTIVO_SEM_MEMORIA;
+                    }
+                    carregar_pista(&pistas, p, programa);
+                    continue;
+                }
+                pistas.cabeca[p] = cabeca;
+            }
+        }
+
+        // Entrega as pistas paradas e as reabastece
+        for (int p = 0; p < ativas && resultado == 0; ) {
+            if (pistas.motivo[p] == PISTA_ATIVA) {
+                p++;
+                continue;
+            }
+            ResultadoExecucao fim;
+            fim.estadoFinal = pistas.linha[p] / programa->numColunas;
+            fim.passos = pistas.passos[p];
+            fim.motivo = (MotivoFim) pistas.motivo[p];
+            pistas.fitas[p].cabeca = pistas.cabeca[p];
+            concluir(contexto, pistas.palavra[p], &fim, &pistas.fitas[p]);
+
+            int abastecida = abastecer_pista(&pistas, p, programa, palavras, numPalavras, &proxima, concluir, contexto);
+            if (abastecida < 0) resultado = -1;
+            if (abastecida == 0) continue;
+            // Sem palavras: a última pista ativa ocupa o lugar desta
+            ativas--;
+            if (p != ativas) {
+                Fita fita = pistas.fitas[p];
+                pistas.fitas[p] = pistas.fitas[ativas];
+                pistas.fitas[ativas] = fita;
+                pistas.celulas[p] = pistas.celulas[ativas];
+                pistas.cabeca[p] = pistas.cabeca[ativas];
+                pistas.limiteEsquerdo[p] = pistas.limiteEsquerdo[ativas];
+                pistas.capacidade[p] = pistas.capacidade[ativas];
+                pistas.linha[p] = pistas.linha[ativas];
+                pistas.passos[p] = pistas.passos[ativas];
+                pistas.palavra[p] = pistas.palavra[ativas];
+                pistas.motivo[p] = pistas.motivo[ativas];
+            }
+        }
+    }
+
+    liberar_pistas(&pistas, numPistas);
+    return resultado;
+}
+
+// Conteúdo da fita sem os brancos das pontas (ou "_" se ela estiver vazia)
+void fita_escrever(const Fita* fita, const ProgramaCompilado* programa, FILE* saida) {
+    int64_t inicio = 0, fim = fita->capacidade;
+    while (inicio < fim && fita->celulas[inicio] == programa->colunaBranco) inicio++;
+    while (fim > inicio && fita->celulas[fim - 1] == programa->colunaBranco) fim--;
+    if (inicio == fim) {
+        fputs("_", saida);
+        return;
+    }
+    for (int64_t i = inicio; i < fim; i++) fputs(nome_coluna(programa, fita->celulas[i]), saida);
+}
+
+const char* descrever_motivo(MotivoFim motivo) {
+    switch (motivo) {
+        case MOTIVO_PARADA:      return "parada";
+        case MOTIVO_SEM_REGRA:   return "sem regra";
+        case MOTIVO_SEM_MEMORIA: return "sem memória";
+        default:                 return "limite de passos";
+    }
+}
+
+
+
+// === Verificação diferencial ===
+// Executa a máquina original e a traduzida lado a lado sobre as mesmas palavras de entrada e compara
+// o estado de parada e a fita normalizada (sem brancos nas pontas e, na traduzida, sem os símbolos
+// que não existem na original, que são os marcadores da tradução). Na fita dobrada, cada par é
+// separado nas duas trilhas com os mesmos nomes que traduzir_I_para_S_dobrada escolheu, e a fita
+// original é remontada antes da comparação.
+// O espaço de palavras é dividido entre as threads, que roubam metade do trabalho umas das outras
+// quando a sua faixa acaba. Um erro numa thread (falta de memória para a fita, por exemplo) para
+// todas, e executar_verificacao o registra na thread que a chamou.
+
+#define BLOCO_VERIFICACAO 64
+
+typedef struct {
+    pthread_mutex_t trava;
+    uint64_t inicio;   // próxima palavra da faixa desta thread
+    uint64_t fim;
+} FaixaTrabalho;
+
+struct Verificacao {
+    ProgramaCompilado* original;
+    ProgramaCompilado* traduzida;
+    uint8_t* marcadoresTraduzida;  // por coluna da traduzida: 1 se o símbolo não existe na original
+    const char** trilhasTraduzida; // fita dobrada: por coluna da traduzida, os símbolos da direita e da esquerda
+    ParametrosVerificacao parametros;
+    char alfabeto[257];
+    size_t tamanhoAlfabeto;
+    uint64_t numEnumeradas;
+    uint64_t totalPalavras;       // enumeradas + aleatórias
+    uint64_t limitePassosTraduzida;
+    FaixaTrabalho* faixas;
+    int numThreads;
+    uint64_t menorContraExemplo;  // índice da primeira palavra que diverge (UINT64_MAX se nenhuma)
+    uint64_t verificadas;
+    uint64_t inconclusivas;       // a original não parou dentro do limite
+    int falhou;                   // uma thread encontrou um erro: as outras param
+    CodigoErro codigoFalha;
+    char mensagemFalha[512];
+    pthread_mutex_t travaRelato;
+    char relato[2048];
+};
+
+void palavra_da_verificacao(const Verificacao* v, uint64_t indice, char* palavra) {
+    size_t k = v->tamanhoAlfabeto;
+    if (indice < v->numEnumeradas) {
+        int comprimento = 0;
+        uint64_t quantidade = 1;
+        while (indice >= quantidade) {
+            indice -= quantidade;
+            quantidade *= k;
+            comprimento++;
+        }
+        for (int i = comprimento - 1; i >= 0; i--) {
+            palavra[i] = v->alfabeto[indice % k];
+            indice /= k;
+        }
+        palavra[comprimento] = '\0';
+        return;
+    }
+
+    uint64_t estado = hash_chave(v->parametros.semente ^ hash_chave(indice));
+    int comprimento = (int) (estado % (uint64_t) (v->parametros.comprimentoAleatorio + 1));
+    for (int i = 0; i < comprimento; i++) {
+        estado = hash_chave(estado + 0x9e3779b97f4a7c15ULL);
+        palavra[i] = v->alfabeto[estado % k];
+    }
+    palavra[comprimento] = '\0';
+}
+
+// Acrescenta 'nome' ao texto em 'buffer' (que cresce se precisar). Retorna -1 se faltar memória.
+static int anexar_nome(char** buffer, size_t* capacidade, size_t* usados, const char* nome) {
+    size_t tamanho = strlen(nome);
+    if (*usados + tamanho + 1 > *capacidade) {
+        size_t novaCapacidade = (*usados + tamanho + 1) * 2;
+        char* novo = (char*) realocar(*buffer, novaCapacidade);
+        if (!novo) {
+            registrar_falta_de_memoria("a fita normalizada");
+            return -1;
+        }
+        *buffer = novo;
+        *capacidade = novaCapacidade;
+    }
+    memcpy(*buffer + *usados, nome, tamanho);
+    *usados += tamanho;
+    return 0;
+}
+
+// Fecha o texto de 'usados' bytes, sem brancos nas pontas
+static int aparar_brancos(char** buffer, size_t* capacidade, size_t usados) {
+    if (!*buffer) {
+        *buffer = (char*) alocar(16);
+        if (!*buffer) {
+            registrar_falta_de_memoria("a fita normalizada");
+            return -1;
+        }
+        *capacidade = 16;
+    }
+
+    size_t inicio = 0;
+    while (inicio < usados && (*buffer)[inicio] == '_') inicio++;
+    while (usados > inicio && (*buffer)[usados - 1] == '_') usados--;
+    memmove(*buffer, *buffer + inicio, usados - inicio);
+    usados -= inicio;
+    (*buffer)[usados] = '\0';
+    return 0;
+}
+
+// Fita sem as colunas marcadas em 'ignorar' (NULL: nenhuma) e sem brancos nas pontas, como texto,
+// em 'buffer' (que cresce se precisar). Retorna -1 se faltar memória.
+static int fita_normalizada(const Fita* fita, const ProgramaCompilado* programa, const uint8_t* ignorar,
+                            char** buffer, size_t* capacidade) {
+    size_t usados = 0;
+    for (int64_t i = 0; i < fita->capacidade; i++) {
+        if (ignorar && ignorar[fita->celulas[i]]) continue;
+        if (anexar_nome(buffer, capacidade, &usados, nome_coluna(programa, fita->celulas[i])) != 0) return -1;
+    }
+    return aparar_brancos(buffer, capacidade, usados);
+}
+
+// Fita dobrada desfeita: a trilha da esquerda, de trás para frente, seguida da da direita. 'trilhas' tem,
+// por coluna, o símbolo da direita e o da esquerda; a marca da célula 0 some na decodificação.
+static int fita_dobrada_normalizada(const Fita* fita, const char** trilhas, char** buffer, size_t* capacidade) {
+    size_t usados = 0;
+    for (int64_t i = fita->capacidade - 1; i >= fita->origem; i--) {
+        if (anexar_nome(buffer, capacidade, &usados, trilhas[2 * (size_t) fita->celulas[i] + 1]) != 0) return -1;
+    }
+    for (int64_t i = fita->origem; i < fita->capacidade; i++) {
+        if (anexar_nome(buffer, capacidade, &usados, trilhas[2 * (size_t) fita->celulas[i]]) != 0) return -1;
+    }
+    return aparar_brancos(buffer, capacidade, usados);
+}
+
+typedef struct {
+    Fita fitaOriginal;
+    Fita fitaTraduzida;
+    char* textoOriginal;
+    size_t capacidadeOriginal;
+    char* textoTraduzida;
+    size_t capacidadeTraduzida;
+    char* palavra;
+} ContextoVerificacao;
+
+// Guarda o erro registrado nesta thread, se for o primeiro, e faz as outras threads pararem
+static void falhar_verificacao(Verificacao* v) {
+    pthread_mutex_lock(&v->travaRelato);
+    if (!v->falhou) {
+        v->codigoFalha = ultimo_codigo_erro();
+        snprintf(v->mensagemFalha, sizeof(v->mensagemFalha), "%s", ultimo_erro());
+        __atomic_store_n(&v->falhou, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&v->travaRelato);
+}
+
+static int normalizar_fitas(Verificacao* v, ContextoVerificacao* ctx) {
+    if (fita_normalizada(&ctx->fitaOriginal, v->original, NULL, &ctx->textoOriginal, &ctx->capacidadeOriginal) != 0) return -1;
+    if (v->trilhasTraduzida) {
+        return fita_dobrada_normalizada(&ctx->fitaTraduzida, v->trilhasTraduzida, &ctx->textoTraduzida, &ctx->capacidadeTraduzida);
+    }
+    return fita_normalizada(&ctx->fitaTraduzida, v->traduzida, v->marcadoresTraduzida, &ctx->textoTraduzida, &ctx->capacidadeTraduzida);
+}
+
+// Retorna 1 se a palavra é um contraexemplo, 0 se as máquinas concordam, -1 se é inconclusiva e -2 em caso de erro
+static int verificar_palavra(Verificacao* v, ContextoVerificacao* ctx, uint64_t indice) {
+    palavra_da_verificacao(v, indice, ctx->palavra);
+    if (fita_iniciar(&ctx->fitaOriginal, v->original, ctx->palavra) != 0 ||
+        fita_iniciar(&ctx->fitaTraduzida, v->traduzida, ctx->palavra) != 0) {
+        return -2;
+    }
+
+    ResultadoExecucao ro = executar_programa(v->original, &ctx->fitaOriginal, v->parametros.limitePassos);
+    if (ro.motivo == MOTIVO_LIMITE) return -1;
+    ResultadoExecucao rt = ro.motivo == MOTIVO_SEM_MEMORIA ? ro
+                         : executar_programa(v->traduzida, &ctx->fitaTraduzida, v->limitePassosTraduzida);
+    // Uma fita que não pôde crescer não diz nada sobre a tradução
+    if (ro.motivo == MOTIVO_SEM_MEMORIA || rt.motivo == MOTIVO_SEM_MEMORIA) return -2;
+
+    // Parada em 'halt*': o estado final precisa ter o mesmo nome. Parada sem regra: a traduzida
+    // também precisa parar sem regra (os nomes dos estados intermediários mudam na tradução).
+    int concorda = ro.motivo == rt.motivo;
+    if (concorda && ro.motivo == MOTIVO_PARADA) {
+        concorda = strcmp(nome_estado(v->original->maquina, ro.estadoFinal), nome_estado(v->traduzida->maquina, rt.estadoFinal)) == 0;
+    }
+    if (concorda) {
+        if (normalizar_fitas(v, ctx) != 0) return -2;
+        concorda = strcmp(ctx->textoOriginal, ctx->textoTraduzida) == 0;
+    }
+    if (concorda) return 0;
+
+    // Registra o contraexemplo se ele for o de menor índice encontrado até agora
+    if (normalizar_fitas(v, ctx) != 0) return -2;
+    pthread_mutex_lock(&v->travaRelato);
+    if (indice < __atomic_load_n(&v->menorContraExemplo, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&v->menorContraExemplo, indice, __ATOMIC_RELAXED);
+        snprintf(v->relato, sizeof(v->relato),
+                 "Palavra:   \"%s\"\n"
+                 "Original:  %s (%s) após %llu passos, fita \"%s\"\n"
+                 "Traduzida: %s (%s) após %llu passos, fita \"%s\"\n",
+                 ctx->palavra,
+                 nome_estado(v->original->maquina, ro.estadoFinal), descrever_motivo(ro.motivo),
+                 (unsigned long long) ro.passos, ctx->textoOriginal,
+                 nome_estado(v->traduzida->maquina, rt.estadoFinal), descrever_motivo(rt.motivo),
+                 (unsigned long long) rt.passos, ctx->textoTraduzida);
+    }
+    pthread_mutex_unlock(&v->travaRelato);
+    return 1;
+}
+
+// Pega um bloco da própria faixa ou, se ela acabou, rouba metade da maior faixa restante
+static int obter_trabalho(Verificacao* v, int minhaThread, uint64_t* inicio, uint64_t* fim) {
+    FaixaTrabalho* minha = &v->faixas[minhaThread];
+    for (;;) {
+        if (__atomic_load_n(&v->falhou, __ATOMIC_RELAXED)) return 0;
+        pthread_mutex_lock(&minha->trava);
+        if (minha->inicio < minha->fim) {
+            *inicio = minha->inicio;
+            *fim = minha->fim - minha->inicio > BLOCO_VERIFICACAO ? minha->inicio + BLOCO_VERIFICACAO : minha->fim;
+            minha->inicio = *fim;
+            pthread_mutex_unlock(&minha->trava);
+            return 1;
+        }
+        pthread_mutex_unlock(&minha->trava);
+
+        int vitima = -1;
+        uint64_t maiorRestante = 0;
+        for (int t = 0; t < v->numThreads; t++) {
+            if (t == minhaThread) continue;
+            pthread_mutex_lock(&v->faixas[t].trava);
+            uint64_t restante = v->faixas[t].fim - v->faixas[t].inicio;
+            pthread_mutex_unlock(&v->faixas[t].trava);
+            if (restante > maiorRestante) {
+                maiorRestante = restante;
+                vitima = t;
+            }
+        }
+        if (vitima < 0) return 0;
+
+        FaixaTrabalho* alvo = &v->faixas[vitima];
+        pthread_mutex_lock(&alvo->trava);
+        uint64_t restante = alvo->fim - alvo->inicio;
+        uint64_t meio = restante > 1 ? alvo->inicio + restante / 2 : alvo->inicio;
+        uint64_t roubadoInicio = meio, roubadoFim = alvo->fim;
+        if (restante > 0) alvo->fim = meio;
+        pthread_mutex_unlock(&alvo->trava);
+        if (roubadoInicio >= roubadoFim) continue;
+
+        pthread_mutex_lock(&minha->trava);
+        minha->inicio = roubadoInicio;
+        minha->fim = roubadoFim;
+        pthread_mutex_unlock(&minha->trava);
+    }
+}
+
+typedef struct {
+    Verificacao* verificacao;
+    int indiceThread;
+} ArgumentoVerificacao;
+
+static void* trabalhador_verificacao(void* argumento) {
+    ArgumentoVerificacao* arg = (ArgumentoVerificacao*) argumento;
+    Verificacao* v = arg->verificacao;
+    ContextoVerificacao ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    int maiorComprimento = v->parametros.comprimentoMaximo > v->parametros.comprimentoAleatorio
+                         ? v->parametros.comprimentoMaximo : v->parametros.comprimentoAleatorio;
+    ctx.palavra = (char*) alocar((size_t) maiorComprimento + 1);
+    if (!ctx.palavra) {
+        registrar_falta_de_memoria("a palavra de entrada");
+        falhar_verificacao(v);
+        return NULL;
+    }
+
+    uint64_t inicio, fim;
+    while (obter_trabalho(v, arg->indiceThread, &inicio, &fim)) {
+        uint64_t verificadas = 0, inconclusivas = 0;
+        for (uint64_t i = inicio; i < fim; i++) {
+            if (i > __atomic_load_n(&v->menorContraExemplo, __ATOMIC_RELAXED)) break; // já há um anterior
+            int r = verificar_palavra(v, &ctx, i);
+            if (r == -2) {
+                falhar_verificacao(v);
+                break;
+            }
+            verificadas++;
+            if (r < 0) inconclusivas++;
+        }
+        __atomic_fetch_add(&v->verificadas, verificadas, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&v->inconclusivas, inconclusivas, __ATOMIC_RELAXED);
+    }
+
+    fita_liberar(&ctx.fitaOriginal);
+    fita_liberar(&ctx.fitaTraduzida);
+    free(ctx.textoOriginal);
+    free(ctx.textoTraduzida);
+    free(ctx.palavra);
+    return NULL;
+}
+
+// Alfabeto padrão: símbolos de um caractere lidos pela máquina original, exceto '_' e '*'
+static void alfabeto_padrao(const MaquinaTuring* maquina, char* alfabeto, size_t capacidade) {
+    char presente[256] = { 0 };
+    for (int i = 0; i < maquina->numTransicoes; i++) {
+        IdNome s = maquina->transicoes[i].simboloAtual;
+        if (maquina->simbolos.tamanhos[s] == 1) presente[(unsigned char) nome_simbolo(maquina, s)[0]] = 1;
+    }
+    presente['_'] = presente['*'] = presente[' '] = 0;
+    size_t n = 0;
+    for (int c = 0; c < 256 && n + 1 < capacidade; c++) {
+        if (presente[c]) alfabeto[n++] = (char) c;
+    }
+    alfabeto[n] = '\0';
+}
+
+// Símbolos das duas trilhas de cada coluna da traduzida pela fita dobrada. Uma coluna que não é par
+// (um caractere da palavra de entrada fora do alfabeto da máquina) fica na trilha da direita.
+static int decodificar_pares(Verificacao* v, const MaquinaTuring* original) {
+    int k;
+    const char** alfabeto = alfabeto_da_maquina(original, &k);
+    char (*nomesPares)[2] = alfabeto ? (char (*)[2]) alocar(2 * (size_t) k * k * sizeof(*nomesPares)) : NULL;
+    v->trilhasTraduzida = nomesPares ? (const char**) alocar(2 * (size_t) v->traduzida->numColunas * sizeof(const char*)) : NULL;
+    if (!v->trilhasTraduzida) {
+        if (alfabeto) registrar_falta_de_memoria("as trilhas da fita dobrada");
+        free(alfabeto);
+        free(nomesPares);
+        return -1;
+    }
+    int indiceBranco = indice_do_branco(alfabeto);
+    int resultado = nomear_pares(alfabeto, k, indiceBranco, nomesPares);
+    for (uint32_t c = 0; c < v->traduzida->numColunas && resultado == 0; c++) {
+        const char* nome = nome_coluna(v->traduzida, c);
+        v->trilhasTraduzida[2 * c] = nome;
+        v->trilhasTraduzida[2 * c + 1] = "_";
+        for (int p = 0; p < 2 * k * k; p++) {
+            if (strcmp(nome_do_par(alfabeto, k, indiceBranco, nomesPares, p), nome) == 0) {
+                v->trilhasTraduzida[2 * c] = alfabeto[p / k % k];
+                v->trilhasTraduzida[2 * c + 1] = alfabeto[p % k];
+                break;
+            }
+        }
+    }
+    free(alfabeto);
+    free(nomesPares);
+    return resultado;
+}
+
+static void resultado_da_verificacao(const Verificacao* v, ResultadoVerificacao* resultado) {
+    resultado->totalPalavras = v->totalPalavras;
+    snprintf(resultado->alfabeto, sizeof(resultado->alfabeto), "%s", v->alfabeto);
+    resultado->verificadas = v->verificadas;
+    resultado->inconclusivas = v->inconclusivas;
+    resultado->contraExemplo = v->menorContraExemplo;
+    snprintf(resultado->relato, sizeof(resultado->relato), "%s", v->relato);
+}
+
+Verificacao* preparar_verificacao(const MaquinaTuring* original, const MaquinaTuring* traduzida,
+                                  const ParametrosVerificacao* parametros, ResultadoVerificacao* resultado) {
+    if (parametros->comprimentoMaximo < 0 || parametros->comprimentoAleatorio < 0) {
+        registrar_erro(TRADUTOR_ERRO_ENTRADA, "Comprimento de palavra negativo.");
+        return NULL;
+    }
+    Verificacao* v = (Verificacao*) alocar_zerado(1, sizeof(Verificacao));
+    if (!v) {
+        registrar_falta_de_memoria("a verificação");
+        return NULL;
+    }
+    v->parametros = *parametros;
+    if (parametros->alfabeto) snprintf(v->alfabeto, sizeof(v->alfabeto), "%s", parametros->alfabeto);
+    else alfabeto_padrao(original, v->alfabeto, sizeof(v->alfabeto));
+    v->parametros.alfabeto = v->alfabeto;
+    v->tamanhoAlfabeto = strlen(v->alfabeto);
+    if (v->tamanhoAlfabeto == 0) {
+        registrar_erro(TRADUTOR_ERRO_ENTRADA, "Alfabeto de entrada vazio.");
+        liberar_verificacao(v);
+        return NULL;
+    }
+
+    v->original = compilar_maquina(original, v->alfabeto, "0");
+    v->traduzida = v->original ? compilar_maquina(traduzida, v->alfabeto, "0") : NULL;
+    if (!v->traduzida) {
+        liberar_verificacao(v);
+        return NULL;
+    }
+    if (parametros->macropassos) {
+        acelerar_programa(v->original);
+        acelerar_programa(v->traduzida);
+    }
+    if (parametros->fitaDobrada && decodificar_pares(v, original) != 0) {
+        liberar_verificacao(v);
+        return NULL;
+    }
+    v->marcadoresTraduzida = (uint8_t*) alocar(v->traduzida->numColunas);
+    if (!v->marcadoresTraduzida) {
+        registrar_falta_de_memoria("os marcadores");
+        liberar_verificacao(v);
+        return NULL;
+    }
+    for (uint32_t c = 0; c < v->traduzida->numColunas; c++) {
+        const char* nome = nome_coluna(v->traduzida, c);
+        v->marcadoresTraduzida[c] = buscar_nome(&original->simbolos, &original->arena, nome, strlen(nome)) == ID_INEXISTENTE &&
+                                    strcmp(nome, "_") != 0 && !(nome[1] == '\0' && strchr(v->alfabeto, nome[0]));
+    }
+
+    // Um produto que não cabe em 64 bits vira o maior limite, em vez de dar a volta num limite pequeno
+    v->limitePassosTraduzida = parametros->fatorTraduzida != 0 && parametros->limitePassos > UINT64_MAX / parametros->fatorTraduzida
+                             ? UINT64_MAX : parametros->limitePassos * parametros->fatorTraduzida;
+    uint64_t quantidade = 1;
+    for (int n = 0; n <= parametros->comprimentoMaximo; n++) {
+        v->numEnumeradas += quantidade;
+        if (quantidade > UINT64_MAX / 2 / v->tamanhoAlfabeto) {
+            registrar_erro(TRADUTOR_ERRO_ENTRADA, "Espaço de palavras grande demais; reduza -n.");
+            liberar_verificacao(v);
+            return NULL;
+        }
+        quantidade *= v->tamanhoAlfabeto;
+    }
+    v->totalPalavras = v->numEnumeradas + parametros->numAleatorias;
+    v->menorContraExemplo = UINT64_MAX;
+    if (resultado) resultado_da_verificacao(v, resultado);
+    return v;
+}
+
+int executar_verificacao(Verificacao* v, int numThreads, ResultadoVerificacao* resultado) {
+    // Cada thread começa com uma fatia contígua; o roubo de trabalho equilibra o resto
+    if (numThreads < 1) numThreads = 1;
+    v->numThreads = numThreads;
+    free(v->faixas);
+    v->faixas = (FaixaTrabalho*) alocar(numThreads * sizeof(FaixaTrabalho));
+    pthread_t* threads = (pthread_t*) alocar(numThreads * sizeof(pthread_t));
+    ArgumentoVerificacao* argumentos = (ArgumentoVerificacao*) alocar(numThreads * sizeof(ArgumentoVerificacao));
+    if (!v->faixas || !threads || !argumentos) {
+        registrar_falta_de_memoria("as threads da verificação");
+        free(threads);
+        free(argumentos);
+        return -1;
+    }
+    pthread_mutex_init(&v->travaRelato, NULL);
+    for (int t = 0; t < numThreads; t++) {
+        pthread_mutex_init(&v->faixas[t].trava, NULL);
+        v->faixas[t].inicio = v->totalPalavras * t / numThreads;
+        v->faixas[t].fim = v->totalPalavras * (t + 1) / numThreads;
+        argumentos[t].verificacao = v;
+        argumentos[t].indiceThread = t;
+    }
+
+    // Uma só thread roda aqui mesmo; se alguma thread não foi criada, as outras roubam a sua faixa
+    int criadas = 0;
+    while (numThreads > 1 && criadas < numThreads &&
+           pthread_create(&threads[criadas], NULL, trabalhador_verificacao, &argumentos[criadas]) == 0) {
+        criadas++;
+    }
+    if (criadas == 0) trabalhador_verificacao(&argumentos[0]);
+    for (int t = 0; t < criadas; t++) pthread_join(threads[t], NULL);
+
+    for (int t = 0; t < numThreads; t++) pthread_mutex_destroy(&v->faixas[t].trava);
+    pthread_mutex_destroy(&v->travaRelato);
+    free(threads);
+    free(argumentos);
+    if (v->falhou) {
+        registrar_erro(v->codigoFalha, "%s", v->mensagemFalha);
+        return -1;
+    }
+    if (resultado) resultado_da_verificacao(v, resultado);
+    return 0;
+}
+
+void liberar_verificacao(Verificacao* v) {
+    if (!v) return;
+    free(v->faixas);
+    free(v->marcadoresTraduzida);
+    free(v->trilhasTraduzida);
+    liberar_programa(v->original);
+    liberar_programa(v->traduzida);
+    free(v);
+}
+
+
+// === Geração de código C ===
+// O programa compilado vira um programa C independente: cada estado é um rótulo com um 'switch' sobre
+// o símbolo da célula, e a fita guarda as colunas da tabela no menor tipo inteiro que as comporta.
+// Como a tabela já tem os curingas e os estados de parada resolvidos, o programa gerado se comporta
+// exatamente como executar_programa sem macropassos, e imprime o resultado no formato do modo "run".
+//
+// Os estados ficam em grupos de ESTADOS_POR_GRUPO, uma função por grupo: dentro do grupo as transições
+// são um 'goto', e para sair dele a função devolve o próximo estado ao laço de execucao. Numa função
+// só com todos os estados, o tempo de compilação do gcc cresce mais do que linearmente. Os estados
+// de uma mesma sub-rotina costumam ter IDs vizinhos, então quase todos os passos ficam no grupo.
+#define ESTADOS_POR_GRUPO 64
+
+static void escritor_formatar(EscritorSaida* escritor, const char* formato, ...) {
+    char texto[512];
+    va_list args;
+    va_start(args, formato);
+    int n = vsnprintf(texto, sizeof(texto), formato, args);
+    va_end(args);
+    if (n > 0) escritor_bytes(escritor, texto, (size_t) n < sizeof(texto) ? (size_t) n : sizeof(texto) - 1);
+}
+
+// Escreve 'nome' como literal de string do C
+static void escritor_literal_c(EscritorSaida* escritor, const char* nome) {
+    escritor_bytes(escritor, "\"", 1);
+    for (const unsigned char* c = (const unsigned char*) nome; *c; c++) {
+        if (*c == '"' || *c == '\\' || *c == '?') {
+            char escape[2] = { '\\', (char) *c };
+            escritor_bytes(escritor, escape, 2);
+        } else if (*c < 32 || *c >= 127) {
+            escritor_formatar(escritor, "\\%03o", *c);
+        } else {
+            escritor_bytes(escritor, (const char*) c, 1);
+        }
+    }
+    escritor_bytes(escritor, "\"", 1);
+}
+
+// Mesma ação, com "escrever o símbolo lido" tratado como "manter o símbolo"
+static int acoes_iguais(const AcaoCompilada* a, uint32_t colunaA, const AcaoCompilada* b, uint32_t colunaB) {
+    uint32_t escritaA = a->mascara ? colunaA : a->valor;
+    uint32_t escritaB = b->mascara ? colunaB : b->valor;
+    int mantemA = escritaA == colunaA, mantemB = escritaB == colunaB;
+    return a->flags == b->flags && a->proximaLinha == b->proximaLinha && a->movimento == b->movimento &&
+           mantemA == mantemB && (mantemA || escritaA == escritaB);
+}
+
+// Código de uma ação (sem o 'case'), executada sobre a coluna 'coluna' do estado 'estado'
+static void escrever_acao_c(EscritorSaida* escritor, const ProgramaCompilado* programa, const AcaoCompilada* acao,
+                            uint32_t coluna, uint32_t estado) {
+    if (acao->flags & ACAO_PARADA) {
+        escritor_formatar(escritor, "PARAR(%u, MOTIVO_PARADA);\n", estado);
+        return;
+    }
+    if (acao->flags & ACAO_SEM_REGRA) {
+        escritor_formatar(escritor, "PARAR(%u, MOTIVO_SEM_REGRA);\n", estado);
+        return;
+    }
+    uint32_t escrita = acao->mascara ? coluna : acao->valor;
+    uint32_t proximo = acao->proximaLinha / programa->numColunas;
+    if (escrita != coluna) escritor_formatar(escritor, "fita[cabeca] = %u; ", escrita);
+    const char* movimento = acao->movimento < 0 ? "ESQUERDA" : (acao->movimento > 0 ? "DIREITA" : "PARADO");
+    if (proximo / ESTADOS_POR_GRUPO == estado / ESTADOS_POR_GRUPO) escritor_formatar(escritor, "%s; goto e%u;\n", movimento, proximo);
+    else escritor_formatar(escritor, "%s; SAIR(%u);\n", movimento, proximo);
+}
+
+// Bloco do estado 'e': as colunas com a mesma ação dividem o 'case', e o maior grupo vira o 'default'
+static void escrever_estado_c(EscritorSaida* escritor, const ProgramaCompilado* programa, uint32_t e, uint32_t* grupo) {
+    const AcaoCompilada* linha = &programa->acoes[(size_t) e * programa->numColunas];
+    uint32_t numColunas = programa->numColunas;
+    uint32_t padrao = 0, tamanhoPadrao = 0;
+    for (uint32_t c = 0; c < numColunas; c++) {
+        grupo[c] = c;
+        for (uint32_t anterior = 0; anterior < c; anterior++) {
+            if (grupo[anterior] == anterior && acoes_iguais(&linha[anterior], anterior, &linha[c], c)) {
+                grupo[c] = anterior;
+                break;
+            }
+        }
+    }
+    for (uint32_t c = 0; c < numColunas; c++) {
+        if (grupo[c] != c) continue;
+        uint32_t tamanho = 0;
+        for (uint32_t outra = c; outra < numColunas; outra++) tamanho += grupo[outra] == c;
+        if (tamanho > tamanhoPadrao) {
+            padrao = c;
+            tamanhoPadrao = tamanho;
+        }
+    }
+
+    escritor_formatar(escritor, "ESTADO(%u)\n", e);
+    if (tamanhoPadrao == numColunas) {
+        escritor_bytes(escritor, "    ", 4);
+        escrever_acao_c(escritor, programa, &linha[padrao], padrao, e);
+        return;
+    }
+    escritor_bytes(escritor, "    switch (fita[cabeca]) {\n", 28);
+    for (uint32_t c = 0; c < numColunas; c++) {
+        if (grupo[c] != c || c == padrao) continue;
+        escritor_bytes(escritor, "    ", 4);
+        for (uint32_t outra = c; outra < numColunas; outra++) {
+            if (grupo[outra] == c) escritor_formatar(escritor, "case %u: ", outra);
+        }
+        escrever_acao_c(escritor, programa, &linha[c], c, e);
+    }
+    escritor_bytes(escritor, "    default: ", 13);
+    escrever_acao_c(escritor, programa, &linha[padrao], padrao, e);
+    escritor_bytes(escritor, "    }\n", 6);
+}
+
+// Parte fixa do programa gerado, antes das funções dos grupos de estados
+static const char* const EXECUCAO_C =
+    "typedef struct {\n"
+    "    Celula* celulas;\n"
+    "    int64_t capacidade;\n"
+    "    int64_t cabeca;\n"
+    "    int64_t origem;\n"
+    "} Fita;\n"
+    "\n"
+    "enum { MOTIVO_PARADA, MOTIVO_SEM_REGRA, MOTIVO_LIMITE };\n"
+    "static const char* const motivos[] = { \"parada\", \"sem regra\", \"limite de passos\" };\n"
+    "\n"
+    "// Estado da execução passado de um grupo de estados para o outro\n"
+    "typedef struct {\n"
+    "    Fita fita;\n"
+    "    uint64_t passos;\n"
+    "    uint64_t limite;\n"
+    "    uint32_t estado;\n"
+    "    int motivo;  // -1 enquanto a máquina roda\n"
+    "} Execucao;\n"
+    "\n"
+    "// O cabeçote saiu da região alocada: dobra a fita; ao crescer para a esquerda o conteúdo vai para a direita\n"
+    "static Fita crescer(Fita f) {\n"
+    "    int64_t novaCapacidade = f.capacidade * 2;\n"
+    "    int64_t deslocamento = f.cabeca < 0 ? f.capacidade : 0;\n"
+    "    Celula* novas = (Celula*) malloc((size_t) novaCapacidade * sizeof(Celula));\n"
+    "    if (!novas) {\n"
+    "        fprintf(stderr, \"ERRO: Falha na realocação de memória para a fita.\\n\");\n"
+    "        exit(EXIT_FAILURE);\n"
+    "    }\n"
+    "    for (int64_t i = 0; i < novaCapacidade; i++) novas[i] = BRANCO;\n"
+    "    memcpy(novas + deslocamento, f.celulas, (size_t) f.capacidade * sizeof(Celula));\n"
+    "    free(f.celulas);\n"
+    "    f.celulas = novas;\n"
+    "    f.capacidade = novaCapacidade;\n"
+    "    f.cabeca += deslocamento;\n"
+    "    f.origem += deslocamento;\n"
+    "    return f;\n"
+    "}\n"
+    "\n"
+    "// Cada função de grupo trabalha com cópias locais da fita, que não são apelidadas pelas escritas na fita\n"
+    "#define ENTRAR Fita f = x->fita; Celula* fita = f.celulas; int64_t capacidade = f.capacidade; int64_t cabeca = f.cabeca; \\\n"
+    "               uint64_t passos = x->passos; const uint64_t limite = x->limite; uint32_t estado = x->estado; int motivo = -1;\n"
+    "#define SAIDA sair: f.celulas = fita; f.capacidade = capacidade; f.cabeca = cabeca; \\\n"
+    "              x->fita = f; x->passos = passos; x->estado = estado; x->motivo = motivo;\n"
+    "#define CRESCER { f.celulas = fita; f.capacidade = capacidade; f.cabeca = cabeca; f = crescer(f); \\\n"
+    "                  fita = f.celulas; capacidade = f.capacidade; cabeca = f.cabeca; }\n"
+    "#define DIREITA passos++; cabeca++\n"
+    "#if SEMI_INFINITA\n"
+    "#define ESQUERDA passos++; if (cabeca > 0) cabeca--\n"
+    "#else\n"
+    "#define ESQUERDA passos++; cabeca--\n"
+    "#endif\n"
+    "#define PARADO passos++\n"
+    "#define PARAR(e, m) { estado = e; motivo = m; goto sair; }\n"
+    "#define SAIR(e) { estado = e; goto sair; }\n"
+    "// A fita cresce na entrada do estado, antes de a célula ser lida (cabeca < 0 vira um valor enorme)\n"
+    "#define ESTADO(n) e##n: if ((uint64_t) cabeca >= (uint64_t) capacidade) CRESCER \\\n"
+    "                   if (passos == limite) PARAR(n, MOTIVO_LIMITE)\n"
+    "\n";
+
+static const char* const PRINCIPAL_C =
+    "static uint64_t executar(Fita* fita, uint64_t limite, uint32_t* estadoFinal, int* motivoFim) {\n"
+    "    Execucao x = { *fita, 0, limite, INICIO, -1 };\n"
+    "    while (x.motivo < 0) grupos[x.estado / ESTADOS_POR_GRUPO](&x);\n"
+    "    *fita = x.fita;\n"
+    "    *estadoFinal = x.estado;\n"
+    "    *motivoFim = x.motivo;\n"
+    "    return x.passos;\n"
+    "}\n"
+    "\n"
+    "static double relogio_segundos(void) {\n"
+    "    struct timespec agora;\n"
+    "    clock_gettime(CLOCK_MONOTONIC, &agora);\n"
+    "    return agora.tv_sec + agora.tv_nsec / 1e9;\n"
+    "}\n"
+    "\n"
+    "// Uso: programa [-p limite_de_passos] [palavra...]. Sem palavras, executa sobre a fita vazia.\n"
+    "int main(int argc, char* argv[]) {\n"
+    "    uint64_t limite = 100000000ULL;\n"
+    "    int i = 1;\n"
+    "    if (i + 1 < argc && strcmp(argv[i], \"-p\") == 0) {\n"
+    "        limite = strtoull(argv[i + 1], NULL, 10);\n"
+    "        i += 2;\n"
+    "    }\n"
+    "    int numPalavras = argc - i;\n"
+    "    for (int p = 0; p < (numPalavras > 0 ? numPalavras : 1); p++) {\n"
+    "        const char* palavra = numPalavras > 0 ? argv[i + p] : \"\";\n"
+    "        size_t tamanho = strlen(palavra);\n"
+    "        Fita fita;\n"
+    "        fita.capacidade = (int64_t) tamanho * 2 + 64;\n"
+    "        fita.celulas = (Celula*) malloc((size_t) fita.capacidade * sizeof(Celula));\n"
+    "        if (!fita.celulas) {\n"
+    "            fprintf(stderr, \"ERRO: Falha na alocação de memória para a fita.\\n\");\n"
+    "            return EXIT_FAILURE;\n"
+    "        }\n"
+    "        fita.origem = SEMI_INFINITA ? 0 : (fita.capacidade - (int64_t) tamanho) / 2;\n"
+    "        fita.cabeca = fita.origem;\n"
+    "        for (int64_t c = 0; c < fita.capacidade; c++) fita.celulas[c] = BRANCO;\n"
+    "        for (size_t c = 0; c < tamanho; c++) {\n"
+    "            int coluna = colunas[(unsigned char) palavra[c]];\n"
+    "            if (coluna < 0) {\n"
+    "                fprintf(stderr, \"ERRO: O caractere '%c' da palavra de entrada não é um símbolo conhecido.\\n\", palavra[c]);\n"
+    "                return EXIT_FAILURE;\n"
+    "            }\n"
+    "            fita.celulas[fita.origem + (int64_t) c] = (Celula) coluna;\n"
+    "        }\n"
+    "\n"
+    "        uint32_t estado;\n"
+    "        int motivo;\n"
+    "        double inicio = relogio_segundos();\n"
+    "        uint64_t passos = executar(&fita, limite, &estado, &motivo);\n"
+    "        double duracao = relogio_segundos() - inicio;\n"
+    "\n"
+    "        if (p > 0) printf(\"\\n\");\n"
+    "        printf(\"Estado final: %s\\n\", estados[estado]);\n"
+    "        printf(\"Motivo:       %s\\n\", motivos[motivo]);\n"
+    "        printf(\"Passos:       %llu\\n\", (unsigned long long) passos);\n"
+    "        printf(\"Fita:         \");\n"
+    "        int64_t primeira = 0, fimFita = fita.capacidade;\n"
+    "        while (primeira < fimFita && fita.celulas[primeira] == BRANCO) primeira++;\n"
+    "        while (fimFita > primeira && fita.celulas[fimFita - 1] == BRANCO) fimFita--;\n"
+    "        if (primeira == fimFita) fputs(\"_\", stdout);\n"
+    "        for (int64_t c = primeira; c < fimFita; c++) fputs(simbolos[fita.celulas[c]], stdout);\n"
+    "        printf(\"\\n\");\n"
+    "        fprintf(stderr, \"-> %.3f s (%.1f milhões de passos/s)\\n\", duracao, duracao > 0 ? passos / duracao / 1e6 : 0.0);\n"
+    "        free(fita.celulas);\n"
+    "    }\n"
+    "    return EXIT_SUCCESS;\n"
+    "}\n";
+
+int gerar_programa_c(const ProgramaCompilado* programa, const char* nomeArquivo) {
+    if (programa->simbolosDeslocamento) {
+        registrar_erro(TRADUTOR_ERRO_ENTRADA, "O programa não pode ter macropassos para ser convertido em C.");
+        return -1;
+    }
+    uint32_t* grupo = (uint32_t*) alocar(((size_t) programa->numColunas + 1) * sizeof(uint32_t));
+    if (!grupo) {
+        registrar_falta_de_memoria("a geração do programa C");
+        return -1;
+    }
+    EscritorSaida escritor;
+    if (escritor_abrir(&escritor, nomeArquivo, NULL) != 0) {
+        free(grupo);
+        return -1;
+    }
+
+    const char* tipoCelula = programa->numColunas <= 256 ? "uint8_t" : (programa->numColunas <= 65536 ? "uint16_t" : "uint32_t");
+    uint32_t numGrupos = (programa->numEstados + ESTADOS_POR_GRUPO - 1) / ESTADOS_POR_GRUPO;
+    escritor_formatar(&escritor, "// Máquina de Turing ;%c compilada pelo tradutor (modo compile): gcc -O2 programa.c -o programa\n\n",
+                      programa->maquina->tipo);
+    escritor_formatar(&escritor, "#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n#include <stdint.h>\n#include <time.h>\n\n");
+    escritor_formatar(&escritor, "typedef %s Celula;\n#define BRANCO %u\n#define SEMI_INFINITA %d\n#define INICIO %u\n#define ESTADOS_POR_GRUPO %d\n\n",
+                      tipoCelula, programa->colunaBranco, programa->semiInfinita, programa->estadoInicial, ESTADOS_POR_GRUPO);
+
+    // Tabelas: nome de cada coluna, nome de cada estado e coluna de cada caractere da palavra de entrada
+    escritor_formatar(&escritor, "static const char* const simbolos[%u] = {\n", programa->numColunas);
+    for (uint32_t c = 0; c < programa->numColunas; c++) {
+        escritor_bytes(&escritor, "    ", 4);
+        escritor_literal_c(&escritor, nome_coluna(programa, c));
+        escritor_bytes(&escritor, ",\n", 2);
+    }
+    escritor_formatar(&escritor, "};\n\nstatic const char* const estados[%u] = {\n", programa->numEstados);
+    for (uint32_t e = 0; e < programa->numEstados && !escritor.falhou; e++) {
+        escritor_bytes(&escritor, "    ", 4);
+        escritor_literal_c(&escritor, nome_estado(programa->maquina, e));
+        escritor_bytes(&escritor, ",\n", 2);
+    }
+    escritor_formatar(&escritor, "};\n\nstatic const int32_t colunas[256] = {");
+    for (int b = 0; b < 256; b++) {
+        escritor_formatar(&escritor, "%s%d,", b % 16 ? " " : "\n    ", programa->mapaBytes[b] == ID_INEXISTENTE ? -1 : (int) programa->mapaBytes[b]);
+    }
+    escritor_formatar(&escritor, "\n};\n\n");
+    escritor_bytes(&escritor, EXECUCAO_C, strlen(EXECUCAO_C));
+
+    // Uma função por grupo: entra no estado pedido, segue pelos 'goto' e sai ao deixar o grupo ou parar
+    for (uint32_t g = 0; g < numGrupos && !escritor.falhou; g++) {
+        uint32_t primeiro = g * ESTADOS_POR_GRUPO;
+        uint32_t fim = primeiro + ESTADOS_POR_GRUPO < programa->numEstados ? primeiro + ESTADOS_POR_GRUPO : programa->numEstados;
+        escritor_formatar(&escritor, "static void grupo%u(Execucao* x) {\n    ENTRAR\n    switch (estado) {\n", g);
+        for (uint32_t e = primeiro; e < fim; e++) escritor_formatar(&escritor, "    case %u: goto e%u;\n", e, e);
+        escritor_bytes(&escritor, "    }\n", 6);
+        for (uint32_t e = primeiro; e < fim; e++) escrever_estado_c(&escritor, programa, e, grupo);
+        escritor_bytes(&escritor, "    SAIDA\n}\n\n", 13);
+    }
+    escritor_formatar(&escritor, "static void (*const grupos[%u])(Execucao*) = {\n", numGrupos);
+    for (uint32_t g = 0; g < numGrupos; g++) escritor_formatar(&escritor, "    grupo%u,\n", g);
+    escritor_bytes(&escritor, "};\n\n", 4);
+    escritor_bytes(&escritor, PRINCIPAL_C, strlen(PRINCIPAL_C));
+
+    free(grupo);
+    return escritor_fechar(&escritor, nomeArquivo);
+}
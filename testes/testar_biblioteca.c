@@ -0,0 +1,368 @@
+// Testes de regressão da biblioteca: formato binário, máquinas somente leitura, ordem dos nomes,
+// tradução em várias threads, nomes de estados longos, tradução incremental, macropassos e minimização.
+// Uso: testar_biblioteca <maquina_de_exemplo.in> <diretorio_temporario>
+#include "../tradutor.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int falhas = 0;
+
+#define CONFERIR(condicao, ...) do {                                   \
+        if (!(condicao)) {                                             \
+            fprintf(stderr, "FALHOU %s:%d: ", __FILE__, __LINE__);     \
+            fprintf(stderr, __VA_ARGS__);                              \
+            fputc('\n', stderr);                                       \
+            falhas++;                                                  \
+        }                                                              \
+    } while (0)
+
+// Serializa no formato texto; NULL se a máquina for nula ou a serialização falhar
+static char* texto_da_maquina(const MaquinaTuring* maquina, size_t* tamanho) {
+    char* dados = NULL;
+    if (!maquina || serializar_maquina(maquina, 0, &dados, tamanho) != 0) return NULL;
+    return dados;
+}
+
+static int mesmas_maquinas(const MaquinaTuring* a, const MaquinaTuring* b) {
+    size_t tamanhoA, tamanhoB;
+    char* textoA = texto_da_maquina(a, &tamanhoA);
+    char* textoB = texto_da_maquina(b, &tamanhoB);
+    int iguais = textoA && textoB && tamanhoA == tamanhoB && memcmp(textoA, textoB, tamanhoA) == 0;
+    free(textoA);
+    free(textoB);
+    return iguais;
+}
+
+static MaquinaTuring* gerar(char tipo, int numEstados, int numSimbolos, int numTransicoes) {
+    ParametrosGerador p = { tipo, numEstados, numSimbolos, numTransicoes, 0, 40, 40, 20, 7 };
+    return gerar_maquina(&p);
+}
+
+// O que abrir_maquina_binaria promete de uma máquina aceita: nomes dentro da arena e terminados em '\0',
+// transições só com IDs das tabelas e direções conhecidas
+static int maquina_consistente(const MaquinaTuring* m) {
+    const TabelaNomes* tabelas[2] = { &m->estados, &m->simbolos };
+    for (int t = 0; t < 2; t++) {
+        for (IdNome id = 0; id < tabelas[t]->numNomes; id++) {
+            size_t fim = (size_t) tabelas[t]->deslocamentos[id] + tabelas[t]->tamanhos[id];
+            if (fim >= m->arena.usados || m->arena.bytes[fim] != '\0') return 0;
+        }
+    }
+    for (int i = 0; i < m->numTransicoes; i++) {
+        const Transicao* t = &m->transicoes[i];
+        if (t->estadoAtual >= m->estados.numNomes || t->novoEstado >= m->estados.numNomes ||
+            t->simboloAtual >= m->simbolos.numNomes || t->novoSimbolo >= m->simbolos.numNomes) return 0;
+        if (!strchr("lr*s", t->direcao) || t->direcao == '\0') return 0;
+    }
+    return 1;
+}
+
+static void testar_binario(const char* exemplo) {
+    MaquinaTuring* original = carregar_maquina(exemplo);
+    CONFERIR(original != NULL, "carregar '%s': %s", exemplo, ultimo_erro());
+    if (!original) return;
+
+    char* binario = NULL;
+    size_t tamanho = 0;
+    CONFERIR(serializar_maquina(original, 1, &binario, &tamanho) == 0, "serializar binário: %s", ultimo_erro());
+    MaquinaTuring* lida = ler_maquina(binario, tamanho);
+    CONFERIR(lida && mesmas_maquinas(original, lida), "ida e volta pelo formato binário mudou a máquina");
+
+    // Uma máquina binária é somente leitura, inclusive para nomes que ela ainda não tem
+    if (lida) {
+        int antes = lida->numTransicoes;
+        adicionar_transicao(lida, "novo", "x", "y", 'r', "outro");
+        CONFERIR(lida->erro == TRADUTOR_ERRO_SOMENTE_LEITURA && lida->numTransicoes == antes,
+                 "adicionar_transicao numa máquina binária: erro %d", (int) lida->erro);
+        CONFERIR(internar_nome(&lida->estados, &lida->arena, "outro", 5) == ID_INEXISTENTE &&
+                 ultimo_codigo_erro() == TRADUTOR_ERRO_SOMENTE_LEITURA, "internar_nome numa tabela binária");
+    }
+    liberar_maquina(lida);
+
+    // Arquivo truncado e fim do arquivo sobrescrito com 0xff
+    CONFERIR(!ler_maquina(binario, tamanho - 1) && ultimo_codigo_erro() == TRADUTOR_ERRO_FORMATO, "binário truncado foi aceito");
+    char* corrompido = (char*) malloc(tamanho);
+    memcpy(corrompido, binario, tamanho);
+    memset(corrompido + tamanho - 12, 0xff, 12);
+    CONFERIR(!ler_maquina(corrompido, tamanho) && ultimo_codigo_erro() == TRADUTOR_ERRO_FORMATO, "binário com 0xff no fim foi aceito");
+
+    // Cada byte trocado por alguns valores: ou a leitura falha com erro de formato, ou a máquina é consistente
+    static const unsigned char valores[] = { 0x00, 0x01, 0x7f, 0x80, 0xff };
+    for (size_t i = 0; i < tamanho; i++) {
+        for (size_t v = 0; v < sizeof(valores); v++) {
+            memcpy(corrompido, binario, tamanho);
+            if ((unsigned char) corrompido[i] == valores[v]) continue;
+            corrompido[i] = (char) valores[v];
+            MaquinaTuring* m = ler_maquina(corrompido, tamanho);
+            if (m) CONFERIR(maquina_consistente(m), "byte %zu = 0x%02x gerou uma máquina inconsistente", i, valores[v]);
+            else CONFERIR(ultimo_codigo_erro() == TRADUTOR_ERRO_FORMATO, "byte %zu = 0x%02x: erro %d", i, valores[v],
+                          (int) ultimo_codigo_erro());
+            liberar_maquina(m);
+        }
+    }
+    free(corrompido);
+    free(binario);
+    liberar_maquina(original);
+}
+
+// Os IDs dos nomes seguem a ordem de aparição na regra (estado, símbolo lido, símbolo escrito, próximo
+// estado), tanto na leitura do texto quanto em adicionar_transicao
+static void testar_ordem_dos_nomes(void) {
+    static const char texto[] = ";I\n0 _ 1 l 1\n";
+    MaquinaTuring* lida = ler_maquina(texto, sizeof(texto) - 1);
+    MaquinaTuring* construida = criar_maquina('I', 1);
+    if (construida) adicionar_transicao(construida, "0", "_", "1", 'l', "1");
+    const MaquinaTuring* maquinas[2] = { lida, construida };
+    for (int m = 0; m < 2; m++) {
+        const MaquinaTuring* maquina = maquinas[m];
+        CONFERIR(maquina && maquina->erro == TRADUTOR_OK && maquina->simbolos.numNomes == 2 &&
+                 strcmp(nome_simbolo(maquina, 0), "_") == 0 && strcmp(nome_simbolo(maquina, 1), "1") == 0 &&
+                 strcmp(nome_estado(maquina, 0), "0") == 0 && strcmp(nome_estado(maquina, 1), "1") == 0,
+                 "%s: os IDs não seguem a ordem de aparição", m == 0 ? "ler_maquina" : "adicionar_transicao");
+    }
+    liberar_maquina(lida);
+    liberar_maquina(construida);
+}
+
+// A tradução em várias threads tem que ser idêntica à tradução numa thread só
+static void testar_paralela(void) {
+    const char tipos[2] = { 'S', 'I' };
+    for (int t = 0; t < 2; t++) {
+        MaquinaTuring* original = gerar(tipos[t], 25000, 4, 100000);
+        MaquinaTuring* sequencial = original ? traduzir_maquina(original, ESQUEMA_DESLOCAMENTO) : NULL;
+        MaquinaTuring* paralela = original ? traduzir_maquina_paralela(original, ESQUEMA_DESLOCAMENTO, 4) : NULL;
+        CONFERIR(sequencial && paralela && mesmas_maquinas(sequencial, paralela), "tradução %c com 4 threads difere da sequencial",
+                 tipos[t]);
+        liberar_maquina(sequencial);
+        liberar_maquina(paralela);
+        liberar_maquina(original);
+    }
+}
+
+static char* ler_arquivo(const char* nome, size_t* tamanho) {
+    FILE* f = fopen(nome, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* dados = (char*) malloc((size_t) n + 1);
+    *tamanho = fread(dados, 1, (size_t) n, f);
+    fclose(f);
+    return dados;
+}
+
+static int arquivo_igual_a(const char* nome, const MaquinaTuring* maquina) {
+    size_t tamanhoArquivo = 0, tamanhoTexto = 0;
+    char* arquivo = ler_arquivo(nome, &tamanhoArquivo);
+    char* texto = texto_da_maquina(maquina, &tamanhoTexto);
+    int iguais = arquivo && texto && tamanhoArquivo == tamanhoTexto && memcmp(arquivo, texto, tamanhoTexto) == 0;
+    free(arquivo);
+    free(texto);
+    return iguais;
+}
+
+// Máquina de dois estados com nomes <prefixo>b e <prefixo>c; com um prefixo longo os estados derivados
+// só diferem depois de mais de mil caracteres
+static MaquinaTuring* maquina_com_prefixo(char tipo, const char* prefixo) {
+    char* texto = (char*) malloc(8 * strlen(prefixo) + 128);
+    sprintf(texto, ";%c\n0 0 1 r %sb\n%sb 1 1 r %sb\n%sb _ x l %sc\n%sc * y l %sb\n%sc _ z * halt\n", tipo,
+            prefixo, prefixo, prefixo, prefixo, prefixo, prefixo, prefixo, prefixo);
+    MaquinaTuring* maquina = ler_maquina(texto, strlen(texto));
+    free(texto);
+    return maquina;
+}
+
+// Nomes longos não podem ser cortados: a tradução tem que ter tantos estados quanto a da máquina de nomes curtos,
+// e a saída incremental tem que ser a da tradução completa
+static void testar_nomes_longos(const char* diretorio) {
+    char prefixo[1101];
+    memset(prefixo, 'a', 1100);
+    prefixo[1100] = '\0';
+    const char tipos[2] = { 'S', 'I' };
+    const EsquemaIparaS esquemas[3] = { ESQUEMA_DESLOCAMENTO, ESQUEMA_DOBRADO, ESQUEMA_COMPARTILHADO };
+    for (int t = 0; t < 2; t++) {
+        for (int e = 0; e < (tipos[t] == 'I' ? 3 : 1); e++) {
+            MaquinaTuring* curta = maquina_com_prefixo(tipos[t], "");
+            MaquinaTuring* longa = maquina_com_prefixo(tipos[t], prefixo);
+            MaquinaTuring* traducaoCurta = curta ? traduzir_maquina(curta, esquemas[e]) : NULL;
+            MaquinaTuring* traducaoLonga = longa ? traduzir_maquina(longa, esquemas[e]) : NULL;
+            CONFERIR(traducaoCurta && traducaoLonga && traducaoCurta->estados.numNomes == traducaoLonga->estados.numNomes &&
+                     traducaoCurta->numTransicoes == traducaoLonga->numTransicoes,
+                     "tradução %c (esquema %d) com nomes longos perdeu estados", tipos[t], (int) esquemas[e]);
+            liberar_maquina(traducaoCurta);
+            liberar_maquina(traducaoLonga);
+            liberar_maquina(curta);
+            liberar_maquina(longa);
+        }
+    }
+
+    char saida[512], manifesto[600];
+    snprintf(saida, sizeof(saida), "%s/nomes_longos.out", diretorio);
+    snprintf(manifesto, sizeof(manifesto), "%s.manifesto", saida);
+    MaquinaTuring* longa = maquina_com_prefixo('I', prefixo);
+    MaquinaTuring* completa = longa ? traduzir_maquina(longa, ESQUEMA_DESLOCAMENTO) : NULL;
+    EstatisticasIncremental estatisticas;
+    memset(&estatisticas, 0, sizeof(estatisticas));
+    CONFERIR(completa && traduzir_I_para_S_incremental(longa, saida, &estatisticas) == 0 && arquivo_igual_a(saida, completa),
+             "saída incremental com nomes longos difere da completa");
+    liberar_maquina(completa);
+    liberar_maquina(longa);
+    unlink(saida);
+    unlink(manifesto);
+}
+
+// A saída incremental tem que ser a da tradução completa, antes e depois de a máquina mudar
+static void testar_incremental(const char* diretorio) {
+    char saida[512], manifesto[600];
+    snprintf(saida, sizeof(saida), "%s/incremental.out", diretorio);
+    snprintf(manifesto, sizeof(manifesto), "%s.manifesto", saida);
+
+    // As duas versões são lidas do texto, como o modo incremental as recebe: a ordem dos símbolos (e portanto
+    // o alfabeto do manifesto) é a da primeira aparição no arquivo
+    MaquinaTuring* gerada = gerar('I', 500, 3, 1500);
+    size_t tamanho = 0;
+    char* texto = texto_da_maquina(gerada, &tamanho);
+    liberar_maquina(gerada);
+    MaquinaTuring* original = texto ? ler_maquina(texto, tamanho) : NULL;
+    MaquinaTuring* completa = original ? traduzir_maquina(original, ESQUEMA_DESLOCAMENTO) : NULL;
+    EstatisticasIncremental estatisticas;
+    memset(&estatisticas, 0, sizeof(estatisticas));
+    CONFERIR(completa && traduzir_I_para_S_incremental(original, saida, &estatisticas) == 0, "primeira tradução incremental: %s",
+             ultimo_erro());
+    CONFERIR(estatisticas.completa && arquivo_igual_a(saida, completa), "primeira saída incremental difere da completa");
+    liberar_maquina(completa);
+
+    // Mesma máquina com um estado novo no fim: só o bloco dele precisa ser gerado
+    static const char linhaExtra[] = "extra _ 1 l 0\n";
+    char* textoAlterado = texto ? (char*) realloc(texto, tamanho + sizeof(linhaExtra)) : NULL;
+    if (textoAlterado) memcpy(textoAlterado + tamanho, linhaExtra, sizeof(linhaExtra));
+    else free(texto);
+    MaquinaTuring* alterada = textoAlterado ? ler_maquina(textoAlterado, tamanho + sizeof(linhaExtra) - 1) : NULL;
+    free(textoAlterado);
+    completa = alterada ? traduzir_maquina(alterada, ESQUEMA_DESLOCAMENTO) : NULL;
+    memset(&estatisticas, 0, sizeof(estatisticas));
+    CONFERIR(completa && traduzir_I_para_S_incremental(alterada, saida, &estatisticas) == 0, "segunda tradução incremental: %s",
+             ultimo_erro());
+    CONFERIR(!estatisticas.completa && estatisticas.blocosGerados == 1 && estatisticas.blocosReaproveitados > 0,
+             "segunda tradução incremental: %d gerados, %d reaproveitados", estatisticas.blocosGerados,
+             estatisticas.blocosReaproveitados);
+    CONFERIR(arquivo_igual_a(saida, completa), "segunda saída incremental difere da completa");
+
+    liberar_maquina(completa);
+    liberar_maquina(alterada);
+    liberar_maquina(original);
+    unlink(saida);
+    unlink(manifesto);
+}
+
+// Executa a máquina sobre 'palavra' e escreve em 'estado' o nome do estado final; retorna o motivo da parada
+static MotivoFim executar_palavra(const MaquinaTuring* maquina, const char* palavra, char* estado, size_t tamanho) {
+    ProgramaCompilado* programa = compilar_maquina(maquina, palavra, "0");
+    Fita fita = { NULL, 0, 0, 0 };
+    MotivoFim motivo = MOTIVO_SEM_MEMORIA;
+    estado[0] = '\0';
+    if (programa && fita_iniciar(&fita, programa, palavra) == 0) {
+        ResultadoExecucao resultado = executar_programa(programa, &fita, 100000);
+        snprintf(estado, tamanho, "%s", nome_estado(maquina, resultado.estadoFinal));
+        motivo = resultado.motivo;
+    }
+    fita_liberar(&fita);
+    liberar_programa(programa);
+    return motivo;
+}
+
+// Conteúdo da fita como texto, alocado com malloc
+static char* texto_da_fita(const Fita* fita, const ProgramaCompilado* programa) {
+    char* texto = NULL;
+    size_t tamanho = 0;
+    FILE* memoria = open_memstream(&texto, &tamanho);
+    if (!memoria) return NULL;
+    fita_escrever(fita, programa, memoria);
+    fclose(memoria);
+    return texto;
+}
+
+// Os macropassos param no mesmo estado, com os mesmos passos e a mesma fita da execução passo a passo,
+// inclusive quando o limite de passos cai no meio de uma varredura
+static void testar_macropassos(void) {
+    static const char texto[] = ";I\n0 _ 1 l 1\n1 _ 0 l 0\n";
+    MaquinaTuring* original = ler_maquina(texto, sizeof(texto) - 1);
+    MaquinaTuring* traduzida = original ? traduzir_maquina(original, ESQUEMA_DESLOCAMENTO) : NULL;
+    ProgramaCompilado* simples = traduzida ? compilar_maquina(traduzida, "", "0") : NULL;
+    ProgramaCompilado* acelerado = traduzida ? compilar_maquina(traduzida, "", "0") : NULL;
+    CONFERIR(acelerado && acelerar_programa(acelerado) > 0, "acelerar_programa não marcou nenhuma entrada");
+    if (!simples || !acelerado) {
+        liberar_programa(simples);
+        liberar_programa(acelerado);
+        liberar_maquina(traduzida);
+        liberar_maquina(original);
+        return;
+    }
+    static const uint64_t limites[] = { 1, 17, 1000, 12345, 777777, 3000000 };
+    for (size_t i = 0; i < sizeof(limites) / sizeof(limites[0]); i++) {
+        Fita fitaSimples = { NULL, 0, 0, 0 }, fitaAcelerada = { NULL, 0, 0, 0 };
+        fita_iniciar(&fitaSimples, simples, "");
+        fita_iniciar(&fitaAcelerada, acelerado, "");
+        ResultadoExecucao a = executar_programa(simples, &fitaSimples, limites[i]);
+        ResultadoExecucao b = executar_programa(acelerado, &fitaAcelerada, limites[i]);
+        char* textoSimples = texto_da_fita(&fitaSimples, simples);
+        char* textoAcelerado = texto_da_fita(&fitaAcelerada, acelerado);
+        CONFERIR(a.estadoFinal == b.estadoFinal && a.passos == b.passos && a.motivo == b.motivo &&
+                 fitaSimples.cabeca - fitaSimples.origem == fitaAcelerada.cabeca - fitaAcelerada.origem &&
+                 textoSimples && textoAcelerado && strcmp(textoSimples, textoAcelerado) == 0,
+                 "macropassos com limite %llu: estado %u/%u, passos %llu/%llu", (unsigned long long) limites[i],
+                 a.estadoFinal, b.estadoFinal, (unsigned long long) a.passos, (unsigned long long) b.passos);
+        free(textoSimples);
+        free(textoAcelerado);
+        fita_liberar(&fitaSimples);
+        fita_liberar(&fitaAcelerada);
+    }
+    liberar_programa(simples);
+    liberar_programa(acelerado);
+    liberar_maquina(traduzida);
+    liberar_maquina(original);
+}
+
+// Estados com linhas iguais não podem ser fundidos se uma execução pode parar neles sem regra:
+// o nome do estado final muda
+static void testar_minimizacao(void) {
+    static const char texto[] = ";I\n0 0 0 r a\n0 1 1 r b\na 0 0 r a\nb 0 0 r b\n";
+    MaquinaTuring* original = ler_maquina(texto, sizeof(texto) - 1);
+    MaquinaTuring* traduzida = original ? traduzir_maquina(original, ESQUEMA_DESLOCAMENTO) : NULL;
+    EstatisticasMinimizacao estatisticas;
+    MaquinaTuring* minimizada = traduzida ? minimizar_maquina(traduzida, &estatisticas) : NULL;
+    CONFERIR(minimizada != NULL, "minimizar: %s", ultimo_erro());
+    if (minimizada) {
+        char antes[64], depois[64];
+        MotivoFim motivoAntes = executar_palavra(traduzida, "1", antes, sizeof(antes));
+        MotivoFim motivoDepois = executar_palavra(minimizada, "1", depois, sizeof(depois));
+        CONFERIR(motivoAntes == MOTIVO_SEM_REGRA && motivoDepois == MOTIVO_SEM_REGRA && strcmp(antes, depois) == 0,
+                 "a minimização mudou o estado final de '%s' (%d) para '%s' (%d)", antes, (int) motivoAntes, depois, (int) motivoDepois);
+    }
+    liberar_maquina(minimizada);
+    liberar_maquina(traduzida);
+    liberar_maquina(original);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Uso: %s <maquina_de_exemplo.in> <diretorio_temporario>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    testar_binario(argv[1]);
+    testar_ordem_dos_nomes();
+    testar_paralela();
+    testar_nomes_longos(argv[2]);
+    testar_incremental(argv[2]);
+    testar_macropassos();
+    testar_minimizacao();
+
+    if (falhas) {
+        fprintf(stderr, "%d verificações falharam.\n", falhas);
+        return EXIT_FAILURE;
+    }
+    printf("-> Testes da biblioteca concluídos sem falhas.\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+#!/bin/sh
+# Testes de regressão da linha de comando. Uso: testar_cli.sh <tradutor> <maquina_de_exemplo.in> <diretorio_temporario>
+TRADUTOR=$1
+EXEMPLO=$2
+DIR=$3
+falhas=0
+
+falhou() {
+    echo "FALHOU: $*" >&2
+    falhas=$((falhas + 1))
+}
+
+# Tradução e verificação da máquina de exemplo
+"$TRADUTOR" --quiet "$EXEMPLO" "$DIR/exemplo.out" || falhou "tradução de $EXEMPLO"
+"$TRADUTOR" verify -r 1000 "$EXEMPLO" "$DIR/exemplo.out" >/dev/null 2>&1 || falhou "verify de $EXEMPLO"
+
+# As construções I -> S concordam com a original (a fita dobrada é lida como pares com verify -d),
+# e a compartilhada só usa símbolos de um caractere
+"$TRADUTOR" generate -t I -e 300 -a 4 -n 1200 -s 5 "$DIR/i.in" 2>/dev/null || falhou "generate"
+for esquema in "" -d -c; do
+    dobrada=
+    [ "$esquema" = -d ] && dobrada=-d
+    "$TRADUTOR" --quiet $esquema "$DIR/i.in" "$DIR/i$esquema.out" || falhou "tradução I -> S $esquema"
+    "$TRADUTOR" verify $dobrada -n 6 -r 500 "$DIR/i.in" "$DIR/i$esquema.out" >/dev/null 2>&1 || falhou "verify da tradução I -> S $esquema"
+done
+awk 'NR > 1 && (length($2) != 1 || length($3) != 1) { exit 1 }' "$DIR/i-c.out" || falhou "-c gerou símbolos de mais de um caractere"
+
+# Simulador: o resultado de uma máquina conhecida, e o mesmo resultado com macropassos
+printf ';I\n0 0 1 r 0\n0 1 0 r 0\n0 _ _ * halt\n' > "$DIR/inverte.in"
+"$TRADUTOR" run "$DIR/inverte.in" 0110 > "$DIR/inverte.txt" 2>/dev/null
+printf 'Estado final: halt\nMotivo:       parada\nPassos:       5\nFita:         1001\n' | cmp -s - "$DIR/inverte.txt" ||
+    falhou "run da máquina que inverte os bits"
+# -p vezes -F acima de 64 bits não pode virar um limite pequeno para a traduzida
+"$TRADUTOR" --quiet "$DIR/inverte.in" "$DIR/inverte.out" || falhou "tradução da máquina que inverte os bits"
+"$TRADUTOR" verify -n 5 -r 0 -p 1152921504606846977 -F 16 "$DIR/inverte.in" "$DIR/inverte.out" >/dev/null 2>&1 ||
+    falhou "verify com -p vezes -F acima de 64 bits"
+for palavra in "" 0 12 2010; do
+    "$TRADUTOR" run "$DIR/i.out" "$palavra" > "$DIR/passos.txt" 2>/dev/null
+    "$TRADUTOR" run -m "$DIR/i.out" "$palavra" > "$DIR/macropassos.txt" 2>/dev/null
+    cmp -s "$DIR/passos.txt" "$DIR/macropassos.txt" || falhou "run -m diverge de run na palavra \"$palavra\""
+done
+
+# Perfil: as pilhas do -F somam os passos da traduzida, e os passos de origem "original" são os do run da original
+conferir_perfil() {  # <maquina> <palavra> [opções do profile]
+    maquina=$1
+    palavra=$2
+    shift 2
+    "$TRADUTOR" profile "$@" -F "$DIR/perfil.folded" "$maquina" "$palavra" > "$DIR/perfil.txt" 2>/dev/null ||
+        falhou "profile $* de $maquina"
+    passos=$(sed -n 's/^Passos: *//p' "$DIR/perfil.txt")
+    [ -n "$passos" ] && [ "$(awk '{ soma += $NF } END { print soma }' "$DIR/perfil.folded")" = "$passos" ] ||
+        falhou "profile $* de $maquina: as pilhas do -F não somam os passos"
+    passos=$("$TRADUTOR" run "$maquina" "$palavra" 2>/dev/null | sed -n 's/^Passos: *//p')
+    [ -n "$passos" ] && [ "$(awk '$1 == "original" { print $2 }' "$DIR/perfil.txt")" = "$passos" ] ||
+        falhou "profile $* de $maquina: os passos da original diferem do run"
+}
+conferir_perfil "$EXEMPLO" 0101
+conferir_perfil "$DIR/inverte.in" 0110 -d
+
+# O otimizador remove regras e o minimizador funde estados sem mudar o comportamento
+"$TRADUTOR" --quiet -O "$DIR/i.in" "$DIR/i-O.out" || falhou "tradução I -> S -O"
+[ "$(wc -l < "$DIR/i-O.out")" -lt "$(wc -l < "$DIR/i.out")" ] || falhou "-O não removeu regras"
+"$TRADUTOR" verify -n 5 -r 200 "$DIR/i.in" "$DIR/i-O.out" >/dev/null 2>&1 || falhou "verify da tradução I -> S -O"
+"$TRADUTOR" --quiet -c -M "$DIR/i.in" "$DIR/i-cM.out" || falhou "tradução I -> S -c -M"
+estados() { awk 'NR > 1 { print $1 }' "$1" | sort -u | wc -l; }
+[ "$(estados "$DIR/i-cM.out")" -lt "$(estados "$DIR/i-c.out")" ] || falhou "-M não fundiu estados"
+"$TRADUTOR" verify -n 5 -r 200 "$DIR/i.in" "$DIR/i-cM.out" >/dev/null 2>&1 || falhou "verify da tradução I -> S -c -M"
+
+# O programa C gerado e o batch-run dão o mesmo resultado que o run
+printf '0011\n\n1\n10\n' > "$DIR/palavras.txt"
+: > "$DIR/run.txt"
+: > "$DIR/run_tabela.txt"
+while IFS= read -r palavra; do
+    [ -s "$DIR/run.txt" ] && echo >> "$DIR/run.txt"
+    "$TRADUTOR" run "$DIR/exemplo.out" "$palavra" 2>/dev/null | tee -a "$DIR/run.txt" | sed 's/^[^:]*: *//' | paste -s - >> "$DIR/run_tabela.txt"
+done < "$DIR/palavras.txt"
+"$TRADUTOR" compile "$DIR/exemplo.out" "$DIR/exemplo.c" >/dev/null 2>&1 && ${CC:-cc} -O2 "$DIR/exemplo.c" -o "$DIR/exemplo_c" ||
+    falhou "compile de $EXEMPLO"
+"$DIR/exemplo_c" 0011 "" 1 10 2>/dev/null | cmp -s - "$DIR/run.txt" || falhou "o programa C gerado diverge do run"
+"$TRADUTOR" batch-run -o "$DIR/lote.txt" "$DIR/exemplo.out" "$DIR/palavras.txt" >/dev/null 2>&1 || falhou "batch-run"
+cmp -s "$DIR/lote.txt" "$DIR/run_tabela.txt" || falhou "batch-run diverge do run"
+
+# -j 1 e -j 4 geram a mesma saída
+"$TRADUTOR" generate -t S -s 3 "$DIR/s.in" 2>/dev/null || falhou "generate"
+"$TRADUTOR" --quiet -j 1 "$DIR/s.in" "$DIR/s1.out" && "$TRADUTOR" --quiet -j 4 "$DIR/s.in" "$DIR/s4.out" &&
+    cmp -s "$DIR/s1.out" "$DIR/s4.out" || falhou "-j 1 e -j 4 geraram saídas diferentes"
+
+# Lote com -j 3 e -o: cada saída é igual à tradução de arquivo único, e uma entrada inválida só gera uma
+# linha no resumo de falhas e um código de saída diferente de zero, sem parar as outras
+rm -rf "$DIR/lote" "$DIR/lote_saida"
+mkdir -p "$DIR/lote" "$DIR/lote_saida"
+cp "$EXEMPLO" "$DIR/lote/a.in"
+cp "$DIR/s.in" "$DIR/lote/b.in"
+cp "$DIR/i.in" "$DIR/lote/c.in"
+printf ';X\n0 0 0 r 0\n' > "$DIR/lote/invalida.in"
+if "$TRADUTOR" batch -j 3 -o "$DIR/lote_saida" "$DIR/lote" > "$DIR/lote.txt" 2>&1; then falhou "batch com uma entrada inválida terminou com sucesso"; fi
+grep -q "^  $DIR/lote/invalida.in: " "$DIR/lote.txt" || falhou "batch não listou a entrada inválida no resumo de falhas"
+grep -q ': 3 traduzidos, 1 com falha' "$DIR/lote.txt" || falhou "batch não traduziu as entradas válidas"
+for nome in a b c; do
+    "$TRADUTOR" --quiet "$DIR/lote/$nome.in" "$DIR/unico.out" && cmp -s "$DIR/unico.out" "$DIR/lote_saida/$nome.out" ||
+        falhou "batch: $nome.out difere da tradução de arquivo único"
+done
+
+# Uma tradução impossível termina com erro e sem saída
+"$TRADUTOR" generate -t I -e 10 -a 8 -n 40 "$DIR/a8.in" 2>/dev/null || falhou "generate"
+rm -f "$DIR/a8.out"
+if "$TRADUTOR" --quiet -d "$DIR/a8.in" "$DIR/a8.out" 2>/dev/null; then falhou "-d num alfabeto de 8 símbolos terminou com sucesso"; fi
+[ ! -e "$DIR/a8.out" ] || falhou "-d num alfabeto de 8 símbolos deixou uma saída"
+
+# --quiet --stats=json imprime só uma linha JSON com as chaves documentadas, e null nos campos da
+# traduzida quando a tradução falha
+chaves='"versao": "entrada": "saida": "tipo_original": "tipo_traduzido": "threads": "transicoes_original": "transicoes_traduzida": "etapas":'
+for etapa in leitura coleta_estados fase1 fase2 escrita; do chaves="$chaves \"$etapa\": \"real_s\": \"cpu_s\":"; done
+chaves="$chaves"' "alocacoes": "quantidade": "bytes": "crescimentos_transicoes":'
+chaves="$chaves"' "regras": "preparacao": "copiadas": "mola": "deslocamento": "extensao":'
+"$TRADUTOR" --quiet --stats=json "$EXEMPLO" "$DIR/json.out" > "$DIR/json.txt" 2>/dev/null || falhou "tradução com --stats=json"
+[ "$(wc -l < "$DIR/json.txt")" -eq 1 ] || falhou "--quiet --stats=json não imprimiu uma única linha"
+[ "$(grep -o '"[a-z_0-9]*":' "$DIR/json.txt" | paste -sd ' ' -)" = "$chaves" ] ||
+    falhou "--stats=json não tem as chaves documentadas"
+grep -q '^{"versao":1,.*"tipo_traduzido":"I",.*"transicoes_traduzida":[0-9]' "$DIR/json.txt" || falhou "--stats=json sem os campos da traduzida"
+if "$TRADUTOR" --quiet -d --stats=json "$DIR/a8.in" "$DIR/a8.out" > "$DIR/json.txt" 2>/dev/null; then
+    falhou "-d num alfabeto de 8 símbolos terminou com sucesso com --stats=json"
+fi
+[ "$(wc -l < "$DIR/json.txt")" -eq 1 ] && grep -q '"tipo_traduzido":null,.*"transicoes_traduzida":null,' "$DIR/json.txt" ||
+    falhou "--stats=json de uma tradução que falhou não tem null nos campos da traduzida"
+
+# A tradução em fluxo não deixa saída truncada
+printf ';S\n0 0 1 r 0\n0 1 0 l 1\n1 # # r 0\n' > "$DIR/barreira.in"
+rm -f "$DIR/barreira.out"
+if "$TRADUTOR" stream "$DIR/barreira.in" "$DIR/barreira.out" 2>/dev/null; then falhou "stream aceitou o símbolo '#'"; fi
+[ ! -e "$DIR/barreira.out" ] && [ ! -e "$DIR/barreira.out.tmp" ] || falhou "stream deixou uma saída truncada"
+
+# Numa máquina ;S sem '#', o fluxo grava o mesmo que a tradução completa, também lendo da entrada padrão
+for maquina in "$EXEMPLO" "$DIR/s.in"; do
+    "$TRADUTOR" --quiet "$maquina" "$DIR/completa.out" || falhou "tradução de $maquina"
+    "$TRADUTOR" stream "$maquina" "$DIR/fluxo.out" 2>/dev/null && cmp -s "$DIR/fluxo.out" "$DIR/completa.out" ||
+        falhou "stream de $maquina difere da tradução completa"
+    "$TRADUTOR" stream - - < "$maquina" 2>/dev/null | cmp -s - "$DIR/completa.out" ||
+        falhou "stream da entrada padrão de $maquina difere da tradução completa"
+done
+
+# Binário corrompido: erro de formato no run e uma resposta ERRO no serve, sem derrubar o servidor
+"$TRADUTOR" convert "$EXEMPLO" "$DIR/ok.mtb" >/dev/null 2>&1 || falhou "convert"
+cp "$DIR/ok.mtb" "$DIR/ruim.mtb"
+tamanho=$(wc -c < "$DIR/ruim.mtb")
+printf '\377\377\377\377\377\377\377\377\377\377\377\377' | dd of="$DIR/ruim.mtb" bs=1 seek=$((tamanho - 12)) conv=notrunc 2>/dev/null
+"$TRADUTOR" run "$DIR/ruim.mtb" 01 >/dev/null 2>&1
+[ $? -eq 1 ] || falhou "run de um binário corrompido não terminou com erro 1"
+respostas=$(printf 'run %s 01\nrun %s 01\n' "$DIR/ruim.mtb" "$DIR/ok.mtb" | "$TRADUTOR" serve 2>/dev/null) || falhou "serve terminou com erro"
+echo "$respostas" | head -n 1 | grep -q '^ERRO' || falhou "serve não recusou o binário corrompido"
+echo "$respostas" | sed -n 2p | grep -q '^OK' || falhou "serve não atendeu o pedido seguinte"
+
+# Um pedido que não cabe na memória ou que passa dos limites do servidor só gera uma resposta ERRO
+# (a "traduzida" infinita anda para a direita até a fita não caber no limite de memória)
+printf ';I\n0 * * r 0\n' > "$DIR/infinita.in"
+printf ';I\n0 * * * halt\n' > "$DIR/para.in"
+respostas=$( (ulimit -v 300000
+              { printf 'verify -n 0 -r 0 -a 0 -p 1000000 -F 1000 %s %s\n' "$DIR/para.in" "$DIR/infinita.in"
+                printf 'verify -n 0 -r 3 -L 60000000 %s %s\n' "$EXEMPLO" "$DIR/exemplo.out"
+                printf 'verify -r 1000000000000 %s %s\n' "$EXEMPLO" "$DIR/exemplo.out"
+                printf 'verify -p 100000000000 %s %s\n' "$EXEMPLO" "$DIR/exemplo.out"
+                printf 'verify -F 100000000 %s %s\n' "$EXEMPLO" "$DIR/exemplo.out"
+                printf 'run -p 100000000000000 %s\n' "$DIR/infinita.in"
+                printf 'stats\n'; } | "$TRADUTOR" serve 2>/dev/null)) ||
+    falhou "serve terminou com erro num pedido recusado"
+echo "$respostas" | head -n 1 | grep -q '^ERRO' || falhou "serve não recusou o verify sem memória"
+echo "$respostas" | sed -n 2p | grep -q '^ERRO' || falhou "serve aceitou -L acima do limite"
+echo "$respostas" | sed -n 3p | grep -q '^ERRO' || falhou "serve aceitou -r acima do limite"
+echo "$respostas" | sed -n 4p | grep -q '^ERRO' || falhou "serve aceitou -p de verify acima do limite"
+echo "$respostas" | sed -n 5p | grep -q '^ERRO' || falhou "serve aceitou -F acima do limite"
+echo "$respostas" | sed -n 6p | grep -q '^ERRO' || falhou "serve aceitou -p de run acima do limite"
+echo "$respostas" | sed -n 7p | grep -q '^OK' || falhou "serve não atendeu o pedido depois dos pedidos recusados"
+
+# Cache do servidor: o segundo translate da mesma entrada sai do cache, com a saída da tradução direta;
+# com -m 0 nada cabe no cache, então a repetição retraduz e as entradas são despejadas
+traduzir_duas_vezes() {
+    printf 'translate %s %s\ntranslate %s %s\nstats\n' "$EXEMPLO" "$DIR/cache1.out" "$EXEMPLO" "$DIR/cache2.out" |
+        "$TRADUTOR" serve "$@" 2>/dev/null
+}
+respostas=$(traduzir_duas_vezes) || falhou "serve terminou com erro"
+echo "$respostas" | head -n 1 | grep -q '^OK .* cache=0$' || falhou "serve: o primeiro translate não foi uma falta"
+echo "$respostas" | sed -n 2p | grep -q '^OK .* cache=1$' || falhou "serve: a repetição do translate não saiu do cache"
+cmp -s "$DIR/cache1.out" "$DIR/exemplo.out" && cmp -s "$DIR/cache2.out" "$DIR/exemplo.out" ||
+    falhou "serve: a saída do translate difere da tradução direta"
+respostas=$(traduzir_duas_vezes -m 0) || falhou "serve -m 0 terminou com erro"
+echo "$respostas" | sed -n 2p | grep -q '^OK .* cache=0$' || falhou "serve -m 0: a repetição saiu do cache"
+echo "$respostas" | sed -n 3p | grep -q ' despejos=[1-9]' || falhou "serve -m 0: nenhuma entrada foi despejada"
+cmp -s "$DIR/cache2.out" "$DIR/exemplo.out" || falhou "serve -m 0: a saída do translate difere da tradução direta"
+
+if [ $falhas -ne 0 ]; then
+    echo "$falhas verificações falharam." >&2
+    exit 1
+fi
+echo "-> Testes da linha de comando concluídos sem falhas."
@@ -1,5 +1,6 @@
+// Tradutor de Máquinas de Turing: interface de linha de comando sobre a biblioteca (tradutor.h)
 // Para compilar:
-// gcc tradutor.c -o tradutor
+// gcc tradutor.c libtradutor.c -o tradutor -pthread
 // Para executar:
 // ./tradutor entrada_exemplo.in saida_exemplo.out
 
@@ -7,604 +8,2098 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <glob.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <stdarg.h>
+
+#include "tradutor.h"
+
+// Construção da tradução I -> S escolhida na linha de comando (-d / -c)
+static EsquemaIparaS esquemaIparaS = ESQUEMA_DESLOCAMENTO;
+
+// --quiet: o modo de arquivo único não imprime as mensagens de progresso
+static int silencioso = 0;
+
+static void informar(const char* formato, ...) {
+    if (silencioso) return;
+    va_list args;
+    va_start(args, formato);
+    vprintf(formato, args);
+    va_end(args);
+}
+
+
+// === Modo em lote ===
+// Traduz vários arquivos em um pool fixo de threads. Cada thread tem o seu buffer de saída, e cada
+// máquina tem a sua própria arena, então as threads não disputam nenhuma estrutura de alocação.
 
-// <estadoAtual> <simboloAtual> <novoSimbolo> <direcao> <novoEstado>
-typedef struct {
-    char* estadoAtual;
-    char* simboloAtual;
-    char* novoSimbolo;
-    char direcao;
-    char* novoEstado;
-} Transicao;
-
-// Maquina de Turing completa, lida de um arquivo
 typedef struct {
-    Transicao* transicoes;
-    int numTransicoes;
-    int capacidadeTransicoes;
-    char tipo;  // 'S' para sipser, 'I' para duplamente_infinita
-} MaquinaTuring;
+    char* entrada;
+    char* saida;
+    int falhou;
+    char erro[512];
+} TarefaLote;
 
+typedef struct {
+    TarefaLote* tarefas;
+    int numTarefas;
+    int capacidadeTarefas;
+    atomic_int proximaTarefa;
+    int saidaBinaria;
+    int otimizar;
+    int minimizar;
+} Lote;
+
+static void lote_adicionar(Lote* lote, const char* entrada, const char* saida) {
+    if (lote->numTarefas >= lote->capacidadeTarefas) {
+        lote->capacidadeTarefas = lote->capacidadeTarefas ? lote->capacidadeTarefas * 2 : 64;
+        lote->tarefas = (TarefaLote*) realloc(lote->tarefas, lote->capacidadeTarefas * sizeof(TarefaLote));
+        if (!lote->tarefas) {
+            fprintf(stderr, "ERRO: Falha na alocação de memória para a lista de arquivos.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    TarefaLote* tarefa = &lote->tarefas[lote->numTarefas++];
+    tarefa->entrada = strdup(entrada);
+    tarefa->saida = strdup(saida);
+    tarefa->falhou = 0;
+    tarefa->erro[0] = '\0';
+}
 
-MaquinaTuring* carregar_maquina(const char* nomeArquivo);
-MaquinaTuring* traduzir_maquina(const MaquinaTuring* maquinaOriginal);
-MaquinaTuring* traduzir_S_para_I(const MaquinaTuring* maquinaOriginal);
-MaquinaTuring* traduzir_I_para_S(const MaquinaTuring* maquinaOriginal);
-void adicionar_transicao(MaquinaTuring* maquina, const char* estA, const char* simA, const char* simN, char dir, const char* estN);
-void salvar_maquina(const MaquinaTuring* maquina, const char* nomeArquivo);
-void liberar_maquina(MaquinaTuring* maquina);
+// "<dirSaida ou dir da entrada>/<nome sem .in>.out" (ou .mtb para saída binária)
+static void lote_adicionar_entrada(Lote* lote, const char* entrada, const char* dirSaida) {
+    const char* barra = strrchr(entrada, '/');
+    const char* base = barra ? barra + 1 : entrada;
+    size_t tamanhoBase = strlen(base);
+    if (tamanhoBase > 3 && strcmp(base + tamanhoBase - 3, ".in") == 0) tamanhoBase -= 3;
+
+    char saida[4096];
+    const char* extensao = lote->saidaBinaria ? ".mtb" : ".out";
+    if (dirSaida) {
+        snprintf(saida, sizeof(saida), "%s/%.*s%s", dirSaida, (int) tamanhoBase, base, extensao);
+    } else {
+        snprintf(saida, sizeof(saida), "%.*s%s", (int) (base - entrada + tamanhoBase), entrada, extensao);
+    }
+    lote_adicionar(lote, entrada, saida);
+}
 
+static int comparar_nomes(const void* a, const void* b) {
+    return strcmp(*(const char* const*) a, *(const char* const*) b);
+}
 
+// Adiciona todos os arquivos '.in' de um diretório, em ordem alfabética
+static int lote_adicionar_diretorio(Lote* lote, const char* diretorio, const char* dirSaida) {
+    DIR* dir = opendir(diretorio);
+    if (!dir) {
+        fprintf(stderr, "ERRO: Não foi possível abrir o diretório '%s': %s\n", diretorio, strerror(errno));
+        return -1;
+    }
 
-MaquinaTuring* carregar_maquina(const char* nomeArquivo) {
-    FILE* arquivo = fopen(nomeArquivo, "r");
-    if (!arquivo) {
-        fprintf(stderr, "ERRO: Não foi possível abrir o arquivo '%s': %s\n", nomeArquivo, strerror(errno));
+    int num = 0, capacidade = 64;
+    char** nomes = (char**) malloc(capacidade * sizeof(char*));
+    struct dirent* item;
+    while (nomes && (item = readdir(dir)) != NULL) {
+        size_t tamanho = strlen(item->d_name);
+        if (tamanho <= 3 || strcmp(item->d_name + tamanho - 3, ".in") != 0) continue;
+        if (num >= capacidade) {
+            capacidade *= 2;
+            nomes = (char**) realloc(nomes, capacidade * sizeof(char*));
+            if (!nomes) break;
+        }
+        char caminho[4096];
+        snprintf(caminho, sizeof(caminho), "%s/%s", diretorio, item->d_name);
+        nomes[num++] = strdup(caminho);
+    }
+    closedir(dir);
+    if (!nomes) {
+        fprintf(stderr, "ERRO: Falha na alocação de memória para a lista de arquivos.\n");
         exit(EXIT_FAILURE);
     }
 
-    // Aloca a estrutura principal da máquina
-    MaquinaTuring* maquina = (MaquinaTuring*) malloc(sizeof(MaquinaTuring));
-    if (!maquina) {
-        fprintf(stderr, "ERRO: Falha na alocação de memória para a máquina.\n");
-        exit(EXIT_FAILURE);
+    qsort(nomes, num, sizeof(char*), comparar_nomes);
+    for (int i = 0; i < num; i++) {
+        lote_adicionar_entrada(lote, nomes[i], dirSaida);
+        free(nomes[i]);
     }
+    free(nomes);
+    return 0;
+}
+
+// Manifesto: uma tarefa por linha, "<entrada> <saida>"; linhas vazias e iniciadas por ';' ou '#' são ignoradas
+static int lote_adicionar_manifesto(Lote* lote, const char* nomeManifesto) {
+    FILE* manifesto = strcmp(nomeManifesto, "-") == 0 ? stdin : fopen(nomeManifesto, "r");
+    if (!manifesto) {
+        fprintf(stderr, "ERRO: Não foi possível abrir o manifesto '%s': %s\n", nomeManifesto, strerror(errno));
+        return -1;
+    }
+
+    char* linha = NULL;
+    size_t capacidadeLinha = 0;
+    ssize_t tamanho;
+    int numLinha = 0, resultado = 0;
+    while ((tamanho = getline(&linha, &capacidadeLinha, manifesto)) != -1) {
+        numLinha++;
+        const char* cursor = linha;
+        const char* fimLinha = linha + tamanho;
+        if (tamanho > 0 && linha[tamanho - 1] == '\n') fimLinha--;
+
+        const char* tokens[2];
+        size_t tamanhos[2];
+        int numTokens = 0;
+        while (numTokens < 2 && proximo_token(&cursor, fimLinha, &tokens[numTokens], &tamanhos[numTokens])) numTokens++;
+        if (numTokens == 0 || tokens[0][0] == ';' || tokens[0][0] == '#') continue;
+        if (numTokens < 2) {
+            fprintf(stderr, "ERRO: Linha %d do manifesto '%s' sem arquivo de saída.\n", numLinha, nomeManifesto);
+            resultado = -1;
+            continue;
+        }
 
-    maquina->numTransicoes = 0;
-    maquina->capacidadeTransicoes = 10; // Capacidade inicial
-    maquina->transicoes = (Transicao*) malloc(maquina->capacidadeTransicoes * sizeof(Transicao));
-    if (!maquina->transicoes) {
-        fprintf(stderr, "ERRO: Falha na alocação de memória para as transições.\n");
+        char entrada[4096], saida[4096];
+        snprintf(entrada, sizeof(entrada), "%.*s", (int) tamanhos[0], tokens[0]);
+        snprintf(saida, sizeof(saida), "%.*s", (int) tamanhos[1], tokens[1]);
+        lote_adicionar(lote, entrada, saida);
+    }
+
+    free(linha);
+    if (manifesto != stdin) fclose(manifesto);
+    return resultado;
+}
+
+// traduzir_maquina seguida das passadas opcionais de otimização e minimização
+static MaquinaTuring* traduzir_com_opcoes(const MaquinaTuring* original, EsquemaIparaS esquema, int otimizar, int minimizar) {
+    MaquinaTuring* traduzida = traduzir_maquina(original, esquema);
+    if (traduzida && otimizar) {
+        EstatisticasOtimizacao estatisticas;
+        MaquinaTuring* otimizada = otimizar_maquina(traduzida, &estatisticas);
+        liberar_maquina(traduzida);
+        traduzida = otimizada;
+    }
+    if (traduzida && minimizar) {
+        EstatisticasMinimizacao estatisticas;
+        MaquinaTuring* minimizada = minimizar_maquina(traduzida, &estatisticas);
+        liberar_maquina(traduzida);
+        traduzida = minimizada;
+    }
+    return traduzida;
+}
+
+// carregar_maquina -> traduzir_maquina -> salvar, sem abortar o processo em caso de erro
+static int executar_tarefa_lote(TarefaLote* tarefa, int saidaBinaria, int otimizar, int minimizar, char* buffer) {
+    MaquinaTuring* original = carregar_maquina(tarefa->entrada);
+    if (!original) return -1;
+
+    MaquinaTuring* traduzida = traduzir_com_opcoes(original, esquemaIparaS, otimizar, minimizar);
+    int resultado = -1;
+    if (traduzida) {
+        resultado = gravar_maquina(traduzida, tarefa->saida, saidaBinaria, buffer);
+        liberar_maquina(traduzida);
+    }
+
+    liberar_maquina(original);
+    return resultado;
+}
+
+static void* trabalhador_lote(void* argumento) {
+    Lote* lote = (Lote*) argumento;
+    char* buffer = (char*) malloc(TAMANHO_BUFFER_SAIDA); // reaproveitado por todos os arquivos desta thread
+    if (!buffer) {
+        fprintf(stderr, "ERRO: Falha na alocação de memória para o buffer de saída.\n");
         exit(EXIT_FAILURE);
     }
 
-    char linha[256]; // Buffer para ler cada linha do arquivo
+    for (;;) {
+        int i = atomic_fetch_add(&lote->proximaTarefa, 1);
+        if (i >= lote->numTarefas) break;
 
-    // 1. Ler a primeira linha para determinar o tipo da máquina
-    if (fgets(linha, sizeof(linha), arquivo)) {
-        if (linha[0] == ';' && (linha[1] == 'S' || linha[1] == 'I')) {
-            maquina->tipo = linha[1];
-        } else {
-            fprintf(stderr, "ERRO: Primeira linha do arquivo inválida. Esperado ';S' ou ';I'.\n");
-            exit(EXIT_FAILURE);
+        TarefaLote* tarefa = &lote->tarefas[i];
+        if (executar_tarefa_lote(tarefa, lote->saidaBinaria, lote->otimizar, lote->minimizar, buffer) != 0) {
+            tarefa->falhou = 1;
+            snprintf(tarefa->erro, sizeof(tarefa->erro), "%s", ultimo_erro());
         }
-    } else {
-        fprintf(stderr, "ERRO: Arquivo de entrada vazio ou corrompido.\n");
-        exit(EXIT_FAILURE);
     }
 
-    // 2. Ler as transições linha por linha
-    while (fgets(linha, sizeof(linha), arquivo)) {
-        // Ignorar linhas vazias ou de comentário
-        if (linha[0] == '\n' || linha[0] == ';') {
+    free(buffer);
+    return NULL;
+}
+
+static int numero_de_nucleos(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int) n : 1;
+}
+
+static double relogio_segundos(void) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return agora.tv_sec + agora.tv_nsec / 1e9;
+}
+
+// Modo "batch": tradutor batch [-j N] [-b] [-o dir_saida] [-m manifesto] [diretorio | padrao_glob | arquivo]...
+static int modo_lote(int argc, char* argv[]) {
+    Lote lote;
+    memset(&lote, 0, sizeof(lote));
+    int numThreads = numero_de_nucleos();
+    const char* dirSaida = NULL;
+    int errosDeArgumento = 0;
+
+    // Primeiro as opções, depois as entradas (que dependem de -o e -b para nomear as saídas)
+    int i = 2;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-b") == 0) lote.saidaBinaria = 1;
+        else if (strcmp(argv[i], "-O") == 0) lote.otimizar = 1;
+        else if (strcmp(argv[i], "-M") == 0) lote.minimizar = 1;
+        else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--dobrada") == 0) esquemaIparaS = ESQUEMA_DOBRADO;
+        else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--compartilhada") == 0) esquemaIparaS = ESQUEMA_COMPARTILHADO;
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) dirSaida = argv[++i];
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) errosDeArgumento |= lote_adicionar_manifesto(&lote, argv[++i]) != 0;
+        else {
+            fprintf(stderr, "ERRO: Opção desconhecida '%s'.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    for (; i < argc; i++) {
+        struct stat info;
+        if (stat(argv[i], &info) == 0 && S_ISDIR(info.st_mode)) {
+            errosDeArgumento |= lote_adicionar_diretorio(&lote, argv[i], dirSaida) != 0;
             continue;
         }
 
-        // Checar se o array de transições está cheio e precisa ser realocado
-        if (maquina->numTransicoes >= maquina->capacidadeTransicoes) {
-            maquina->capacidadeTransicoes *= 2; // Dobrar a capacidade
-            maquina->transicoes = (Transicao*) realloc(maquina->transicoes, maquina->capacidadeTransicoes * sizeof(Transicao));
-            if (!maquina->transicoes) {
-                fprintf(stderr, "ERRO: Falha na realocação de memória para as transições.\n");
-                exit(EXIT_FAILURE);
-            }
+        glob_t encontrados;
+        if (glob(argv[i], 0, NULL, &encontrados) != 0) {
+            fprintf(stderr, "ERRO: Nenhum arquivo corresponde a '%s'.\n", argv[i]);
+            errosDeArgumento = 1;
+            continue;
         }
-        
-        char* token;
-        
-        token = strtok(linha, " \t\n\r");
-        if (!token) continue; // Linha mal formatada
-        maquina->transicoes[maquina->numTransicoes].estadoAtual = strdup(token);
-
-        token = strtok(NULL, " \t\n\r");
-        if (!token) continue;
-        maquina->transicoes[maquina->numTransicoes].simboloAtual = strdup(token);
+        for (size_t k = 0; k < encontrados.gl_pathc; k++) {
+            lote_adicionar_entrada(&lote, encontrados.gl_pathv[k], dirSaida);
+        }
+        globfree(&encontrados);
+    }
 
-        token = strtok(NULL, " \t\n\r");
-        if (!token) continue;
-        maquina->transicoes[maquina->numTransicoes].novoSimbolo = strdup(token);
-        
-        token = strtok(NULL, " \t\n\r");
-        if (!token) continue;
-        maquina->transicoes[maquina->numTransicoes].direcao = token[0];
+    if (lote.numTarefas == 0) {
+        fprintf(stderr, "Uso: %s batch [-j threads] [-b] [-d|-c] [-O] [-M] [-o dir_saida] [-m manifesto] <diretorio|padrao|arquivo>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > lote.numTarefas) numThreads = lote.numTarefas;
 
-        token = strtok(NULL, " \t\n\r");
-        if (!token) continue;
-        maquina->transicoes[maquina->numTransicoes].novoEstado = strdup(token);
+    printf("-> Traduzindo %d arquivos com %d threads...\n", lote.numTarefas, numThreads);
+    fflush(stdout);
+    double inicio = relogio_segundos();
 
-        maquina->numTransicoes++;
+    pthread_t* threads = (pthread_t*) malloc(numThreads * sizeof(pthread_t));
+    if (!threads) {
+        fprintf(stderr, "ERRO: Falha na alocação de memória para as threads.\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&lote.proximaTarefa, 0);
+    for (int t = 0; t < numThreads; t++) {
+        if (pthread_create(&threads[t], NULL, trabalhador_lote, &lote) != 0) {
+            fprintf(stderr, "ERRO: Não foi possível criar a thread %d.\n", t);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int t = 0; t < numThreads; t++) pthread_join(threads[t], NULL);
+    free(threads);
+
+    // Resumo: as falhas são listadas no fim em vez de abortar no primeiro arquivo ruim
+    int falhas = 0;
+    for (int t = 0; t < lote.numTarefas; t++) {
+        if (lote.tarefas[t].falhou) {
+            if (falhas++ == 0) fprintf(stderr, "Falhas:\n");
+            fprintf(stderr, "  %s: %s\n", lote.tarefas[t].entrada, lote.tarefas[t].erro);
+        }
     }
+    printf("-> Lote concluído em %.3f s: %d traduzidos, %d com falha.\n",
+           relogio_segundos() - inicio, lote.numTarefas - falhas, falhas);
 
-    fclose(arquivo);
-    return maquina;
+    for (int t = 0; t < lote.numTarefas; t++) {
+        free(lote.tarefas[t].entrada);
+        free(lote.tarefas[t].saida);
+    }
+    free(lote.tarefas);
+    return (falhas || errosDeArgumento) ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
-MaquinaTuring* traduzir_maquina(const MaquinaTuring* maquinaOriginal) {
-    printf("-> Iniciando tradução do tipo '%c'...\n", maquinaOriginal->tipo);
+// Modo "stream": tradutor stream [entrada|-] [saida|-], tradução S -> I em memória constante
+static int modo_fluxo(int argc, char* argv[]) {
+    if (argc > 4) {
+        fprintf(stderr, "Uso: %s stream [arquivo_de_entrada|-] [arquivo_de_saida|-]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* nomeEntrada = argc > 2 ? argv[2] : "-";
+    const char* nomeSaida = argc > 3 ? argv[3] : "-";
 
-    switch (maquinaOriginal->tipo) {
-        case 'S':
-            return traduzir_S_para_I(maquinaOriginal);
-        case 'I':
-            return traduzir_I_para_S(maquinaOriginal);
-        default:
-            fprintf(stderr, "ERRO: Tipo de máquina desconhecido '%c'.\n", maquinaOriginal->tipo);
-            return NULL;
+    FILE* entrada = strcmp(nomeEntrada, "-") == 0 ? stdin : fopen(nomeEntrada, "r");
+    if (!entrada) {
+        fprintf(stderr, "ERRO: Não foi possível abrir o arquivo '%s': %s\n", nomeEntrada, strerror(errno));
+        return EXIT_FAILURE;
     }
+
+    int resultado = traduzir_S_para_I_fluxo(entrada, nomeSaida);
+    if (entrada != stdin) fclose(entrada);
+
+    if (resultado != 0) {
+        fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
 }
 
-void adicionar_transicao(MaquinaTuring* maquina, const char* estA, const char* simA, const char* simN, char dir, const char* estN) {
-    // Verifica se o array de transições precisa crescer
-    if (maquina->numTransicoes >= maquina->capacidadeTransicoes) {
-        maquina->capacidadeTransicoes *= 2;
-        maquina->transicoes = (Transicao*) realloc(maquina->transicoes, maquina->capacidadeTransicoes * sizeof(Transicao));
+// Modo "incremental": tradutor incremental <entrada> <saida>, tradução I -> S que reaproveita a saída
+// anterior e o seu manifesto (<saida>.manifesto)
+static int modo_incremental(int argc, char* argv[]) {
+    if (argc != 4) {
+        fprintf(stderr, "Uso: %s incremental <arquivo_de_entrada> <arquivo_de_saida>\n", argv[0]);
+        return EXIT_FAILURE;
     }
-    
-    // Aloca memória e copia os dados para a nova transição
-    int i = maquina->numTransicoes;
-    maquina->transicoes[i].estadoAtual  = strdup(estA);
-    maquina->transicoes[i].simboloAtual = strdup(simA);
-    maquina->transicoes[i].novoSimbolo  = strdup(simN);
-    maquina->transicoes[i].direcao      = dir;
-    maquina->transicoes[i].novoEstado   = strdup(estN);
-    
-    maquina->numTransicoes++;
+
+    double inicio = relogio_segundos();
+    MaquinaTuring* maquina = carregar_maquina(argv[2]);
+    EstatisticasIncremental estatisticas;
+    int resultado = maquina ? traduzir_I_para_S_incremental(maquina, argv[3], &estatisticas) : -1;
+    liberar_maquina(maquina);
+    if (resultado != 0) {
+        fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+        return EXIT_FAILURE;
+    }
+    printf("-> Tradução %s em %.3f s: %d blocos de estados reaproveitados, %d gerados, %d removidos.\n",
+           estatisticas.completa ? "completa" : "incremental", relogio_segundos() - inicio,
+           estatisticas.blocosReaproveitados, estatisticas.blocosGerados, estatisticas.blocosRemovidos);
+    return EXIT_SUCCESS;
 }
 
-void salvar_maquina(const MaquinaTuring* maquina, const char* nomeArquivo) {
-    if (!maquina) {
-        fprintf(stderr, "ERRO: Tentativa de salvar uma máquina nula.\n");
-        return;
+// Modo "run": tradutor run [-p limite] [-i estado] [-f] [-m] <maquina> [palavra]
+static int modo_executar(int argc, char* argv[]) {
+    uint64_t limitePassos = 100000000ULL;
+    const char* estadoInicial = "0";
+    int fitaInfinita = 0;
+    int macropassos = 0;
+
+    int i = 2;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) limitePassos = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) estadoInicial = argv[++i];
+        else if (strcmp(argv[i], "-f") == 0) fitaInfinita = 1;
+        else if (strcmp(argv[i], "-m") == 0) macropassos = 1;
+        else break;
+    }
+    if (i >= argc || argc - i > 2) {
+        fprintf(stderr, "Uso: %s run [-p limite_de_passos] [-i estado_inicial] [-f] [-m] <maquina> [palavra]\n", argv[0]);
+        return EXIT_FAILURE;
     }
+    const char* palavra = i + 1 < argc ? argv[i + 1] : "";
 
-    FILE* arquivo = fopen(nomeArquivo, "w");
-    if (!arquivo) {
-        fprintf(stderr, "ERRO: Não foi possível abrir o arquivo de saída '%s': %s\n", nomeArquivo, strerror(errno));
-        exit(EXIT_FAILURE);
+    MaquinaTuring* maquina = carregar_maquina(argv[i]);
+    if (!maquina) {
+        fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+        return EXIT_FAILURE;
+    }
+    ProgramaCompilado* programa = compilar_maquina(maquina, palavra, estadoInicial);
+    Fita fita = { NULL, 0, 0, 0 };
+    if (!programa || fita_iniciar(&fita, programa, palavra) != 0) {
+        fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+        fita_liberar(&fita);
+        liberar_programa(programa);
+        liberar_maquina(maquina);
+        return EXIT_FAILURE;
+    }
+    if (fitaInfinita) programa->semiInfinita = 0;
+    if (macropassos) {
+        int marcadas = acelerar_programa(programa);
+        if (marcadas < 0) fprintf(stderr, "AVISO: %s Executando sem macropassos.\n", ultimo_erro());
+        else fprintf(stderr, "-> %d entradas da tabela aceleradas por macropassos.\n", marcadas);
     }
 
-    // Escrever a primeira linha com o tipo da máquina
-    fprintf(arquivo, ";%c\n", maquina->tipo);
+    double inicio = relogio_segundos();
+    ResultadoExecucao resultado = executar_programa(programa, &fita, limitePassos);
+    double duracao = relogio_segundos() - inicio;
+
+    printf("Estado final: %s\n", nome_estado(maquina, resultado.estadoFinal));
+    printf("Motivo:       %s\n", descrever_motivo(resultado.motivo));
+    printf("Passos:       %llu\n", (unsigned long long) resultado.passos);
+    printf("Fita:         ");
+    fita_escrever(&fita, programa, stdout);
+    printf("\n");
+    fprintf(stderr, "-> %.3f s (%.1f milhões de passos/s)\n", duracao, duracao > 0 ? resultado.passos / duracao / 1e6 : 0.0);
+
+    fita_liberar(&fita);
+    liberar_programa(programa);
+    liberar_maquina(maquina);
+    return EXIT_SUCCESS;
+}
 
-    // Fazer um loop e escrever cada transição
-    for (int i = 0; i < maquina->numTransicoes; i++) {
-        const Transicao* t = &maquina->transicoes[i]; // Ponteiro para a transição atual
-        fprintf(arquivo, "%s %s %s %c %s\n",
-                t->estadoAtual,
-                t->simboloAtual,
-                t->novoSimbolo,
-                t->direcao,
-                t->novoEstado);
+// === Execução em lote ===
+// Uma máquina sobre um arquivo de palavras, uma por linha. As palavras são divididas em blocos; cada
+// thread pega o próximo bloco, executa as suas palavras com executar_lote e grava as linhas de resultado
+// na ordem das palavras, esperando a vez do bloco. A saída é a mesma com qualquer número de threads e pistas.
+
+#define PALAVRAS_POR_BLOCO 4096
+
+typedef struct {
+    const ProgramaCompilado* programa;
+    char** palavras;
+    int numPalavras;
+    int numPistas;
+    uint64_t limitePassos;
+    atomic_int proximoBloco;
+    pthread_mutex_t trava;
+    pthread_cond_t vez;
+    int blocoDaVez;           // próximo bloco a ser gravado
+    FILE* saida;
+    atomic_int falhou;
+    atomic_ullong passos;
+} ExecucaoEmLote;
+
+// Linhas de resultado de um bloco, num único buffer; a linha da palavra i do bloco começa em inicioLinha[i]
+typedef struct {
+    const ProgramaCompilado* programa;
+    int primeira;
+    char* texto;
+    size_t tamanho;
+    size_t capacidade;
+    size_t* inicioLinha;
+    size_t* tamanhoLinha;
+    uint64_t passos;
+    int semMemoria;
+} ResultadosBloco;
+
+static void resultados_anexar(ResultadosBloco* bloco, const char* dados, size_t tamanho) {
+    if (bloco->tamanho + tamanho > bloco->capacidade) {
+        size_t capacidade = bloco->capacidade ? bloco->capacidade : 4096;
+        while (capacidade < bloco->tamanho + tamanho) capacidade *= 2;
+        char* texto = (char*) realloc(bloco->texto, capacidade);
+        if (!texto) {
+            bloco->semMemoria = 1;
+            return;
+        }
+        bloco->texto = texto;
+        bloco->capacidade = capacidade;
     }
+    memcpy(bloco->texto + bloco->tamanho, dados, tamanho);
+    bloco->tamanho += tamanho;
+}
 
-    fclose(arquivo);
+// Linha "estado_final<TAB>motivo<TAB>passos<TAB>fita" de uma palavra concluída
+static void concluir_palavra_lote(void* contexto, int indice, const ResultadoExecucao* resultado, const Fita* fita) {
+    ResultadosBloco* bloco = (ResultadosBloco*) contexto;
+    const ProgramaCompilado* programa = bloco->programa;
+    size_t inicio = bloco->tamanho;
+    char texto[64];
+    if (!resultado) {
+        const char* invalida = "-\tpalavra inválida\t0\t-\n";
+        resultados_anexar(bloco, invalida, strlen(invalida));
+    } else {
+        const char* estado = nome_estado(programa->maquina, resultado->estadoFinal);
+        resultados_anexar(bloco, estado, strlen(estado));
+        int n = snprintf(texto, sizeof(texto), "\t%s\t%llu\t", descrever_motivo(resultado->motivo), (unsigned long long) resultado->passos);
+        resultados_anexar(bloco, texto, (size_t) n);
+
+        // Fita sem os brancos das pontas, como fita_escrever
+        int64_t primeira = 0, fim = fita->capacidade;
+        while (primeira < fim && fita->celulas[primeira] == programa->colunaBranco) primeira++;
+        while (fim > primeira && fita->celulas[fim - 1] == programa->colunaBranco) fim--;
+        if (primeira == fim) resultados_anexar(bloco, "_", 1);
+        for (int64_t c = primeira; c < fim; c++) {
+            const char* nome = nome_coluna(programa, fita->celulas[c]);
+            resultados_anexar(bloco, nome, strlen(nome));
+        }
+        resultados_anexar(bloco, "\n", 1);
+        bloco->passos += resultado->passos;
+    }
+    bloco->inicioLinha[indice] = inicio;
+    bloco->tamanhoLinha[indice] = bloco->tamanho - inicio;
 }
 
-void liberar_maquina(MaquinaTuring* maquina) {
-    if (!maquina) return;
+static void* trabalhador_execucao_lote(void* argumento) {
+    ExecucaoEmLote* lote = (ExecucaoEmLote*) argumento;
+    ResultadosBloco bloco;
+    memset(&bloco, 0, sizeof(bloco));
+    bloco.programa = lote->programa;
+    bloco.inicioLinha = (size_t*) malloc(PALAVRAS_POR_BLOCO * sizeof(size_t));
+    bloco.tamanhoLinha = (size_t*) malloc(PALAVRAS_POR_BLOCO * sizeof(size_t));
+    int numBlocos = (lote->numPalavras + PALAVRAS_POR_BLOCO - 1) / PALAVRAS_POR_BLOCO;
+
+    for (;;) {
+        int b = atomic_fetch_add(&lote->proximoBloco, 1);
+        if (b >= numBlocos) break;
+        bloco.primeira = b * PALAVRAS_POR_BLOCO;
+        int numPalavras = lote->numPalavras - bloco.primeira < PALAVRAS_POR_BLOCO ? lote->numPalavras - bloco.primeira : PALAVRAS_POR_BLOCO;
+        bloco.tamanho = 0;
+        bloco.passos = 0;
+
+        int falhou = !bloco.inicioLinha || !bloco.tamanhoLinha;
+        if (!falhou && executar_lote(lote->programa, (const char* const*) lote->palavras + bloco.primeira, numPalavras,
+                                     lote->numPistas, lote->limitePassos, concluir_palavra_lote, &bloco) != 0) {
+            fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+            falhou = 1;
+        }
+        if (bloco.semMemoria || (falhou && (!bloco.inicioLinha || !bloco.tamanhoLinha))) {
+            fprintf(stderr, "ERRO: Falha na alocação de memória para os resultados.\n");
+            falhou = 1;
+        }
+        if (falhou) atomic_store(&lote->falhou, 1);
+        atomic_fetch_add(&lote->passos, bloco.passos);
+
+        // Os blocos são gravados na ordem das palavras; depois de uma falha, só passam a vez
+        pthread_mutex_lock(&lote->trava);
+        while (lote->blocoDaVez != b) pthread_cond_wait(&lote->vez, &lote->trava);
+        pthread_mutex_unlock(&lote->trava);
+        if (!atomic_load(&lote->falhou)) {
+            for (int i = 0; i < numPalavras; i++) fwrite(bloco.texto + bloco.inicioLinha[i], 1, bloco.tamanhoLinha[i], lote->saida);
+        }
+        pthread_mutex_lock(&lote->trava);
+        lote->blocoDaVez++;
+        pthread_cond_broadcast(&lote->vez);
+        pthread_mutex_unlock(&lote->trava);
+    }
+
+    free(bloco.texto);
+    free(bloco.inicioLinha);
+    free(bloco.tamanhoLinha);
+    return NULL;
+}
 
-    for (int i = 0; i < maquina->numTransicoes; i++) {
-        free(maquina->transicoes[i].estadoAtual);
-        free(maquina->transicoes[i].simboloAtual);
-        free(maquina->transicoes[i].novoSimbolo);
-        free(maquina->transicoes[i].novoEstado);
+// Lê o arquivo de palavras ("-" é a entrada padrão) e o divide em linhas, sem '\n' nem '\r' final.
+// Retorna o vetor de palavras (a primeira aponta para o início do buffer) ou NULL.
+static char** ler_palavras(const char* nomeArquivo, int* numPalavras) {
+    FILE* entrada = strcmp(nomeArquivo, "-") == 0 ? stdin : fopen(nomeArquivo, "r");
+    if (!entrada) {
+        fprintf(stderr, "ERRO: Não foi possível abrir o arquivo '%s': %s\n", nomeArquivo, strerror(errno));
+        return NULL;
+    }
+    size_t tamanho = 0, capacidade = 1 << 16;
+    char* dados = (char*) malloc(capacidade + 1);
+    size_t lidos;
+    while (dados && (lidos = fread(dados + tamanho, 1, capacidade - tamanho, entrada)) > 0) {
+        tamanho += lidos;
+        if (tamanho == capacidade) {
+            char* maiores = (char*) realloc(dados, capacidade * 2 + 1);
+            if (!maiores) {
+                free(dados);
+                dados = NULL;
+                break;
+            }
+            dados = maiores;
+            capacidade *= 2;
+        }
+    }
+    int erroLeitura = ferror(entrada);
+    if (entrada != stdin) fclose(entrada);
+    if (!dados || erroLeitura) {
+        fprintf(stderr, "ERRO: Não foi possível ler as palavras de '%s'.\n", nomeArquivo);
+        free(dados);
+        return NULL;
     }
-    
-    free(maquina->transicoes);
-    free(maquina);
+    dados[tamanho] = '\0';
+
+    int linhas = 0;
+    for (size_t i = 0; i < tamanho; i++) linhas += dados[i] == '\n';
+    if (tamanho > 0 && dados[tamanho - 1] != '\n') linhas++;
+    char** palavras = (char**) malloc(((size_t) linhas + 1) * sizeof(char*));
+    if (!palavras) {
+        fprintf(stderr, "ERRO: Falha na alocação de memória para as palavras.\n");
+        free(dados);
+        return NULL;
+    }
+    palavras[0] = dados;
+    int n = 0;
+    char* linha = dados;
+    for (char* fim; n < linhas; linha = fim + 1) {
+        fim = strchr(linha, '\n');
+        if (!fim) fim = dados + tamanho;
+        *fim = '\0';
+        if (fim > linha && fim[-1] == '\r') fim[-1] = '\0';
+        palavras[n++] = linha;
+    }
+    *numPalavras = n;
+    return palavras;
 }
 
+// Modo "batch-run": tradutor batch-run [-p limite] [-i estado_inicial] [-f] [-j threads] [-l pistas] [-o saida] <maquina> <palavras|->
+// Executa a máquina sobre cada palavra do arquivo (uma por linha) e grava uma linha
+// "estado_final<TAB>motivo<TAB>passos<TAB>fita" por palavra, na ordem do arquivo.
+static int modo_executar_lote(int argc, char* argv[]) {
+    uint64_t limitePassos = 100000000ULL;
+    const char* estadoInicial = "0";
+    int fitaInfinita = 0;
+    int numThreads = numero_de_nucleos();
+    int numPistas = 64;
+    const char* nomeSaida = "-";
+
+    int i = 2;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) limitePassos = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) estadoInicial = argv[++i];
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) numPistas = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) nomeSaida = argv[++i];
+        else if (strcmp(argv[i], "-f") == 0) fitaInfinita = 1;
+        else break;
+    }
+    if (argc - i != 2) {
+        fprintf(stderr, "Uso: %s batch-run [-p limite_de_passos] [-i estado_inicial] [-f] [-j threads] [-l pistas] [-o saida] "
+                "<maquina> <palavras|->\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (numThreads < 1) numThreads = 1;
+    if (numPistas < 1) numPistas = 1;
+
+    int numPalavras = 0;
+    char** palavras = ler_palavras(argv[i + 1], &numPalavras);
+    if (!palavras) return EXIT_FAILURE;
+
+    // Alfabeto de entrada: todos os caracteres que aparecem nas palavras
+    char alfabeto[257];
+    int tamanhoAlfabeto = 0;
+    uint8_t presente[256] = { 0 };
+    for (int p = 0; p < numPalavras; p++) {
+        for (const unsigned char* c = (const unsigned char*) palavras[p]; *c; c++) presente[*c] = 1;
+    }
+    for (int c = 1; c < 256; c++) {
+        if (presente[c]) alfabeto[tamanhoAlfabeto++] = (char) c;
+    }
+    alfabeto[tamanhoAlfabeto] = '\0';
+
+    MaquinaTuring* maquina = carregar_maquina(argv[i]);
+    ProgramaCompilado* programa = maquina ? compilar_maquina(maquina, alfabeto, estadoInicial) : NULL;
+    FILE* saida = NULL;
+    if (programa) saida = strcmp(nomeSaida, "-") == 0 ? stdout : fopen(nomeSaida, "w");
+    if (!programa || !saida) {
+        if (!programa) fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+        else fprintf(stderr, "ERRO: Não foi possível criar o arquivo '%s': %s\n", nomeSaida, strerror(errno));
+        liberar_programa(programa);
+        liberar_maquina(maquina);
+        free(palavras[0]);
+        free(palavras);
+        return EXIT_FAILURE;
+    }
+    if (fitaInfinita) programa->semiInfinita = 0;
+
+    ExecucaoEmLote lote;
+    lote.programa = programa;
+    lote.palavras = palavras;
+    lote.numPalavras = numPalavras;
+    lote.numPistas = numPistas;
+    lote.limitePassos = limitePassos;
+    atomic_init(&lote.proximoBloco, 0);
+    pthread_mutex_init(&lote.trava, NULL);
+    pthread_cond_init(&lote.vez, NULL);
+    lote.blocoDaVez = 0;
+    lote.saida = saida;
+    atomic_init(&lote.falhou, 0);
+    atomic_init(&lote.passos, 0);
+
+    int numBlocos = (numPalavras + PALAVRAS_POR_BLOCO - 1) / PALAVRAS_POR_BLOCO;
+    if (numThreads > numBlocos) numThreads = numBlocos > 0 ? numBlocos : 1;
+    fprintf(stderr, "-> Executando %d palavras com %d threads de %d pistas...\n", numPalavras, numThreads, numPistas);
+    double inicio = relogio_segundos();
+
+    pthread_t* threads = (pthread_t*) malloc(numThreads * sizeof(pthread_t));
+    int criadas = 0;
+    while (threads && criadas < numThreads && pthread_create(&threads[criadas], NULL, trabalhador_execucao_lote, &lote) == 0) criadas++;
+    if (criadas == 0) trabalhador_execucao_lote(&lote);
+    for (int t = 0; t < criadas; t++) pthread_join(threads[t], NULL);
+    free(threads);
+    double duracao = relogio_segundos() - inicio;
+
+    int falhou = atomic_load(&lote.falhou);
+    if (fflush(saida) != 0 || ferror(saida)) {
+        fprintf(stderr, "ERRO: Falha ao gravar os resultados em '%s'.\n", nomeSaida);
+        falhou = 1;
+    }
+    if (saida != stdout && fclose(saida) != 0) falhou = 1;
+    unsigned long long passos = atomic_load(&lote.passos);
+    if (!falhou) {
+        fprintf(stderr, "-> %d palavras em %.3f s (%.0f palavras/s, %.1f milhões de passos/s).\n", numPalavras, duracao,
+                duracao > 0 ? numPalavras / duracao : 0.0, duracao > 0 ? passos / duracao / 1e6 : 0.0);
+    }
 
+    pthread_mutex_destroy(&lote.trava);
+    pthread_cond_destroy(&lote.vez);
+    liberar_programa(programa);
+    liberar_maquina(maquina);
+    free(palavras[0]);
+    free(palavras);
+    return falhou ? EXIT_FAILURE : EXIT_SUCCESS;
+}
 
-//  Lógica usada: Para desenvolver uma MT Duplamente Infinita (MT_di) que simule uma MT Sipser, precisamos primeiramente na MT_di mover o cabeçote para a esquerda e marcar o inicio da fita com um simbolo especial (no caso o #). Apartir disso a MT_di reproduz as transições para direita e parado exatamente da mesma forma que a do Sipser, a unica diferença é a o movimento para a esquerda que pode ser que o mesmo leve para o simbolo #, nesse caso o cabeçote deve voltar para a primeira celula (simbolo 0 ou 1). E para fazer essa verificação e garantir a integridade da tradução adicionamos a transição ("#", "#", 'r') para cada estado que possua uma transição para esquerda 'l'.
+// === Perfil de execução ===
 
-MaquinaTuring* traduzir_S_para_I(const MaquinaTuring* maquinaOriginal) {
-    MaquinaTuring* maquinaTraduzida = (MaquinaTuring*) malloc(sizeof(MaquinaTuring));
-    maquinaTraduzida->tipo = 'I';
-    maquinaTraduzida->numTransicoes = 0;
-    maquinaTraduzida->capacidadeTransicoes = 20;
-    maquinaTraduzida->transicoes = (Transicao*) malloc(maquinaTraduzida->capacidadeTransicoes * sizeof(Transicao));
-    
-    printf("-> Gerando sub-rotina de setup-shift para o alfabeto {0, 1} (versão final)...\n");
+typedef struct {
+    uint64_t contagem;
+    uint32_t indice;
+} ItemPerfil;
+
+static int comparar_itens_perfil(const void* a, const void* b) {
+    const ItemPerfil* x = (const ItemPerfil*) a;
+    const ItemPerfil* y = (const ItemPerfil*) b;
+    if (x->contagem != y->contagem) return x->contagem < y->contagem ? 1 : -1;
+    return (x->indice > y->indice) - (x->indice < y->indice);
+}
 
-    // Parte 1: Move para esquerda e coloca a barreira #
-    adicionar_transicao(maquinaTraduzida, "0", "*", "*", 'l', "marcar_#");
-    adicionar_transicao(maquinaTraduzida, "marcar_#", "*", "#", 'r', "0_dir");
+// Os 'maximo' índices de maior contagem, em ordem decrescente; retorna quantos têm contagem > 0
+static int mais_executados(const uint64_t* contagens, uint32_t n, ItemPerfil* itens, int maximo) {
+    int numItens = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (contagens[i] == 0) continue;
+        itens[numItens].contagem = contagens[i];
+        itens[numItens].indice = i;
+        numItens++;
+    }
+    qsort(itens, numItens, sizeof(ItemPerfil), comparar_itens_perfil);
+    return numItens < maximo ? numItens : maximo;
+}
 
-    // Estrutura para rastrear estados que já possuem regra de barreira
-    int capacidadeBarreira = 10;
-    int numEstadosBarreira = 0;
-    char** estadosComBarreira = (char**) malloc(capacidadeBarreira * sizeof(char*));
+// Escreve "estA simA simN dir estN"; no formato folded, ';' separa os quadros e vira ':'
+static void escrever_regra(FILE* saida, const MaquinaTuring* maquina, int regra, int folded) {
+    const Transicao* t = &maquina->transicoes[regra];
+    const char* partes[4] = { nome_estado(maquina, t->estadoAtual), nome_simbolo(maquina, t->simboloAtual),
+                              nome_simbolo(maquina, t->novoSimbolo), nome_estado(maquina, t->novoEstado) };
+    for (int p = 0; p < 4; p++) {
+        for (const char* c = partes[p]; *c; c++) fputc(folded && *c == ';' ? ':' : *c, saida);
+        if (p == 2) fprintf(saida, " %c", t->direcao);
+        if (p < 3) fputc(' ', saida);
+    }
+}
 
-    // Parte 2: Tratando as transições originais sem problemas (movimento para direita e Parado)
-    printf("-> Traduzindo regras simples (movimento 'r', '*' e 'l')...\n");
-    for (int i = 0; i < maquinaOriginal->numTransicoes; i++) {
-        const Transicao* t = &maquinaOriginal->transicoes[i];
+static void escrever_quadro(FILE* saida, const char* nome) {
+    for (const char* c = nome; *c; c++) fputc(*c == ';' ? ':' : *c, saida);
+}
 
-        // Traduz apenas as regras de movimento para a direita ou parado
-        if (t->direcao == 'r' || t->direcao == '*') {
-            char estadoAtualDir[100];
-            char novoEstadoDir[100];
+// Modo "profile": tradutor profile [-p limite_de_passos] [-i estado_inicial] [-f] [-d|-c] [-s] [-n linhas] [-F arquivo_folded] <maquina> [palavra]
+// Traduz a máquina em memória, marcando de que transição da original cada regra veio, executa a traduzida
+// contando os passos de cada entrada da tabela e atribui cada passo a uma transição da original ou a uma
+// categoria de regra auxiliar da tradução. Com -s, a máquina é executada como está, sem tradução.
+// -F grava as contagens no formato "quadro;quadro;... passos" do flamegraph.pl.
+static int modo_perfil(int argc, char* argv[]) {
+    uint64_t limitePassos = 100000000ULL;
+    const char* estadoInicial = "0";
+    int fitaInfinita = 0;
+    int semTraducao = 0;
+    int linhas = 10;
+    const char* arquivoFolded = NULL;
+
+    int i = 2;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) limitePassos = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) estadoInicial = argv[++i];
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) linhas = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-F") == 0 && i + 1 < argc) arquivoFolded = argv[++i];
+        else if (strcmp(argv[i], "-f") == 0) fitaInfinita = 1;
+        else if (strcmp(argv[i], "-s") == 0) semTraducao = 1;
+        else if (strcmp(argv[i], "-d") == 0) esquemaIparaS = ESQUEMA_DOBRADO;
+        else if (strcmp(argv[i], "-c") == 0) esquemaIparaS = ESQUEMA_COMPARTILHADO;
+        else break;
+    }
+    if (i >= argc || argc - i > 2) {
+        fprintf(stderr, "Uso: %s profile [-p limite_de_passos] [-i estado_inicial] [-f] [-d|-c] [-s] [-n linhas] [-F arquivo_folded] "
+                "<maquina> [palavra]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (linhas < 1) linhas = 1;
+    const char* palavra = i + 1 < argc ? argv[i + 1] : "";
+
+    MaquinaTuring* original = carregar_maquina(argv[i]);
+    MaquinaTuring* maquina = NULL;
+    int32_t* origens = NULL;
+    if (original && !semTraducao) maquina = traduzir_maquina_com_origens(original, esquemaIparaS, &origens);
+    else maquina = original;
+    ProgramaCompilado* programa = maquina ? compilar_maquina(maquina, palavra, estadoInicial) : NULL;
+    int32_t* regras = programa ? regras_do_programa(programa) : NULL;
+    size_t numEntradas = programa ? (size_t) programa->numEstados * programa->numColunas : 0;
+    uint64_t* contagens = regras ? (uint64_t*) calloc(numEntradas + 1, sizeof(uint64_t)) : NULL;
+    uint64_t* porRegra = contagens ? (uint64_t*) calloc((size_t) maquina->numTransicoes + 1, sizeof(uint64_t)) : NULL;
+    uint64_t* porEstado = porRegra ? (uint64_t*) calloc((size_t) programa->numEstados + 1, sizeof(uint64_t)) : NULL;
+    Fita fita = { NULL, 0, 0, 0 };
+    int falhou = !porEstado || fita_iniciar(&fita, programa, palavra) != 0;
+    if (falhou) {
+        if (regras && !porEstado) fprintf(stderr, "ERRO: Falha na alocação de memória para as contagens.\n");
+        else fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+    }
 
-            // Adiciona o sufixo '_dir', a menos que seja um estado 'halt'
-            if (strncmp(t->estadoAtual, "halt", 4) == 0) {
-                strcpy(estadoAtualDir, t->estadoAtual);
+    if (!falhou) {
+        if (fitaInfinita) programa->semiInfinita = 0;
+        double inicio = relogio_segundos();
+        ResultadoExecucao resultado = executar_programa_perfilado(programa, &fita, limitePassos, contagens);
+        double duracao = relogio_segundos() - inicio;
+
+        printf("Estado final: %s\n", nome_estado(maquina, resultado.estadoFinal));
+        printf("Motivo:       %s\n", descrever_motivo(resultado.motivo));
+        printf("Passos:       %llu\n", (unsigned long long) resultado.passos);
+        printf("Fita:         ");
+        fita_escrever(&fita, programa, stdout);
+        printf("\n");
+        fprintf(stderr, "-> %.3f s (%.1f milhões de passos/s)\n", duracao, duracao > 0 ? resultado.passos / duracao / 1e6 : 0.0);
+
+        for (size_t e = 0; e < numEntradas; e++) {
+            if (!contagens[e]) continue;
+            porRegra[regras[e]] += contagens[e];
+            porEstado[e / programa->numColunas] += contagens[e];
+        }
+        double total = resultado.passos ? (double) resultado.passos : 1.0;
+
+        // Passos por origem: transições da original ou categorias de regras auxiliares
+        uint64_t porCategoria[NUM_CATEGORIAS] = { 0 };
+        uint64_t* porOriginal = origens ? (uint64_t*) calloc((size_t) original->numTransicoes + 1, sizeof(uint64_t)) : NULL;
+        if (origens && porOriginal) {
+            for (int r = 0; r < maquina->numTransicoes; r++) {
+                if (origens[r] >= 0) porOriginal[origens[r]] += porRegra[r];
+                else porCategoria[-1 - origens[r]] += porRegra[r];
+            }
+            uint64_t passosOriginal = 0;
+            for (int r = 0; r < original->numTransicoes; r++) passosOriginal += porOriginal[r];
+            uint64_t sobrecarga = resultado.passos - passosOriginal;
+            printf("\n-> Passos por origem:\n");
+            printf("   %-14s %14llu %6.2f%%\n", "original", (unsigned long long) passosOriginal, 100.0 * passosOriginal / total);
+            for (int c = 0; c < NUM_CATEGORIAS; c++) {
+                if (c == REGRAS_COPIADAS) continue;
+                printf("   %-14s %14llu %6.2f%%\n", nome_categoria((CategoriaRegra) c), (unsigned long long) porCategoria[c],
+                       100.0 * porCategoria[c] / total);
+            }
+            if (passosOriginal) {
+                printf("-> Sobrecarga da tradução: %.3f passos por passo da original (%.2f%% dos passos em regras auxiliares).\n",
+                       (double) resultado.passos / passosOriginal, 100.0 * sobrecarga / total);
             } else {
-                sprintf(estadoAtualDir, "%s_dir", t->estadoAtual);
+                printf("-> Sobrecarga da tradução: nenhum passo executou uma transição da original.\n");
             }
+        } else if (origens) {
+            fprintf(stderr, "AVISO: Falha na alocação de memória para as contagens da original; sem atribuição.\n");
+        }
 
-            if (strncmp(t->novoEstado, "halt", 4) == 0) {
-                strcpy(novoEstadoDir, t->novoEstado);
-            } else {
-                sprintf(novoEstadoDir, "%s_dir", t->novoEstado);
+        uint32_t maiorLista = programa->numEstados > (uint32_t) maquina->numTransicoes ? programa->numEstados : (uint32_t) maquina->numTransicoes;
+        if (porOriginal && (uint32_t) original->numTransicoes > maiorLista) maiorLista = original->numTransicoes;
+        ItemPerfil* itens = (ItemPerfil*) malloc(((size_t) maiorLista + 1) * sizeof(ItemPerfil));
+        if (itens) {
+            int n = mais_executados(porEstado, programa->numEstados, itens, linhas);
+            printf("\n-> Estados mais executados:\n");
+            for (int k = 0; k < n; k++) {
+                printf("   %14llu %6.2f%%  %s\n", (unsigned long long) itens[k].contagem, 100.0 * itens[k].contagem / total,
+                       nome_estado(maquina, itens[k].indice));
             }
-            
-            // Adiciona a transição traduzida à nova máquina
-            adicionar_transicao(maquinaTraduzida,
-                estadoAtualDir,
-                t->simboloAtual,
-                t->novoSimbolo,
-                t->direcao,
-                novoEstadoDir);
-        }
-        
-        else if (t->direcao == 'l') {
-            // A lógica aqui é identica a de cima, apenas para a direção 'l'
-            char estadoAtualDir[100];
-            char novoEstadoDir[100];
-
-            if (strncmp(t->estadoAtual, "halt", 4) == 0) strcpy(estadoAtualDir, t->estadoAtual);
-            else sprintf(estadoAtualDir, "%s_dir", t->estadoAtual);
-
-            if (strncmp(t->novoEstado, "halt", 4) == 0) strcpy(novoEstadoDir, t->novoEstado);
-            else sprintf(novoEstadoDir, "%s_dir", t->novoEstado);
-        
-             // Adiciona a transição 'l' normal (caso não seja na barreira)
-            adicionar_transicao(maquinaTraduzida, estadoAtualDir, t->simboloAtual, t->novoSimbolo, 'l', novoEstadoDir);
-            
-            // Verifica se a regra da mola para 'novoEstadoDir' já foi criada
-            int regraJaExiste = 0;
-            for (int j = 0; j < numEstadosBarreira; j++) {
-                if (strcmp(estadosComBarreira[j], novoEstadoDir) == 0) {
-                    regraJaExiste = 1;
-                    break;
+
+            n = mais_executados(porRegra, maquina->numTransicoes, itens, linhas);
+            printf("\n-> Regras mais executadas:\n");
+            for (int k = 0; k < n; k++) {
+                printf("   %14llu %6.2f%%  ", (unsigned long long) itens[k].contagem, 100.0 * itens[k].contagem / total);
+                escrever_regra(stdout, maquina, itens[k].indice, 0);
+                if (origens && origens[itens[k].indice] >= 0) {
+                    printf("   <- ");
+                    escrever_regra(stdout, original, origens[itens[k].indice], 0);
+                } else if (origens) {
+                    printf("   [%s]", nome_categoria((CategoriaRegra) (-1 - origens[itens[k].indice])));
                 }
+                printf("\n");
             }
-            
-            // Se a regra ainda não existe, crie ela e registre o estado
-            if (!regraJaExiste) {
-                // Adiciona a regra da mola: ao bater no '#', move para a direita 'r'
-                adicionar_transicao(maquinaTraduzida, novoEstadoDir, "#", "#", 'r', novoEstadoDir);
-                
-                // Registra que já criamos a regra para este estado
-                if (numEstadosBarreira >= capacidadeBarreira) {
-                    capacidadeBarreira *= 2;
-                    estadosComBarreira = (char**) realloc(estadosComBarreira, capacidadeBarreira * sizeof(char*));
+
+            if (porOriginal) {
+                n = mais_executados(porOriginal, original->numTransicoes, itens, linhas);
+                printf("\n-> Transições da original mais executadas:\n");
+                for (int k = 0; k < n; k++) {
+                    printf("   %14llu %6.2f%%  ", (unsigned long long) itens[k].contagem, 100.0 * itens[k].contagem / total);
+                    escrever_regra(stdout, original, itens[k].indice, 0);
+                    printf("\n");
                 }
-                estadosComBarreira[numEstadosBarreira++] = strdup(novoEstadoDir);
             }
+            free(itens);
+        } else {
+            fprintf(stderr, "AVISO: Falha na alocação de memória para o relatório de pontos quentes.\n");
+        }
 
-
+        // Pilhas para o flamegraph: original;<estado>;<transição> ou <categoria>;<estado da traduzida>
+        if (arquivoFolded) {
+            FILE* saida = fopen(arquivoFolded, "w");
+            if (!saida) {
+                fprintf(stderr, "ERRO: Não foi possível criar o arquivo '%s': %s\n", arquivoFolded, strerror(errno));
+                falhou = 1;
+            } else {
+                if (porOriginal) {
+                    for (int r = 0; r < original->numTransicoes; r++) {
+                        if (!porOriginal[r]) continue;
+                        fprintf(saida, "original;");
+                        escrever_quadro(saida, nome_estado(original, original->transicoes[r].estadoAtual));
+                        fputc(';', saida);
+                        escrever_regra(saida, original, r, 1);
+                        fprintf(saida, " %llu\n", (unsigned long long) porOriginal[r]);
+                    }
+                }
+                for (int r = 0; r < maquina->numTransicoes; r++) {
+                    if (!porRegra[r] || (porOriginal && origens[r] >= 0)) continue;
+                    if (porOriginal) fprintf(saida, "%s;", nome_categoria((CategoriaRegra) (-1 - origens[r])));
+                    escrever_quadro(saida, nome_estado(maquina, maquina->transicoes[r].estadoAtual));
+                    fputc(';', saida);
+                    escrever_regra(saida, maquina, r, 1);
+                    fprintf(saida, " %llu\n", (unsigned long long) porRegra[r]);
+                }
+                if (fclose(saida) != 0) {
+                    fprintf(stderr, "ERRO: Falha ao gravar o arquivo '%s': %s\n", arquivoFolded, strerror(errno));
+                    falhou = 1;
+                }
+                else fprintf(stderr, "-> Pilhas no formato folded gravadas em %s.\n", arquivoFolded);
+            }
         }
+        free(porOriginal);
+    }
+
+    fita_liberar(&fita);
+    free(porEstado);
+    free(porRegra);
+    free(contagens);
+    free(regras);
+    liberar_programa(programa);
+    if (maquina != original) liberar_maquina(maquina);
+    liberar_maquina(original);
+    free(origens);
+    return falhou ? EXIT_FAILURE : EXIT_SUCCESS;
+}
 
+// Modo "compile": tradutor compile [-i estado_inicial] [-a alfabeto] [-f] <maquina> <saida.c>, gera um programa C
+// que executa a máquina. As palavras do programa gerado só podem usar os caracteres de 'alfabeto'
+// (padrão: todos os caracteres imprimíveis do ASCII), além dos símbolos da máquina.
+static int modo_compilar(int argc, char* argv[]) {
+    const char* estadoInicial = "0";
+    int fitaInfinita = 0;
+    char alfabeto[128];
+    int n = 0;
+    for (int c = 33; c < 127; c++) alfabeto[n++] = (char) c;
+    alfabeto[n] = '\0';
+    const char* alfabetoEntrada = alfabeto;
+
+    int i = 2;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) estadoInicial = argv[++i];
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) alfabetoEntrada = argv[++i];
+        else if (strcmp(argv[i], "-f") == 0) fitaInfinita = 1;
+        else break;
+    }
+    if (argc - i != 2) {
+        fprintf(stderr, "Uso: %s compile [-i estado_inicial] [-a alfabeto] [-f] <maquina> <saida.c>\n", argv[0]);
+        return EXIT_FAILURE;
     }
 
-    return maquinaTraduzida;
+    MaquinaTuring* maquina = carregar_maquina(argv[i]);
+    ProgramaCompilado* programa = maquina ? compilar_maquina(maquina, alfabetoEntrada, estadoInicial) : NULL;
+    if (programa && fitaInfinita) programa->semiInfinita = 0;
+    int resultado = programa ? gerar_programa_c(programa, argv[i + 1]) : -1;
+    if (resultado != 0) fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+    else printf("-> Programa C com %u estados e %u símbolos gravado em %s.\n", programa->numEstados, programa->numColunas, argv[i + 1]);
+
+    liberar_programa(programa);
+    liberar_maquina(maquina);
+    return resultado == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
+// === Verificação ===
 
-MaquinaTuring* traduzir_I_para_S(const MaquinaTuring* maquinaOriginal) {
-    // --- INÍCIO: Parte de inicialização e coleta de estados (do seu código original) ---
+static void parametros_verificacao_padrao(ParametrosVerificacao* p) {
+    memset(p, 0, sizeof(*p));
+    p->comprimentoMaximo = 8;
+    p->comprimentoAleatorio = 32;
+    p->numAleatorias = 10000;
+    p->semente = 12345;
+    p->limitePassos = 100000;
+    p->fatorTraduzida = 1000;
+}
 
-    // Renomeia o estado "0" original para "inicio" nas transições da máquina original antes de processá-las
-    // Isso evita conflitos com o novo estado "0" de pré-processamento na MT de Sipser.
-    // **IMPORTANTE**: Fazendo isso aqui, as transições da máquina original são MODIFICADAS.
-    // Para uma abordagem mais robusta, deveríamos copiar as transições e renomear na cópia.
-    // Por simplicidade e dada a natureza do exercício, vamos manter assim, mas é um ponto a notar.
-    // Criar cópia das transições
-    Transicao* transicoesCopiadas = (Transicao*) malloc(maquinaOriginal->numTransicoes * sizeof(Transicao));
-    for(int i=0;i<maquinaOriginal->numTransicoes;i++){
-        transicoesCopiadas[i].estadoAtual = strcmp(maquinaOriginal->transicoes[i].estadoAtual,"0")==0 ? strdup("inicio") : strdup(maquinaOriginal->transicoes[i].estadoAtual);
-        transicoesCopiadas[i].simboloAtual = strdup(maquinaOriginal->transicoes[i].simboloAtual);
-        transicoesCopiadas[i].novoSimbolo  = strdup(maquinaOriginal->transicoes[i].novoSimbolo);
-        transicoesCopiadas[i].direcao      = maquinaOriginal->transicoes[i].direcao;
-        transicoesCopiadas[i].novoEstado   = strcmp(maquinaOriginal->transicoes[i].novoEstado,"0")==0 ? strdup("inicio") : strdup(maquinaOriginal->transicoes[i].novoEstado);
+// Lê as opções comuns ao modo "verify" e ao pedido verify do servidor (-n, -r, -L, -p, -F, -s, -a, -m, -d).
+// Retorna 1 se argv[*i] era uma delas, avançando *i sobre o valor.
+static int opcao_verificacao(ParametrosVerificacao* p, int argc, char* argv[], int* i) {
+    if (strcmp(argv[*i], "-m") == 0) {
+        p->macropassos = 1;
+        return 1;
+    }
+    if (strcmp(argv[*i], "-d") == 0) {
+        p->fitaDobrada = 1;
+        return 1;
     }
+    if (*i + 1 >= argc) return 0;
+    const char* opcao = argv[*i];
+    const char* valor = argv[*i + 1];
+    if (strcmp(opcao, "-n") == 0) p->comprimentoMaximo = atoi(valor);
+    else if (strcmp(opcao, "-r") == 0) p->numAleatorias = strtoull(valor, NULL, 10);
+    else if (strcmp(opcao, "-L") == 0) p->comprimentoAleatorio = atoi(valor);
+    else if (strcmp(opcao, "-p") == 0) p->limitePassos = strtoull(valor, NULL, 10);
+    else if (strcmp(opcao, "-F") == 0) p->fatorTraduzida = strtoull(valor, NULL, 10);
+    else if (strcmp(opcao, "-s") == 0) p->semente = strtoull(valor, NULL, 10);
+    else if (strcmp(opcao, "-a") == 0) p->alfabeto = valor;
+    else return 0;
+    (*i)++;
+    return 1;
+}
 
-    
-    for (int i = 0; i < maquinaOriginal->numTransicoes; ++i) {
-        Transicao* t = &maquinaOriginal->transicoes[i];
-        if (strcmp(t->estadoAtual, "0") == 0) {
-            free(t->estadoAtual);
-            t->estadoAtual = strdup("inicio");
-        }
-        if (strcmp(t->novoEstado, "0") == 0) {
-            free(t->novoEstado);
-            t->novoEstado = strdup("inicio");
-        }       
+// Modo "verify": compara a máquina original e a traduzida em todas as palavras até um comprimento e em palavras aleatórias
+static int modo_verificar(int argc, char* argv[]) {
+    ParametrosVerificacao parametros;
+    parametros_verificacao_padrao(&parametros);
+    int numThreads = numero_de_nucleos();
+
+    int i = 2;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) numThreads = atoi(argv[++i]);
+        else if (!opcao_verificacao(&parametros, argc, argv, &i)) break;
+    }
+    if (argc - i != 2 || parametros.comprimentoMaximo < 0 || parametros.comprimentoAleatorio < 0) {
+        fprintf(stderr, "Uso: %s verify [-n comprimento] [-r aleatorias] [-L comprimento_aleatorias] [-p passos] [-F fator]\n"
+                        "       [-s semente] [-a alfabeto] [-j threads] [-m] [-d] <maquina_original> <maquina_traduzida>\n", argv[0]);
+        return EXIT_FAILURE;
     }
 
-    MaquinaTuring* maquinaTraduzida = (MaquinaTuring*) malloc(sizeof(MaquinaTuring));
-    if (!maquinaTraduzida) {
-        fprintf(stderr, "ERRO: Falha na alocação de memória para a máquina traduzida.\n");
-        exit(EXIT_FAILURE);
+    MaquinaTuring* original = carregar_maquina(argv[i]);
+    MaquinaTuring* traduzida = original ? carregar_maquina(argv[i + 1]) : NULL;
+    ResultadoVerificacao resultado;
+    Verificacao* v = traduzida ? preparar_verificacao(original, traduzida, &parametros, &resultado) : NULL;
+    if (!v) {
+        fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+        liberar_maquina(original);
+        liberar_maquina(traduzida);
+        return EXIT_FAILURE;
     }
-    maquinaTraduzida->tipo = 'S';
-    maquinaTraduzida->numTransicoes = 0;
-    maquinaTraduzida->capacidadeTransicoes = 2000; // suficiente para muitas regras
-    maquinaTraduzida->transicoes = (Transicao*) malloc(maquinaTraduzida->capacidadeTransicoes * sizeof(Transicao));
-    if (!maquinaTraduzida->transicoes) {
-        fprintf(stderr, "ERRO: Falha na alocação de memória para as transições traduzidas.\n");
-        exit(EXIT_FAILURE);
+    if (numThreads < 1) numThreads = 1;
+
+    printf("-> Verificando %llu palavras sobre o alfabeto {%s} com %d threads...\n",
+           (unsigned long long) resultado.totalPalavras, resultado.alfabeto, numThreads);
+    fflush(stdout);
+    double inicio = relogio_segundos();
+    if (executar_verificacao(v, numThreads, &resultado) != 0) {
+        fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+        liberar_verificacao(v);
+        liberar_maquina(original);
+        liberar_maquina(traduzida);
+        return EXIT_FAILURE;
+    }
+    double duracao = relogio_segundos() - inicio;
+
+    printf("-> %llu palavras verificadas em %.3f s (%.0f palavras/s), %llu inconclusivas (a original não parou em %llu passos).\n",
+           (unsigned long long) resultado.verificadas, duracao, duracao > 0 ? resultado.verificadas / duracao : 0.0,
+           (unsigned long long) resultado.inconclusivas, (unsigned long long) parametros.limitePassos);
+
+    int encontrou = resultado.contraExemplo != UINT64_MAX;
+    if (encontrou) printf("-> Contraexemplo encontrado:\n%s", resultado.relato);
+    else printf("-> Nenhuma divergência encontrada.\n");
+
+    liberar_verificacao(v);
+    liberar_maquina(original);
+    liberar_maquina(traduzida);
+    return encontrou ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Modo "convert": texto -> binário ou binário -> texto, conforme o formato da entrada
+static int modo_converter(int argc, char* argv[]) {
+    if (argc != 4) {
+        fprintf(stderr, "Uso: %s convert <arquivo_de_entrada> <arquivo_de_saida>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    MaquinaTuring* maquina = carregar_maquina(argv[2]);
+    if (!maquina) {
+        fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+        return EXIT_FAILURE;
+    }
+
+    int binariaParaTexto = maquina->regiao != NULL;
+    int resultado = binariaParaTexto ? salvar_maquina(maquina, argv[3]) : salvar_maquina_binaria(maquina, argv[3]);
+    if (resultado != 0) {
+        fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+    } else {
+        fprintf(stderr, "-> Máquina %s convertida para %s (%d transições).\n",
+                binariaParaTexto ? "binária" : "texto", binariaParaTexto ? "texto" : "binário", maquina->numTransicoes);
+    }
+    liberar_maquina(maquina);
+    return resultado == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// === Gerador e benchmark ===
+
+static void parametros_gerador_padrao(ParametrosGerador* p, char tipo) {
+    p->tipo = tipo;
+    p->numEstados = 25000;
+    p->numSimbolos = 4;
+    p->numTransicoes = 100000;  // todos os pares (estado, símbolo), sem regras repetidas
+    p->permitirRepetidos = 0;
+    p->pesoEsquerda = 40;
+    p->pesoDireita = 40;
+    p->pesoParado = 20;
+    p->semente = 1;
+}
+
+// Lê as opções do gerador (-e estados, -a símbolos, -n transições, -R, -m esq:dir:parado, -s semente).
+// Retorna 1 se argv[*i] era uma delas, avançando *i sobre o valor.
+static int opcao_gerador(ParametrosGerador* p, int argc, char* argv[], int* i) {
+    if (strcmp(argv[*i], "-R") == 0) {
+        p->permitirRepetidos = 1;
+        return 1;
     }
+    if (*i + 1 >= argc) return 0;
+    const char* opcao = argv[*i];
+    const char* valor = argv[*i + 1];
+    if (strcmp(opcao, "-e") == 0) p->numEstados = atoi(valor);
+    else if (strcmp(opcao, "-a") == 0) p->numSimbolos = atoi(valor);
+    else if (strcmp(opcao, "-n") == 0) p->numTransicoes = atoi(valor);
+    else if (strcmp(opcao, "-s") == 0) p->semente = strtoull(valor, NULL, 10);
+    else if (strcmp(opcao, "-m") == 0) {
+        if (sscanf(valor, "%d:%d:%d", &p->pesoEsquerda, &p->pesoDireita, &p->pesoParado) != 3) p->pesoEsquerda = -1;
+    }
+    else return 0;
+    (*i)++;
+    return 1;
+}
 
-    printf("-> Traduzindo I -> S (lógica baseada no script Python)...\n");
+// Modo "generate": tradutor generate [-t S|I] [-e estados] [-a simbolos] [-n transicoes] [-R] [-m esq:dir:parado] [-s semente] [-b] <saida>
+static int modo_gerar(int argc, char* argv[]) {
+    ParametrosGerador parametros;
+    parametros_gerador_padrao(&parametros, 'I');
+    int binaria = 0;
+    int i = 2;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (opcao_gerador(&parametros, argc, argv, &i)) continue;
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) parametros.tipo = argv[++i][0];
+        else if (strcmp(argv[i], "-b") == 0) binaria = 1;
+        else break;
+    }
+    if (argc - i != 1) {
+        fprintf(stderr, "Uso: %s generate [-t S|I] [-e estados] [-a simbolos] [-n transicoes] [-R] [-m esq:dir:parado] [-s semente] [-b] <saida>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
 
-    // === Recolher conjunto de estados da maquinaOriginal, garantindo unicidade ===
-    int capEstados = 128;
-    int numEstados = 0;
-    char** estados = (char**) malloc(capEstados * sizeof(char*));
-    if (!estados) { fprintf(stderr, "ERRO: malloc estados\n"); exit(EXIT_FAILURE); }
+    MaquinaTuring* maquina = gerar_maquina(&parametros);
+    int resultado = maquina ? gravar_maquina(maquina, argv[i], binaria, NULL) : -1;
+    if (resultado != 0) fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+    else fprintf(stderr, "-> Máquina ;%c com %d estados, %d símbolos e %d transições gravada em %s.\n", parametros.tipo,
+                 parametros.numEstados, parametros.numSimbolos, maquina->numTransicoes, argv[i]);
+    liberar_maquina(maquina);
+    return resultado == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-    // Primeiro, adicione todos os estados, lidando com a renomeação de '0' para 'inicio'
-    for (int i = 0; i < maquinaOriginal->numTransicoes; ++i) {
-        const Transicao* t = &maquinaOriginal->transicoes[i];
-        const char* current_state_name = t->estadoAtual;
-        const char* next_state_name = t->novoEstado;
+static int comparar_tempos(const void* a, const void* b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
 
-        // Adicionar estado atual se não existe
-        int found_current = 0;
-        for (int j = 0; j < numEstados; ++j) {
-            if (estados[j] && strcmp(estados[j], current_state_name) == 0) { found_current = 1; break; }
+typedef enum { FASE_CARREGAR, FASE_TRADUZIR, FASE_SALVAR } FaseBenchmark;
+
+// Mede uma fase num processo filho, para que o pico de memória (ru_maxrss) seja só o dela: carrega a
+// máquina (e a traduz, para a gravação) fora da medição e repete a fase 'repeticoes' vezes.
+// O filho imprime a linha do CSV; retorna -1 se ele falhou.
+static int medir_fase(FaseBenchmark fase, const char* arquivo, const char* arquivoSaida, int repeticoes, int numThreads) {
+    static const char* const nomesFases[] = { "carregar", "traduzir", "salvar" };
+    fflush(stdout);
+    pid_t filho = fork();
+    if (filho < 0) {
+        fprintf(stderr, "ERRO: fork falhou: %s\n", strerror(errno));
+        return -1;
+    }
+    if (filho > 0) {
+        int status;
+        if (waitpid(filho, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return -1;
+        return 0;
+    }
+
+    double* tempos = (double*) malloc(repeticoes * sizeof(double));
+    MaquinaTuring* maquina = fase == FASE_CARREGAR ? NULL : carregar_maquina(arquivo);
+    MaquinaTuring* traduzida = fase == FASE_SALVAR && maquina ? traduzir_maquina_paralela(maquina, esquemaIparaS, numThreads) : NULL;
+    if (!tempos || (fase != FASE_CARREGAR && !maquina) || (fase == FASE_SALVAR && !traduzida)) {
+        fprintf(stderr, "ERRO: %s\n", tempos ? ultimo_erro() : "Falha na alocação de memória para os tempos.");
+        _exit(EXIT_FAILURE);
+    }
+    char tipo = maquina ? maquina->tipo : '?';
+    int regras = fase == FASE_SALVAR ? traduzida->numTransicoes : (maquina ? maquina->numTransicoes : 0);
+    for (int r = 0; r < repeticoes; r++) {
+        double inicio = relogio_segundos();
+        int falhou;
+        if (fase == FASE_CARREGAR) {
+            MaquinaTuring* carregada = carregar_maquina(arquivo);
+            falhou = !carregada;
+            if (carregada) {
+                tipo = carregada->tipo;
+                regras = carregada->numTransicoes;
+            }
+            tempos[r] = relogio_segundos() - inicio;
+            liberar_maquina(carregada);
+        } else if (fase == FASE_TRADUZIR) {
+            MaquinaTuring* resultado = traduzir_maquina_paralela(maquina, esquemaIparaS, numThreads);
+            falhou = !resultado;
+            tempos[r] = relogio_segundos() - inicio;
+            liberar_maquina(resultado);
+        } else {
+            falhou = salvar_maquina(traduzida, arquivoSaida) != 0;
+            tempos[r] = relogio_segundos() - inicio;
+        }
+        if (falhou) {
+            fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+            _exit(EXIT_FAILURE);
         }
-        if (!found_current) {
-            if (numEstados >= capEstados) {
-                capEstados *= 2;
-                estados = (char**) realloc(estados, capEstados * sizeof(char*));
-                if (!estados) { fprintf(stderr,"ERRO realloc estados\n"); exit(EXIT_FAILURE); }
+    }
+
+    qsort(tempos, repeticoes, sizeof(double), comparar_tempos);
+    double mediana = repeticoes % 2 ? tempos[repeticoes / 2] : (tempos[repeticoes / 2 - 1] + tempos[repeticoes / 2]) / 2;
+    int posicaoP99 = (99 * repeticoes + 99) / 100 - 1; // posição mais próxima: teto(0,99 n) - 1
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    printf("%s,%c,%s,%d,%d,%d,%.6f,%.6f,%.0f,%ld\n", arquivo, tipo, nomesFases[fase], fase == FASE_CARREGAR ? 1 : numThreads,
+           regras, repeticoes, mediana, tempos[posicaoP99], mediana > 0 ? regras / mediana : 0.0, uso.ru_maxrss);
+    fflush(stdout);
+    _exit(EXIT_SUCCESS);
+}
+
+// Modo "bench": tradutor bench [-r repeticoes] [-j threads] [-d|-c] [opções do gerador] [maquina...]
+// Sem máquinas, gera uma ;S e uma ;I com as opções do gerador. Para cada máquina mede a carga, a
+// tradução e a gravação da traduzida, e imprime uma linha CSV por fase.
+static int modo_benchmark(int argc, char* argv[]) {
+    ParametrosGerador parametros;
+    parametros_gerador_padrao(&parametros, 'S');
+    int repeticoes = 10;
+    int numThreads = 1;
+    int i = 2;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (opcao_gerador(&parametros, argc, argv, &i)) continue;
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) repeticoes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-d") == 0) esquemaIparaS = ESQUEMA_DOBRADO;
+        else if (strcmp(argv[i], "-c") == 0) esquemaIparaS = ESQUEMA_COMPARTILHADO;
+        else break;
+    }
+    if (i < argc && argv[i][0] == '-' && argv[i][1] != '\0') {
+        fprintf(stderr, "Uso: %s bench [-r repeticoes] [-j threads] [-d|-c] [-e estados] [-a simbolos] [-n transicoes] [-R] "
+                "[-m esq:dir:parado] [-s semente] [maquina...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (repeticoes < 1) repeticoes = 1;
+    if (numThreads < 1) numThreads = 1;
+
+    // Diretório temporário para as máquinas geradas e para as gravações
+    char diretorio[] = "/tmp/tradutor_bench_XXXXXX";
+    if (!mkdtemp(diretorio)) {
+        fprintf(stderr, "ERRO: Não foi possível criar o diretório temporário: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    char arquivoSaida[64], geradas[2][64];
+    snprintf(arquivoSaida, sizeof(arquivoSaida), "%s/saida.out", diretorio);
+    int numGeradas = 0;
+    if (i == argc) {
+        for (int t = 0; t < 2; t++) {
+            parametros.tipo = t == 0 ? 'S' : 'I';
+            snprintf(geradas[t], sizeof(geradas[t]), "%s/gerada_%c.in", diretorio, parametros.tipo);
+            MaquinaTuring* maquina = gerar_maquina(&parametros);
+            if (!maquina || salvar_maquina(maquina, geradas[t]) != 0) {
+                fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+                liberar_maquina(maquina);
+                break;
             }
-            estados[numEstados++] = strdup(current_state_name);
+            liberar_maquina(maquina);
+            numGeradas++;
         }
+        fprintf(stderr, "-> Máquinas geradas: %d estados, %d símbolos, %d transições, movimentos %d:%d:%d.\n", parametros.numEstados,
+                parametros.numSimbolos, parametros.numTransicoes, parametros.pesoEsquerda, parametros.pesoDireita, parametros.pesoParado);
+    }
 
-        // Adicionar próximo estado se não existe
-        int found_next = 0;
-        for (int j = 0; j < numEstados; ++j) {
-            if (estados[j] && strcmp(estados[j], next_state_name) == 0) { found_next = 1; break; }
+    int falhas = numGeradas < 2 && i == argc;
+    printf("arquivo,tipo,fase,threads,regras,repeticoes,mediana_s,p99_s,regras_por_s,pico_rss_kb\n");
+    int numMaquinas = i == argc ? numGeradas : argc - i;
+    for (int m = 0; m < numMaquinas; m++) {
+        const char* arquivo = i == argc ? geradas[m] : argv[i + m];
+        for (int fase = FASE_CARREGAR; fase <= FASE_SALVAR; fase++) {
+            if (medir_fase((FaseBenchmark) fase, arquivo, arquivoSaida, repeticoes, numThreads) != 0) falhas++;
         }
-        if (!found_next) {
-            if (numEstados >= capEstados) {
-                capEstados *= 2;
-                estados = (char**) realloc(estados, capEstados * sizeof(char*));
-                if (!estados) { fprintf(stderr,"ERRO realloc estados\n"); exit(EXIT_FAILURE); }
-            }
-            estados[numEstados++] = strdup(next_state_name);
-        }
-    }
-    // Agora 'estados' contém uma lista única de todos os estados (onde '0' já foi renomeado para 'inicio')
-    // --- FIM: Parte de inicialização e coleta de estados ---
-
-
-    // === Agora construir as transicoes pre-processamento ===
-    printf("-> Adicionando transições de pré-processamento...\n");
-    // O estado '0' é o estado inicial real da MT de Sipser.
-    // Ele vai varrer a entrada, marcando-a e configurando a fita para o formato '# [neg] * [pos] &'
-    
-    // As transições de setup que você tinha originalmente para '0', '1_0', '1_1', etc.
-    // Esta parte do setup é complexa. Vou reintroduzir o setup que você tinha,
-    // mas com o cuidado de não usar 's' nas transições intermediárias.
-
-    adicionar_transicao(maquinaTraduzida, "0", "0", "#", 'r', "1_0");
-    adicionar_transicao(maquinaTraduzida, "0", "1", "#", 'r', "1_1");
-    adicionar_transicao(maquinaTraduzida, "0", "_", "*", 'r', "inicio"); // Se a fita é vazia, coloca '*' e vai para 'inicio'
-
-    adicionar_transicao(maquinaTraduzida, "1_0", "0", "0", 'r', "1_0");
-    adicionar_transicao(maquinaTraduzida, "1_0", "1", "0", 'r', "1_1");
-    adicionar_transicao(maquinaTraduzida, "1_0", "_", "0", 'r', "1__");
-
-    adicionar_transicao(maquinaTraduzida, "1_1", "0", "1", 'r', "1_0");
-    adicionar_transicao(maquinaTraduzida, "1_1", "1", "1", 'r', "1_1");
-    adicionar_transicao(maquinaTraduzida, "1_1", "_", "1", 'r', "1__");
-
-    adicionar_transicao(maquinaTraduzida, "1__", "_", "&", 'l', "2_");
-
-    adicionar_transicao(maquinaTraduzida, "2_", "#", "#", 'r', "inicio");
-    adicionar_transicao(maquinaTraduzida, "2_", "*", "*", 'l', "2_"); // Move para a esquerda até '#'
-
-    // === FASE 1: Traduzir cada transição original da maquinaOriginal ===
-    printf("-> Criando regras para cada transição da máquina Duplamente Infinita original...\n");
-    for (int i = 0; i < maquinaOriginal->numTransicoes; ++i) {
-        const Transicao* t = &maquinaOriginal->transicoes[i];
-
-        const char* estadoAtualMapeado = t->estadoAtual; 
-        const char* novoEstadoMapeado = t->novoEstado;
-        
-        char estadoAuxMovimento[512]; // Estado auxiliar para simular movimento e escrita
-
-        // Transição: (estadoAtualMapeado, simboloAtual) -> (novoSimbolo, direcao, novoEstadoMapeado)
-
-        if (t->direcao == 's') { // Simular direção 's' (stay/parar)
-            // Passo 1: Escreve o novo símbolo e move para a direita (temporariamente)
-            snprintf(estadoAuxMovimento, sizeof(estadoAuxMovimento), "%s_stay_aux_R_%s_sym_%s_new_sym_%s",
-                     estadoAtualMapeado, novoEstadoMapeado, t->simboloAtual, t->novoSimbolo);
-            adicionar_transicao(maquinaTraduzida, estadoAtualMapeado, t->simboloAtual, t->novoSimbolo, 'r', estadoAuxMovimento);
-
-            // Passo 2: Do estado auxiliar, move para a esquerda para o novo estado (completando o "stay")
-            // Precisa de regras para todos os símbolos possíveis na fita
-            adicionar_transicao(maquinaTraduzida, estadoAuxMovimento, "0", "0", 'l', novoEstadoMapeado);
-            adicionar_transicao(maquinaTraduzida, estadoAuxMovimento, "1", "1", 'l', novoEstadoMapeado);
-            adicionar_transicao(maquinaTraduzida, estadoAuxMovimento, "_", "_", 'l', novoEstadoMapeado);
-            adicionar_transicao(maquinaTraduzida, estadoAuxMovimento, "#", "#", 'l', novoEstadoMapeado);
-            adicionar_transicao(maquinaTraduzida, estadoAuxMovimento, "&", "&", 'l', novoEstadoMapeado);
-            adicionar_transicao(maquinaTraduzida, estadoAuxMovimento, "*", "*", 'l', novoEstadoMapeado);
-
-        } else if (t->direcao == 'r') { // Mover para a direita
-            // Regra principal para mover para a direita: escreve novo símbolo e move 'r'
-            adicionar_transicao(maquinaTraduzida, estadoAtualMapeado, t->simboloAtual, t->novoSimbolo, 'r', novoEstadoMapeado);
-            
-            // Regra especial: se o movimento para a direita encontra o marcador '&', a fita precisa ser estendida (shift)
-            char estadoShiftAmpWriteSym[512]; // Estado para escrever o novo símbolo no lugar de '&'
-            char estadoReturnAfterAmpShift[512]; // Estado para o retorno após o shift (cabeçote está em '_', ex-&, antes de ir para o novo estado)
-
-            snprintf(estadoShiftAmpWriteSym, sizeof(estadoShiftAmpWriteSym), "%s_shift_amp_write_%s", 
-                     estadoAtualMapeado, t->novoSimbolo); 
-            snprintf(estadoReturnAfterAmpShift, sizeof(estadoReturnAfterAmpShift), "%s_return_after_amp_shift", 
-                     novoEstadoMapeado); 
-
-            // 1. Se encontra '&', escreve o novo símbolo (t->novoSimbolo), e move para a direita para encontrar o blank
-            adicionar_transicao(maquinaTraduzida, estadoAtualMapeado, "&", t->novoSimbolo, 'r', estadoShiftAmpWriteSym); 
-            
-            // 2. No estado `estadoShiftAmpWriteSym`, quando encontra um blank `_`, escreve `&`, move para a esquerda e vai para o estado de retorno
-            adicionar_transicao(maquinaTraduzida, estadoShiftAmpWriteSym, "_", "&", 'l', estadoReturnAfterAmpShift);
-
-            // 3. No estado de retorno, o cabeçote está na posição onde antes estava o '&' (agora `_`).
-            // Ele "permanece" para simular a chegada no estado `novoEstadoMapeado` lendo `_`.
-            // Ou seja, a fita foi estendida, e o cabeçote está na célula que a MT original veria como a "próxima"
-            adicionar_transicao(maquinaTraduzida, estadoReturnAfterAmpShift, "_", "_", 's', novoEstadoMapeado);
-
-
-        } else if (t->direcao == 'l') { // Mover para a esquerda
-            // Regra principal para mover para a esquerda: escreve novo símbolo e move 'l'
-            adicionar_transicao(maquinaTraduzida, estadoAtualMapeado, t->simboloAtual, t->novoSimbolo, 'l', novoEstadoMapeado);
-            
-            // Regra especial: se o movimento para a esquerda encontra o marcador '#', a fita precisa ser estendida (shift)
-            char q1_hash_novoEstado[512];
-            snprintf(q1_hash_novoEstado, sizeof(q1_hash_novoEstado), "q1___%s", novoEstadoMapeado); // Reutilizando a lógica de q1___e para o shift
-            adicionar_transicao(maquinaTraduzida, estadoAtualMapeado, "#", t->novoSimbolo, 'r', q1_hash_novoEstado); // Move 'r' para iniciar o shift para '#'
-            
-            // NOVO: Adicionar uma transição para quando uma regra de movimento 'l' tenta escrever '&' no lugar de '&'
-            // Exemplo da sua entrada: `1 _ F l 2` se torna `1 _ & l 2`.
-            // Se o `simboloAtual` é `&` e `novoSimbolo` também é `&`, e a direção é `l`, precisamos tratar isso.
-            if (strcmp(t->simboloAtual, "&") == 0 && strcmp(t->novoSimbolo, "&") == 0) {
-                // Esta é uma regra que simula uma "autotransição" no '&' com movimento 'l'
-                // A ação é a mesma que quando a MT tenta mover para a esquerda e encontra '#':
-                // a fita toda precisa ser "deslocada" para a direita, e o cabeçote retorna para a posição.
-                // Reutilizamos a sub-rotina de shift (`q1___e`) para isso.
-                adicionar_transicao(maquinaTraduzida, estadoAtualMapeado, "&", "&", 'r', q1_hash_novoEstado); // Move 'r' para iniciar o shift (com o novo estado 'q1_hash_novoEstado')
-            }
+    }
+
+    for (int t = 0; t < numGeradas; t++) unlink(geradas[t]);
+    unlink(arquivoSaida);
+    rmdir(diretorio);
+    return falhas ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// === Modo servidor ===
+// Processo persistente que atende pedidos de uma linha (translate, run, verify, stats), lidos da
+// entrada padrão ou de clientes conectados a um socket Unix. As máquinas interpretadas e as traduções
+// serializadas ficam em um cache LRU indexado pelo hash do conteúdo do arquivo de entrada, com um
+// limite de memória; um pedido repetido não reinterpreta nem retraduz a máquina.
+
+#define BALDES_CACHE 4096
+#define FILA_CONEXOES 256
+#define MAXIMO_TOKENS_PEDIDO 32
+// Limites de um pedido: um cliente não pode pedir fitas, espaços de palavras ou execuções sem limite,
+// que prenderiam uma thread do servidor por horas e, com poucos pedidos assim, todos os outros clientes
+#define COMPRIMENTO_MAXIMO_PEDIDO 16
+#define COMPRIMENTO_ALEATORIO_MAXIMO_PEDIDO 4096
+#define ALEATORIAS_MAXIMO_PEDIDO 1000000ULL
+#define PASSOS_VERIFICACAO_MAXIMO_PEDIDO 1000000ULL  // -p de verify, por palavra
+#define FATOR_MAXIMO_PEDIDO 1000ULL
+#define PASSOS_MAXIMO_PEDIDO 1000000000ULL           // -p de run
+
+typedef struct EntradaCache {
+    uint64_t hash[2];          // hash do conteúdo do arquivo, com duas sementes
+    uint64_t variante;         // 0 para a máquina interpretada; opções + 1 para uma tradução
+    size_t custo;              // bytes contabilizados no limite de memória
+    MaquinaTuring* maquina;    // variante 0: a máquina (só lida pelos pedidos, nunca modificada)
+    char* dados;               // tradução: a máquina traduzida já serializada
+    size_t tamanhoDados;
+    int numTransicoes;
+    int referencias;           // pedidos usando a entrada agora
+    int removida;              // saiu do cache; o último pedido que a usava a libera
+    struct EntradaCache* maisNova;
+    struct EntradaCache* maisAntiga;
+    struct EntradaCache* proximaNoBalde;
+} EntradaCache;
+
+typedef struct {
+    pthread_mutex_t trava;
+    EntradaCache* baldes[BALDES_CACHE];
+    EntradaCache* maisNova;    // início da lista LRU
+    EntradaCache* maisAntiga;  // fim da lista: a próxima a sair
+    int numEntradas;
+    size_t usados;
+    size_t limite;
+    uint64_t acertos;
+    uint64_t faltas;
+    uint64_t despejos;
+} CacheServidor;
+
+// Hash de 64 bits do conteúdo, em blocos de 8 bytes. Duas sementes dão a chave de 128 bits do cache.
+static uint64_t hash_conteudo(const char* dados, size_t tamanho, uint64_t semente) {
+    uint64_t h = hash_chave(semente ^ tamanho);
+    size_t i = 0;
+    for (; i + 8 <= tamanho; i += 8) {
+        uint64_t bloco;
+        memcpy(&bloco, dados + i, 8);
+        h = hash_chave(h ^ bloco) + 0x9e3779b97f4a7c15ULL;
+    }
+    uint64_t resto = 0;
+    memcpy(&resto, dados + i, tamanho - i);
+    return hash_chave(h ^ resto);
+}
+
+// Memória ocupada por uma máquina: transições, arena, tabelas de nomes e a região binária
+static size_t custo_maquina(const MaquinaTuring* maquina) {
+    size_t custo = sizeof(MaquinaTuring) + maquina->arena.capacidade + maquina->tamanhoRegiao;
+    custo += (size_t) maquina->capacidadeTransicoes * sizeof(Transicao);
+    const TabelaNomes* tabelas[2] = { &maquina->estados, &maquina->simbolos };
+    for (int t = 0; t < 2; t++) {
+        custo += (size_t) tabelas[t]->capacidadeNomes * 2 * sizeof(uint32_t);
+        custo += (size_t) tabelas[t]->capacidadeIndice * sizeof(uint32_t);
+    }
+    return custo;
+}
+
+static void entrada_cache_liberar(EntradaCache* entrada) {
+    liberar_maquina(entrada->maquina);
+    free(entrada->dados);
+    free(entrada);
+}
+
+static EntradaCache** balde_cache(CacheServidor* cache, const uint64_t hash[2], uint64_t variante) {
+    return &cache->baldes[hash_chave(hash[0] ^ variante) & (BALDES_CACHE - 1)];
+}
+
+static void lru_remover(CacheServidor* cache, EntradaCache* entrada) {
+    if (entrada->maisNova) entrada->maisNova->maisAntiga = entrada->maisAntiga;
+    else cache->maisNova = entrada->maisAntiga;
+    if (entrada->maisAntiga) entrada->maisAntiga->maisNova = entrada->maisNova;
+    else cache->maisAntiga = entrada->maisNova;
+}
+
+static void lru_inserir_na_frente(CacheServidor* cache, EntradaCache* entrada) {
+    entrada->maisNova = NULL;
+    entrada->maisAntiga = cache->maisNova;
+    if (cache->maisNova) cache->maisNova->maisNova = entrada;
+    else cache->maisAntiga = entrada;
+    cache->maisNova = entrada;
+}
+
+// Tira a entrada do cache; ela é liberada agora ou quando o último pedido que a usa terminar
+static void cache_despejar(CacheServidor* cache, EntradaCache* entrada) {
+    EntradaCache** p = balde_cache(cache, entrada->hash, entrada->variante);
+    while (*p != entrada) p = &(*p)->proximaNoBalde;
+    *p = entrada->proximaNoBalde;
+    lru_remover(cache, entrada);
+    cache->usados -= entrada->custo;
+    cache->numEntradas--;
+    cache->despejos++;
+    entrada->removida = 1;
+    if (entrada->referencias == 0) entrada_cache_liberar(entrada);
+}
+
+// Procura (hash, variante) e, se achar, marca a entrada como em uso e como a mais recente
+static EntradaCache* cache_buscar(CacheServidor* cache, const uint64_t hash[2], uint64_t variante) {
+    pthread_mutex_lock(&cache->trava);
+    EntradaCache* entrada = *balde_cache(cache, hash, variante);
+    while (entrada && (entrada->hash[0] != hash[0] || entrada->hash[1] != hash[1] || entrada->variante != variante)) {
+        entrada = entrada->proximaNoBalde;
+    }
+    if (entrada) {
+        entrada->referencias++;
+        lru_remover(cache, entrada);
+        lru_inserir_na_frente(cache, entrada);
+        cache->acertos++;
+    } else {
+        cache->faltas++;
+    }
+    pthread_mutex_unlock(&cache->trava);
+    return entrada;
+}
+
+// Insere uma entrada nova (já em uso por quem a criou) e despeja as mais antigas até caber no limite.
+// Se outro pedido inseriu a mesma chave antes, a nova é descartada e a existente é retornada.
+static EntradaCache* cache_inserir(CacheServidor* cache, EntradaCache* nova) {
+    pthread_mutex_lock(&cache->trava);
+    EntradaCache** balde = balde_cache(cache, nova->hash, nova->variante);
+    for (EntradaCache* e = *balde; e; e = e->proximaNoBalde) {
+        if (e->hash[0] == nova->hash[0] && e->hash[1] == nova->hash[1] && e->variante == nova->variante) {
+            e->referencias++;
+            pthread_mutex_unlock(&cache->trava);
+            entrada_cache_liberar(nova);
+            return e;
         }
     }
+    nova->referencias = 1;
+    nova->proximaNoBalde = *balde;
+    *balde = nova;
+    lru_inserir_na_frente(cache, nova);
+    cache->usados += nova->custo;
+    cache->numEntradas++;
+    while (cache->usados > cache->limite && cache->maisAntiga) cache_despejar(cache, cache->maisAntiga);
+    pthread_mutex_unlock(&cache->trava);
+    return nova;
+}
 
-    // === FASE 2: Gerar as sub-rotinas de shift ===
-    printf("-> Gerando sub-rotinas de shift para cada estado...\n");
-    for (int idx = 0; idx < numEstados; ++idx) {
-        const char* e = estados[idx]; 
+static void cache_soltar(CacheServidor* cache, EntradaCache* entrada) {
+    if (!entrada) return;
+    pthread_mutex_lock(&cache->trava);
+    int liberar = --entrada->referencias == 0 && entrada->removida;
+    pthread_mutex_unlock(&cache->trava);
+    if (liberar) entrada_cache_liberar(entrada);
+}
 
-        // Declarações movedas para dentro do loop para garantir que existam para cada 'e'
-        char nome_q1___e[512];
-        char nome_q1_0_e[512], nome_q1_1_e[512], nome_q1_amp_e[512]; // Alterado F para amp
-        char nome_q2e[512];
-        char nome_q_amp_e[512]; // Alterado F para amp
+// Lê o arquivo inteiro para a memória e calcula a chave do seu conteúdo
+static char* ler_arquivo_inteiro(const char* nomeArquivo, size_t* tamanho, uint64_t hash[2], char* erro, size_t tamanhoErro) {
+    FILE* arquivo = fopen(nomeArquivo, "rb");
+    if (!arquivo) {
+        snprintf(erro, tamanhoErro, "Não foi possível abrir o arquivo '%s': %s", nomeArquivo, strerror(errno));
+        return NULL;
+    }
+    size_t capacidade = 1 << 16, usados = 0;
+    char* dados = (char*) malloc(capacidade);
+    while (dados) {
+        usados += fread(dados + usados, 1, capacidade - usados, arquivo);
+        if (usados < capacidade) break;
+        capacidade *= 2;
+        char* maior = (char*) realloc(dados, capacidade);
+        if (!maior) free(dados);
+        dados = maior;
+    }
+    int falhou = !dados || ferror(arquivo);
+    fclose(arquivo);
+    if (falhou) {
+        snprintf(erro, tamanhoErro, "Falha ao ler o arquivo '%s'.", nomeArquivo);
+        free(dados);
+        return NULL;
+    }
+    *tamanho = usados;
+    hash[0] = hash_conteudo(dados, usados, 0x243f6a8885a308d3ULL);
+    hash[1] = hash_conteudo(dados, usados, 0x13198a2e03707344ULL);
+    return dados;
+}
 
-        snprintf(nome_q1___e, sizeof(nome_q1___e), "q1___%s", e);
-        snprintf(nome_q1_0_e, sizeof(nome_q1_0_e), "q1_0_%s", e);
-        snprintf(nome_q1_1_e, sizeof(nome_q1_1_e), "q1_1_%s", e);
-        snprintf(nome_q1_amp_e, sizeof(nome_q1_amp_e), "q1_amp_%s", e); // Renomeado
-        snprintf(nome_q2e, sizeof(nome_q2e), "q2%s", e);
-        snprintf(nome_q_amp_e, sizeof(nome_q_amp_e), "q_amp%s", e); // Renomeado
+// Máquina interpretada a partir de 'dados' (conteúdo do arquivo com a chave 'hash'), do cache se possível.
+// O servidor aceita arquivos binários de qualquer cliente porque ler_maquina confere nomes e transições
+// antes de usá-los: um arquivo corrompido vira uma resposta ERRO, não uma queda do servidor.
+static EntradaCache* obter_maquina_de_dados(CacheServidor* cache, const char* dados, size_t tamanho, const uint64_t hash[2],
+                                            char* erro, size_t tamanhoErro) {
+    EntradaCache* entrada = cache_buscar(cache, hash, 0);
+    if (entrada) return entrada;
+
+    MaquinaTuring* maquina = ler_maquina(dados, tamanho);
+    entrada = maquina ? (EntradaCache*) calloc(1, sizeof(EntradaCache)) : NULL;
+    if (!entrada) {
+        snprintf(erro, tamanhoErro, "%s", maquina ? "Falha na alocação de memória para o cache." : ultimo_erro());
+        liberar_maquina(maquina);
+        return NULL;
+    }
+    entrada->hash[0] = hash[0];
+    entrada->hash[1] = hash[1];
+    entrada->maquina = maquina;
+    entrada->numTransicoes = maquina->numTransicoes;
+    entrada->custo = sizeof(EntradaCache) + custo_maquina(maquina);
+    return cache_inserir(cache, entrada);
+}
 
+static EntradaCache* obter_maquina(CacheServidor* cache, const char* nomeArquivo, char* erro, size_t tamanhoErro) {
+    size_t tamanho;
+    uint64_t hash[2];
+    char* dados = ler_arquivo_inteiro(nomeArquivo, &tamanho, hash, erro, tamanhoErro);
+    if (!dados) return NULL;
+    EntradaCache* entrada = obter_maquina_de_dados(cache, dados, tamanho, hash, erro, tamanhoErro);
+    free(dados);
+    return entrada;
+}
 
-        // Estes estados (q1_0_e, q1_1_e, q1___e) são para o "shift right" da fita.
-        adicionar_transicao(maquinaTraduzida, nome_q1_0_e, "0", "0", 'r', nome_q1_0_e);
-        adicionar_transicao(maquinaTraduzida, nome_q1_0_e, "1", "0", 'r', nome_q1_1_e);
-        adicionar_transicao(maquinaTraduzida, nome_q1_0_e, "_", "0", 'r', nome_q1___e); 
-        adicionar_transicao(maquinaTraduzida, nome_q1_0_e, "&", "0", 'r', nome_q1_amp_e); // Alterado F para &
-        adicionar_transicao(maquinaTraduzida, nome_q1_0_e, "*", "0", 'r', "q1_star_0"); 
+static int gravar_dados(const char* nomeArquivo, const char* dados, size_t tamanho, char* erro, size_t tamanhoErro) {
+    FILE* arquivo = fopen(nomeArquivo, "wb");
+    if (!arquivo) {
+        snprintf(erro, tamanhoErro, "Não foi possível criar o arquivo '%s': %s", nomeArquivo, strerror(errno));
+        return -1;
+    }
+    int falhou = fwrite(dados, 1, tamanho, arquivo) != tamanho;
+    if (fclose(arquivo) != 0) falhou = 1;
+    if (falhou) snprintf(erro, tamanhoErro, "Falha ao gravar o arquivo '%s'.", nomeArquivo);
+    return falhou ? -1 : 0;
+}
 
-        adicionar_transicao(maquinaTraduzida, nome_q1_1_e, "0", "1", 'r', nome_q1_0_e);
-        adicionar_transicao(maquinaTraduzida, nome_q1_1_e, "1", "1", 'r', nome_q1_1_e);
-        adicionar_transicao(maquinaTraduzida, nome_q1_1_e, "_", "1", 'r', nome_q1___e); 
-        adicionar_transicao(maquinaTraduzida, nome_q1_1_e, "&", "1", 'r', nome_q1_amp_e); // Alterado F para &
-        adicionar_transicao(maquinaTraduzida, nome_q1_1_e, "*", "1", 'r', "q1_star_1"); 
+static const char* codigo_motivo(MotivoFim motivo) {
+    switch (motivo) {
+        case MOTIVO_PARADA:      return "parada";
+        case MOTIVO_SEM_REGRA:   return "sem_regra";
+        case MOTIVO_SEM_MEMORIA: return "sem_memoria";
+        default:                 return "limite";
+    }
+}
 
-        adicionar_transicao(maquinaTraduzida, nome_q1___e, "0", "_", 'r', nome_q1_0_e);
-        adicionar_transicao(maquinaTraduzida, nome_q1___e, "1", "_", 'r', nome_q1_1_e);
-        adicionar_transicao(maquinaTraduzida, nome_q1___e, "_", "_", 'r', nome_q1___e); // Loop para mover blanks
-        adicionar_transicao(maquinaTraduzida, nome_q1___e, "&", "_", 'r', nome_q1_amp_e); // Alterado F para &
-        adicionar_transicao(maquinaTraduzida, nome_q1___e, "*", "_", 'r', "q1_star_blank"); 
+// translate [-b] [-d|-c] [-O] [-M] <entrada> <saida>
+static void pedido_traduzir(CacheServidor* cache, char** tokens, int numTokens, FILE* saida) {
+    char erro[600];
+    int binaria = 0, otimizar = 0, minimizar = 0;
+    EsquemaIparaS esquema = ESQUEMA_DESLOCAMENTO;
+    int i = 1;
+    for (; i < numTokens && tokens[i][0] == '-'; i++) {
+        if (strcmp(tokens[i], "-b") == 0) binaria = 1;
+        else if (strcmp(tokens[i], "-O") == 0) otimizar = 1;
+        else if (strcmp(tokens[i], "-M") == 0) minimizar = 1;
+        else if (strcmp(tokens[i], "-d") == 0) esquema = ESQUEMA_DOBRADO;
+        else if (strcmp(tokens[i], "-c") == 0) esquema = ESQUEMA_COMPARTILHADO;
+        else break;
+    }
+    if (numTokens - i != 2) {
+        fprintf(saida, "ERRO Uso: translate [-b] [-d|-c] [-O] [-M] <entrada> <saida>\n");
+        return;
+    }
 
-        // q1_amp_e -> quando o shift atinge o '&' final.
-        adicionar_transicao(maquinaTraduzida, nome_q1_amp_e, "*", "&", 'l', nome_q2e); // Se lê '*', escreve '&', volta para iniciar o re-posicionamento
-        adicionar_transicao(maquinaTraduzida, nome_q1_amp_e, "_", "&", 'l', nome_q2e); // Se encontra blank, escreve '&', volta. 
+    size_t tamanho;
+    uint64_t hash[2];
+    char* dados = ler_arquivo_inteiro(tokens[i], &tamanho, hash, erro, sizeof(erro));
+    if (!dados) {
+        fprintf(saida, "ERRO %s\n", erro);
+        return;
+    }
+    uint64_t variante = 1 + ((uint64_t) esquema | (uint64_t) otimizar << 2 | (uint64_t) minimizar << 3 | (uint64_t) binaria << 4);
+    EntradaCache* traducao = cache_buscar(cache, hash, variante);
+    int doCache = traducao != NULL;
+    if (!traducao) {
+        EntradaCache* original = obter_maquina_de_dados(cache, dados, tamanho, hash, erro, sizeof(erro));
+        MaquinaTuring* traduzida = original ? traduzir_com_opcoes(original->maquina, esquema, otimizar, minimizar) : NULL;
+        if (original && !traduzida) snprintf(erro, sizeof(erro), "%s", ultimo_erro());
+        cache_soltar(cache, original);
+
+        EntradaCache* nova = traduzida ? (EntradaCache*) calloc(1, sizeof(EntradaCache)) : NULL;
+        if (traduzida && (!nova || serializar_maquina(traduzida, binaria, &nova->dados, &nova->tamanhoDados) != 0)) {
+            snprintf(erro, sizeof(erro), "%s", nova ? ultimo_erro() : "Falha na alocação de memória para o cache.");
+            free(nova);
+            nova = NULL;
+        }
+        if (nova) {
+            nova->hash[0] = hash[0];
+            nova->hash[1] = hash[1];
+            nova->variante = variante;
+            nova->numTransicoes = traduzida->numTransicoes;
+            nova->custo = sizeof(EntradaCache) + nova->tamanhoDados;
+            traducao = cache_inserir(cache, nova);
+        }
+        liberar_maquina(traduzida);
+    }
+    free(dados);
+    if (!traducao) {
+        fprintf(saida, "ERRO %s\n", erro);
+        return;
+    }
 
-        // q1_star_X estados: para lidar com o marcador '*'.
-        // q1_star_0 (estava segurando '0', encontrou '*') -> escreve '0', move 'r', guarda '*'
-        adicionar_transicao(maquinaTraduzida, "q1_star_0", "0", "*", 'r', nome_q1_0_e);
-        adicionar_transicao(maquinaTraduzida, "q1_star_0", "1", "*", 'r', nome_q1_1_e);
-        adicionar_transicao(maquinaTraduzida, "q1_star_0", "_", "*", 'r', nome_q1___e);
-        adicionar_transicao(maquinaTraduzida, "q1_star_0", "&", "*", 'r', nome_q1_amp_e); // Alterado F para &
+    if (gravar_dados(tokens[i + 1], traducao->dados, traducao->tamanhoDados, erro, sizeof(erro)) != 0) {
+        fprintf(saida, "ERRO %s\n", erro);
+    } else {
+        fprintf(saida, "OK transicoes=%d cache=%d\n", traducao->numTransicoes, doCache);
+    }
+    cache_soltar(cache, traducao);
+}
 
-        adicionar_transicao(maquinaTraduzida, "q1_star_1", "0", "*", 'r', nome_q1_0_e);
-        adicionar_transicao(maquinaTraduzida, "q1_star_1", "1", "*", 'r', nome_q1_1_e);
-        adicionar_transicao(maquinaTraduzida, "q1_star_1", "_", "*", 'r', nome_q1___e);
-        adicionar_transicao(maquinaTraduzida, "q1_star_1", "&", "*", 'r', nome_q1_amp_e); // Alterado F para &
+// run [-p limite] [-i estado] [-f] [-m] <maquina> [palavra]
+static void pedido_executar(CacheServidor* cache, char** tokens, int numTokens, FILE* saida) {
+    char erro[600];
+    uint64_t limitePassos = 100000000ULL;
+    const char* estadoInicial = "0";
+    int fitaInfinita = 0, macropassos = 0;
+    int i = 1;
+    for (; i < numTokens && tokens[i][0] == '-'; i++) {
+        if (strcmp(tokens[i], "-p") == 0 && i + 1 < numTokens) limitePassos = strtoull(tokens[++i], NULL, 10);
+        else if (strcmp(tokens[i], "-i") == 0 && i + 1 < numTokens) estadoInicial = tokens[++i];
+        else if (strcmp(tokens[i], "-f") == 0) fitaInfinita = 1;
+        else if (strcmp(tokens[i], "-m") == 0) macropassos = 1;
+        else break;
+    }
+    if (i >= numTokens || numTokens - i > 2) {
+        fprintf(saida, "ERRO Uso: run [-p limite_de_passos] [-i estado_inicial] [-f] [-m] <maquina> [palavra]\n");
+        return;
+    }
+    if (limitePassos > PASSOS_MAXIMO_PEDIDO) {
+        fprintf(saida, "ERRO No servidor, -p vai até %llu.\n", PASSOS_MAXIMO_PEDIDO);
+        return;
+    }
+    const char* palavra = i + 1 < numTokens ? tokens[i + 1] : "";
+
+    EntradaCache* entrada = obter_maquina(cache, tokens[i], erro, sizeof(erro));
+    if (!entrada) {
+        fprintf(saida, "ERRO %s\n", erro);
+        return;
+    }
+    ProgramaCompilado* programa = compilar_maquina(entrada->maquina, palavra, estadoInicial);
+    Fita fita = { NULL, 0, 0, 0 };
+    if (!programa || fita_iniciar(&fita, programa, palavra) != 0) {
+        fprintf(saida, "ERRO %s\n", ultimo_erro());
+    } else {
+        if (fitaInfinita) programa->semiInfinita = 0;
+        if (macropassos) acelerar_programa(programa); // sem memória para os macropassos, roda passo a passo
+        ResultadoExecucao resultado = executar_programa(programa, &fita, limitePassos);
+        fprintf(saida, "OK estado=%s motivo=%s passos=%llu fita=", nome_estado(entrada->maquina, resultado.estadoFinal),
+                codigo_motivo(resultado.motivo), (unsigned long long) resultado.passos);
+        fita_escrever(&fita, programa, saida);
+        fputc('\n', saida);
+    }
+    fita_liberar(&fita);
+    liberar_programa(programa);
+    cache_soltar(cache, entrada);
+}
+
+// verify [-n comprimento] [-r aleatorias] [-L comprimento_aleatorias] [-p passos] [-F fator] [-s semente] [-a alfabeto] [-m]
+//        [-d] <maquina_original> <maquina_traduzida>
+// Roda na própria thread do pedido: o paralelismo do servidor está entre os clientes.
+static void pedido_verificar(CacheServidor* cache, char** tokens, int numTokens, FILE* saida) {
+    char erro[600];
+    ParametrosVerificacao parametros;
+    parametros_verificacao_padrao(&parametros);
+    int i = 1;
+    for (; i < numTokens && tokens[i][0] == '-'; i++) {
+        if (!opcao_verificacao(&parametros, numTokens, tokens, &i)) break;
+    }
+    if (parametros.comprimentoMaximo > COMPRIMENTO_MAXIMO_PEDIDO || parametros.comprimentoAleatorio > COMPRIMENTO_ALEATORIO_MAXIMO_PEDIDO ||
+        parametros.numAleatorias > ALEATORIAS_MAXIMO_PEDIDO || parametros.limitePassos > PASSOS_VERIFICACAO_MAXIMO_PEDIDO ||
+        parametros.fatorTraduzida > FATOR_MAXIMO_PEDIDO) {
+        fprintf(saida, "ERRO No servidor, -n vai até %d, -L até %d, -r até %llu, -p até %llu e -F até %llu.\n",
+                COMPRIMENTO_MAXIMO_PEDIDO, COMPRIMENTO_ALEATORIO_MAXIMO_PEDIDO, ALEATORIAS_MAXIMO_PEDIDO,
+                PASSOS_VERIFICACAO_MAXIMO_PEDIDO, FATOR_MAXIMO_PEDIDO);
+        return;
+    }
+    if (numTokens - i != 2 || parametros.comprimentoMaximo < 0 || parametros.comprimentoAleatorio < 0) {
+        fprintf(saida, "ERRO Uso: verify [-n comprimento] [-r aleatorias] [-L comprimento_aleatorias] [-p passos] [-F fator] "
+                       "[-s semente] [-a alfabeto] [-m] [-d] <maquina_original> <maquina_traduzida>\n");
+        return;
+    }
+
+    EntradaCache* original = obter_maquina(cache, tokens[i], erro, sizeof(erro));
+    EntradaCache* traduzida = original ? obter_maquina(cache, tokens[i + 1], erro, sizeof(erro)) : NULL;
+    ResultadoVerificacao resultado;
+    Verificacao* v = traduzida ? preparar_verificacao(original->maquina, traduzida->maquina, &parametros, NULL) : NULL;
+    int falhou = !v || executar_verificacao(v, 1, &resultado) != 0;
+    if (falhou) {
+        fprintf(saida, "ERRO %s\n", traduzida ? ultimo_erro() : erro);
+    } else {
+        fprintf(saida, "OK verificadas=%llu inconclusivas=%llu divergencia=%d",
+                (unsigned long long) resultado.verificadas, (unsigned long long) resultado.inconclusivas,
+                resultado.contraExemplo != UINT64_MAX);
+        if (resultado.contraExemplo != UINT64_MAX) {
+            int maiorComprimento = parametros.comprimentoMaximo > parametros.comprimentoAleatorio
+                                 ? parametros.comprimentoMaximo : parametros.comprimentoAleatorio;
+            char* palavra = (char*) malloc((size_t) maiorComprimento + 1);
+            if (palavra) {
+                palavra_da_verificacao(v, resultado.contraExemplo, palavra);
+                fprintf(saida, " palavra=%s", palavra);
+                free(palavra);
+            }
+        }
+        fputc('\n', saida);
+    }
+    liberar_verificacao(v);
+    cache_soltar(cache, original);
+    cache_soltar(cache, traduzida);
+}
 
-        adicionar_transicao(maquinaTraduzida, "q1_star_blank", "0", "*", 'r', nome_q1_0_e);
-        adicionar_transicao(maquinaTraduzida, "q1_star_blank", "1", "*", 'r', nome_q1_1_e);
-        adicionar_transicao(maquinaTraduzida, "q1_star_blank", "_", "*", 'r', nome_q1___e);
-        adicionar_transicao(maquinaTraduzida, "q1_star_blank", "&", "*", 'r', nome_q1_amp_e); // Alterado F para &
+// Lê pedidos até o fim da entrada e responde cada um com uma linha "OK ..." ou "ERRO ..."
+static void atender_conexao(CacheServidor* cache, FILE* entrada, FILE* saida) {
+    char* linha = NULL;
+    size_t capacidadeLinha = 0;
+    ssize_t tamanho;
+    while ((tamanho = getline(&linha, &capacidadeLinha, entrada)) != -1) {
+        const char* cursor = linha;
+        const char* fimLinha = linha + tamanho;
+        if (tamanho > 0 && linha[tamanho - 1] == '\n') fimLinha--;
+
+        // Os tokens são terminados em '\0' dentro da própria linha (o separador seguinte é sobrescrito)
+        char* tokens[MAXIMO_TOKENS_PEDIDO];
+        int numTokens = 0;
+        const char* token;
+        size_t tamanhoToken;
+        while (numTokens < MAXIMO_TOKENS_PEDIDO && proximo_token(&cursor, fimLinha, &token, &tamanhoToken)) {
+            tokens[numTokens] = (char*) token;
+            tokens[numTokens++][tamanhoToken] = '\0';
+            if (cursor < fimLinha) cursor++;
+        }
+        if (numTokens == 0 || tokens[0][0] == '#') continue;
+
+        if (strcmp(tokens[0], "translate") == 0) pedido_traduzir(cache, tokens, numTokens, saida);
+        else if (strcmp(tokens[0], "run") == 0) pedido_executar(cache, tokens, numTokens, saida);
+        else if (strcmp(tokens[0], "verify") == 0) pedido_verificar(cache, tokens, numTokens, saida);
+        else if (strcmp(tokens[0], "stats") == 0) {
+            pthread_mutex_lock(&cache->trava);
+            fprintf(saida, "OK entradas=%d memoria=%zu limite=%zu acertos=%llu faltas=%llu despejos=%llu\n",
+                    cache->numEntradas, cache->usados, cache->limite, (unsigned long long) cache->acertos,
+                    (unsigned long long) cache->faltas, (unsigned long long) cache->despejos);
+            pthread_mutex_unlock(&cache->trava);
+        } else {
+            fprintf(saida, "ERRO Pedido desconhecido '%s'.\n", tokens[0]);
+        }
+        if (fflush(saida) != 0) break; // o cliente desconectou
+    }
+    free(linha);
+}
 
+// Conexões aceitas esperando uma thread livre
+typedef struct {
+    pthread_mutex_t trava;
+    pthread_cond_t temConexao;
+    pthread_cond_t temEspaco;
+    int conexoes[FILA_CONEXOES];
+    int inicio;
+    int quantidade;
+    CacheServidor* cache;
+} FilaConexoes;
+
+static void* trabalhador_servidor(void* argumento) {
+    FilaConexoes* fila = (FilaConexoes*) argumento;
+    for (;;) {
+        pthread_mutex_lock(&fila->trava);
+        while (fila->quantidade == 0) pthread_cond_wait(&fila->temConexao, &fila->trava);
+        int conexao = fila->conexoes[fila->inicio];
+        fila->inicio = (fila->inicio + 1) % FILA_CONEXOES;
+        fila->quantidade--;
+        pthread_cond_signal(&fila->temEspaco);
+        pthread_mutex_unlock(&fila->trava);
+
+        int copia = dup(conexao);
+        FILE* entrada = fdopen(conexao, "r");
+        FILE* saida = copia >= 0 ? fdopen(copia, "w") : NULL;
+        if (entrada && saida) atender_conexao(fila->cache, entrada, saida);
+        if (entrada) fclose(entrada);
+        else close(conexao);
+        if (saida) fclose(saida);
+        else if (copia >= 0) close(copia);
+    }
+    return NULL;
+}
 
-        // q2e: loop left on '*', then on '#' go right to e (Retorna para o estado original 'e' após o shift)
-        adicionar_transicao(maquinaTraduzida, nome_q2e, "*", "*", 'l', nome_q2e);
-        adicionar_transicao(maquinaTraduzida, nome_q2e, "#", "#", 'r', e); // Alterado I para #
-        
-        // q_amp_e: '*', write '&', l, e (Reposiciona '&' e retorna para 'e') - Este estado é para o shift da direita
-        adicionar_transicao(maquinaTraduzida, nome_q_amp_e, "*", "&", 'l', e); // Se encontra '*', escreve '&', move para a esquerda para 'e'
-        adicionar_transicao(maquinaTraduzida, nome_q_amp_e, "0", "0", 'l', nome_q_amp_e); // Continua movendo esquerda
-        adicionar_transicao(maquinaTraduzida, nome_q_amp_e, "1", "1", 'l', nome_q_amp_e); // Continua movendo esquerda
-        adicionar_transicao(maquinaTraduzida, nome_q_amp_e, "_", "_", 'l', nome_q_amp_e); // Continua movendo esquerda
-        adicionar_transicao(maquinaTraduzida, nome_q_amp_e, "#", "#", 'r', e); // Se encontra '#', move para direita e vai para 'e' // Alterado I para #
+// Modo "serve": tradutor serve [-s socket] [-j threads] [-m limite_MB]
+static int modo_servidor(int argc, char* argv[]) {
+    const char* caminhoSocket = NULL;
+    int numThreads = numero_de_nucleos();
+    size_t limiteMB = 256;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) caminhoSocket = argv[++i];
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) limiteMB = strtoull(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "Uso: %s serve [-s socket] [-j threads] [-m limite_de_memoria_MB]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
     }
+    if (numThreads < 1) numThreads = 1;
 
+    static CacheServidor cache; // grande demais para a pilha
+    pthread_mutex_init(&cache.trava, NULL);
+    cache.limite = limiteMB << 20;
 
-    // === Liberar lista temporaria de estados ===
-    for (int i = 0; i < numEstados; ++i) {
-        if (estados[i]) free(estados[i]);
+    // Sem socket: um único cliente na entrada e na saída padrão
+    if (!caminhoSocket) {
+        atender_conexao(&cache, stdin, stdout);
+        return EXIT_SUCCESS;
     }
-    free(estados);
 
-    return maquinaTraduzida;
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminhoSocket) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "ERRO: Caminho do socket longo demais: '%s'.\n", caminhoSocket);
+        return EXIT_FAILURE;
+    }
+    strcpy(endereco.sun_path, caminhoSocket);
+    struct stat info;
+    if (stat(caminhoSocket, &info) == 0 && S_ISSOCK(info.st_mode)) unlink(caminhoSocket); // socket de uma execução anterior
+
+    int servidor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (servidor < 0 || bind(servidor, (struct sockaddr*) &endereco, sizeof(endereco)) != 0 || listen(servidor, 64) != 0) {
+        fprintf(stderr, "ERRO: Não foi possível escutar em '%s': %s\n", caminhoSocket, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    signal(SIGPIPE, SIG_IGN); // um cliente que desconecta no meio da resposta não derruba o servidor
+
+    static FilaConexoes fila;
+    pthread_mutex_init(&fila.trava, NULL);
+    pthread_cond_init(&fila.temConexao, NULL);
+    pthread_cond_init(&fila.temEspaco, NULL);
+    fila.cache = &cache;
+    for (int t = 0; t < numThreads; t++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, trabalhador_servidor, &fila) != 0) {
+            fprintf(stderr, "ERRO: Não foi possível criar a thread %d.\n", t);
+            exit(EXIT_FAILURE);
+        }
+        pthread_detach(thread);
+    }
+    fprintf(stderr, "-> Servidor escutando em '%s' com %d threads e cache de %zu MB.\n", caminhoSocket, numThreads, limiteMB);
+
+    for (;;) {
+        int conexao = accept(servidor, NULL, NULL);
+        if (conexao < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            fprintf(stderr, "ERRO: accept falhou: %s\n", strerror(errno));
+            return EXIT_FAILURE;
+        }
+        pthread_mutex_lock(&fila.trava);
+        while (fila.quantidade == FILA_CONEXOES) pthread_cond_wait(&fila.temEspaco, &fila.trava);
+        fila.conexoes[(fila.inicio + fila.quantidade) % FILA_CONEXOES] = conexao;
+        fila.quantidade++;
+        pthread_cond_signal(&fila.temConexao);
+        pthread_mutex_unlock(&fila.trava);
+    }
 }
 
+// === Relatório de instrumentação (--stats) ===
+
+static void escrever_string_json(FILE* saida, const char* texto) {
+    fputc('"', saida);
+    for (const unsigned char* p = (const unsigned char*) texto; *p; p++) {
+        if (*p == '"' || *p == '\\') fprintf(saida, "\\%c", *p);
+        else if (*p < 0x20) fprintf(saida, "\\u%04x", *p);
+        else fputc(*p, saida);
+    }
+    fputc('"', saida);
+}
+
+// Imprime o relatório em texto ou, com 'json', num objeto de uma linha com chaves fixas:
+// {"versao":1,"entrada","saida","tipo_original","tipo_traduzido","threads","transicoes_original",
+//  "transicoes_traduzida","etapas":{<etapa>:{"real_s","cpu_s"}},"alocacoes":{"quantidade","bytes",
+//  "crescimentos_transicoes"},"regras":{<categoria>:n}}
+// Tipos e contagens ausentes (tradução que falhou) saem como null.
+static void escrever_relatorio(FILE* saida, int json, const Instrumentacao* inst, const char* arquivoEntrada,
+                               const char* arquivoSaida, const MaquinaTuring* original, const MaquinaTuring* traduzida, int numThreads) {
+    if (!json) {
+        fprintf(saida, "-> Estatísticas:\n");
+        fprintf(saida, "   %-16s %12s %12s\n", "etapa", "real (s)", "CPU (s)");
+        for (int e = 0; e < NUM_ETAPAS; e++) {
+            fprintf(saida, "   %-16s %12.6f %12.6f\n", nome_etapa((EtapaTraducao) e), inst->segundos[e], inst->segundosCpu[e]);
+        }
+        fprintf(saida, "   alocações: %llu (%llu bytes), crescimentos do vetor de transições: %llu\n",
+                (unsigned long long) inst->alocacoes, (unsigned long long) inst->bytesAlocados,
+                (unsigned long long) inst->crescimentosTransicoes);
+        fprintf(saida, "   regras geradas:");
+        for (int c = 0; c < NUM_CATEGORIAS; c++) {
+            fprintf(saida, "%s %s %llu", c ? "," : "", nome_categoria((CategoriaRegra) c), (unsigned long long) inst->regras[c]);
+        }
+        fprintf(saida, "\n");
+        return;
+    }
+
+    fprintf(saida, "{\"versao\":1,\"entrada\":");
+    escrever_string_json(saida, arquivoEntrada);
+    fprintf(saida, ",\"saida\":");
+    escrever_string_json(saida, arquivoSaida);
+    if (original) fprintf(saida, ",\"tipo_original\":\"%c\"", original->tipo);
+    else fprintf(saida, ",\"tipo_original\":null");
+    if (traduzida) fprintf(saida, ",\"tipo_traduzido\":\"%c\"", traduzida->tipo);
+    else fprintf(saida, ",\"tipo_traduzido\":null");
+    fprintf(saida, ",\"threads\":%d", numThreads);
+    if (original) fprintf(saida, ",\"transicoes_original\":%d", original->numTransicoes);
+    else fprintf(saida, ",\"transicoes_original\":null");
+    if (traduzida) fprintf(saida, ",\"transicoes_traduzida\":%d", traduzida->numTransicoes);
+    else fprintf(saida, ",\"transicoes_traduzida\":null");
+    fprintf(saida, ",\"etapas\":{");
+    for (int e = 0; e < NUM_ETAPAS; e++) {
+        fprintf(saida, "%s\"%s\":{\"real_s\":%.6f,\"cpu_s\":%.6f}", e ? "," : "", nome_etapa((EtapaTraducao) e),
+                inst->segundos[e], inst->segundosCpu[e]);
+    }
+    fprintf(saida, "},\"alocacoes\":{\"quantidade\":%llu,\"bytes\":%llu,\"crescimentos_transicoes\":%llu}",
+            (unsigned long long) inst->alocacoes, (unsigned long long) inst->bytesAlocados,
+            (unsigned long long) inst->crescimentosTransicoes);
+    fprintf(saida, ",\"regras\":{");
+    for (int c = 0; c < NUM_CATEGORIAS; c++) {
+        fprintf(saida, "%s\"%s\":%llu", c ? "," : "", nome_categoria((CategoriaRegra) c), (unsigned long long) inst->regras[c]);
+    }
+    fprintf(saida, "}}\n");
+}
 
 int main(int argc, char *argv[]) {
-    
+
+    if (argc >= 2 && strcmp(argv[1], "convert") == 0) {
+        return modo_converter(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "batch") == 0) {
+        return modo_lote(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "stream") == 0) {
+        return modo_fluxo(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "run") == 0) {
+        return modo_executar(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "batch-run") == 0) {
+        return modo_executar_lote(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "profile") == 0) {
+        return modo_perfil(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "compile") == 0) {
+        return modo_compilar(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "generate") == 0) {
+        return modo_gerar(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        return modo_benchmark(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "verify") == 0) {
+        return modo_verificar(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "incremental") == 0) {
+        return modo_incremental(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "serve") == 0) {
+        return modo_servidor(argc, argv);
+    }
+
+    // Opções: -b grava a máquina traduzida no formato binário; -d e -c escolhem a construção da tradução I -> S;
+    // -O otimiza a máquina traduzida antes de gravá-la; -M funde os estados equivalentes;
+    // -j divide a tradução entre threads (a saída é a mesma com qualquer número de threads);
+    // --stats[=json] mede as etapas, as alocações e as regras geradas; --quiet omite as mensagens de progresso
+    int saidaBinaria = 0;
+    int otimizar = 0;
+    int minimizar = 0;
+    int relatorio = 0;  // --stats: 1 em texto, 2 em JSON
+    int numThreads = numero_de_nucleos();
+    while (argc >= 2 && (strcmp(argv[1], "-b") == 0 || strcmp(argv[1], "-d") == 0 || strcmp(argv[1], "--dobrada") == 0 ||
+                         strcmp(argv[1], "-c") == 0 || strcmp(argv[1], "--compartilhada") == 0 || strcmp(argv[1], "-O") == 0 ||
+                         strcmp(argv[1], "-M") == 0 || (strcmp(argv[1], "-j") == 0 && argc >= 3) ||
+                         strcmp(argv[1], "--stats") == 0 || strcmp(argv[1], "--stats=json") == 0 || strcmp(argv[1], "--quiet") == 0)) {
+        if (strcmp(argv[1], "-j") == 0) {
+            numThreads = atoi(argv[2]);
+            argv[2] = argv[0];
+            argv++;
+            argc--;
+        }
+        else if (strcmp(argv[1], "-b") == 0) saidaBinaria = 1;
+        else if (strcmp(argv[1], "-O") == 0) otimizar = 1;
+        else if (strcmp(argv[1], "-M") == 0) minimizar = 1;
+        else if (strcmp(argv[1], "--stats=json") == 0) relatorio = 2;
+        else if (strcmp(argv[1], "--stats") == 0) relatorio = 1;
+        else if (strcmp(argv[1], "--quiet") == 0) silencioso = 1;
+        else if (strcmp(argv[1], "-c") == 0 || strcmp(argv[1], "--compartilhada") == 0) esquemaIparaS = ESQUEMA_COMPARTILHADO;
+        else esquemaIparaS = ESQUEMA_DOBRADO;
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
+
     if (argc != 3) {
-        fprintf(stderr, "Uso: %s <arquivo_de_entrada> <arquivo_de_saida>\n", argv[0]);
+        fprintf(stderr, "Uso: %s [-j threads] [-b] [-d|-c] [-O] [-M] [--stats[=json]] [--quiet] <arquivo_de_entrada> <arquivo_de_saida>\n", argv[0]);
+        fprintf(stderr, "     %s convert <arquivo_de_entrada> <arquivo_de_saida>\n", argv[0]);
+        fprintf(stderr, "     %s batch [-j threads] [-b] [-d|-c] [-O] [-M] [-o dir_saida] [-m manifesto] <diretorio|padrao|arquivo>...\n", argv[0]);
+        fprintf(stderr, "     %s stream [arquivo_de_entrada|-] [arquivo_de_saida|-]\n", argv[0]);
+        fprintf(stderr, "     %s incremental <arquivo_de_entrada> <arquivo_de_saida>\n", argv[0]);
+        fprintf(stderr, "     %s run [-p limite_de_passos] [-i estado_inicial] [-f] [-m] <maquina> [palavra]\n", argv[0]);
+        fprintf(stderr, "     %s batch-run [-p limite_de_passos] [-i estado_inicial] [-f] [-j threads] [-l pistas] [-o saida] <maquina> <palavras|->\n", argv[0]);
+        fprintf(stderr, "     %s profile [-p limite_de_passos] [-i estado_inicial] [-f] [-d|-c] [-s] [-n linhas] [-F arquivo_folded] <maquina> [palavra]\n", argv[0]);
+        fprintf(stderr, "     %s compile [-i estado_inicial] [-a alfabeto] [-f] <maquina> <saida.c>\n", argv[0]);
+        fprintf(stderr, "     %s verify [opções] <maquina_original> <maquina_traduzida>\n", argv[0]);
+        fprintf(stderr, "     %s serve [-s socket] [-j threads] [-m limite_de_memoria_MB]\n", argv[0]);
+        fprintf(stderr, "     %s generate [-t S|I] [-e estados] [-a simbolos] [-n transicoes] [-R] [-m esq:dir:parado] [-s semente] [-b] <saida>\n", argv[0]);
+        fprintf(stderr, "     %s bench [-r repeticoes] [-j threads] [-d|-c] [opções do gerador] [maquina...]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
     const char* arquivoEntrada = argv[1];
     const char* arquivoSaida = argv[2];
 
-    printf("Tradutor de Máquina de Turing\n");
-    printf("----------------------------------\n");
-    printf("Arquivo de entrada: %s\n", arquivoEntrada);
-    printf("Arquivo de saída:   %s\n", arquivoSaida);
-    printf("----------------------------------\n");
+    informar("Tradutor de Máquina de Turing\n");
+    informar("----------------------------------\n");
+    informar("Arquivo de entrada: %s\n", arquivoEntrada);
+    informar("Arquivo de saída:   %s\n", arquivoSaida);
+    informar("----------------------------------\n");
+
+    Instrumentacao instrumentacao;
+    memset(&instrumentacao, 0, sizeof(instrumentacao));
+    if (relatorio) ativar_instrumentacao(&instrumentacao);
 
     MaquinaTuring* maquinaOriginal = carregar_maquina(arquivoEntrada);
-    printf("-> Máquina original (tipo '%c') carregada com %d transições.\n", maquinaOriginal->tipo, maquinaOriginal->numTransicoes);
+    if (!maquinaOriginal) {
+        fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+        exit(EXIT_FAILURE);
+    }
+    informar("-> Máquina original (tipo '%c') carregada com %d transições.\n", maquinaOriginal->tipo, maquinaOriginal->numTransicoes);
+
 
+    informar("-> Iniciando tradução do tipo '%c'...\n", maquinaOriginal->tipo);
+    MaquinaTuring* maquinaTraduzida = traduzir_maquina_paralela(maquinaOriginal, esquemaIparaS, numThreads);
 
-    MaquinaTuring* maquinaTraduzida = traduzir_maquina(maquinaOriginal);
+    if (maquinaTraduzida && otimizar) {
+        EstatisticasOtimizacao estatisticas;
+        MaquinaTuring* otimizada = otimizar_maquina(maquinaTraduzida, &estatisticas);
+        liberar_maquina(maquinaTraduzida);
+        maquinaTraduzida = otimizada;
+        if (otimizada) informar("-> Otimização: %d -> %d regras (%d de estados inalcançáveis ou de parada, %d duplicadas ou sombreadas, "
+               "%d a menos com curingas).\n", estatisticas.regrasAntes, estatisticas.regrasDepois,
+               estatisticas.inalcancaveis, estatisticas.duplicadas, estatisticas.fundidas);
+    }
+    if (maquinaTraduzida && minimizar) {
+        EstatisticasMinimizacao estatisticas;
+        MaquinaTuring* minimizada = minimizar_maquina(maquinaTraduzida, &estatisticas);
+        liberar_maquina(maquinaTraduzida);
+        maquinaTraduzida = minimizada;
+        if (minimizada) informar("-> Minimização: %d -> %d estados, %d -> %d regras.\n", estatisticas.estadosAntes, estatisticas.estadosDepois,
+               estatisticas.regrasAntes, estatisticas.regrasDepois);
+    }
 
     // Se a tradução foi bem-sucedida, salvar e liberar a máquina traduzida
     if (maquinaTraduzida) {
-        salvar_maquina(maquinaTraduzida, arquivoSaida);
-        printf("-> Máquina traduzida para o tipo '%c' e salva com sucesso.\n", maquinaTraduzida->tipo);
+        int resultado = gravar_maquina(maquinaTraduzida, arquivoSaida, saidaBinaria, NULL);
+        if (resultado != 0) {
+            fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+            exit(EXIT_FAILURE);
+        }
+        informar("-> Máquina traduzida para o tipo '%c' e salva com sucesso.\n", maquinaTraduzida->tipo);
+    } else {
+        fprintf(stderr, "ERRO: %s\n", ultimo_erro());
+        informar("-> A tradução não pôde ser concluída.\n");
+    }
 
+    if (relatorio) {
+        ativar_instrumentacao(NULL);
+        escrever_relatorio(stdout, relatorio == 2, &instrumentacao, arquivoEntrada, arquivoSaida, maquinaOriginal,
+                           maquinaTraduzida, numThreads);
+    }
+    int traduziu = maquinaTraduzida != NULL;
+    if (maquinaTraduzida) {
         liberar_maquina(maquinaTraduzida);
-        printf("-> Memória da máquina traduzida liberada.\n");
-    } else {
-        printf("-> A tradução não pôde ser concluída.\n");
+        informar("-> Memória da máquina traduzida liberada.\n");
     }
 
 
     liberar_maquina(maquinaOriginal);
-    printf("-> Memória da máquina original liberada com sucesso.\n");
+    informar("-> Memória da máquina original liberada com sucesso.\n");
 
-    printf("\nEstrutura do programa concluída. As funções de lógica serão implementadas nos próximos passos.\n");
+    informar("\nEstrutura do programa concluída. As funções de lógica serão implementadas nos próximos passos.\n");
 
-    return EXIT_SUCCESS;
+    return traduziu ? EXIT_SUCCESS : EXIT_FAILURE;
 }
\ No newline at end of file
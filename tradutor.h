@@ -0,0 +1,353 @@
+// Biblioteca do tradutor de Máquinas de Turing (Sipser <-> duplamente infinita).
+//
+// Nenhuma função da biblioteca imprime nada ou encerra o processo. Em caso de erro, as funções que
+// retornam ponteiro retornam NULL e as que retornam int retornam -1; o código e a mensagem do
+// último erro da thread ficam em ultimo_codigo_erro() e ultimo_erro().
+// A biblioteca não tem estado global mutável: threads diferentes podem carregar, traduzir e
+// simular máquinas diferentes ao mesmo tempo. Uma mesma máquina pode ser lida por várias threads,
+// mas não pode ser modificada por uma enquanto outras a usam.
+
+#ifndef TRADUTOR_H
+#define TRADUTOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Finalizador do splitmix64: espalha bem chaves sequenciais como IDs densos
+static inline uint64_t hash_chave(uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// ID denso de um nome (estado ou símbolo) dentro da tabela de nomes da máquina
+typedef uint32_t IdNome;
+
+#define ID_INEXISTENTE ((IdNome) UINT32_MAX)
+
+// Códigos de erro. TRADUTOR_OK é sempre 0.
+typedef enum {
+    TRADUTOR_OK = 0,
+    TRADUTOR_ERRO_MEMORIA,        // falha de alocação
+    TRADUTOR_ERRO_ARQUIVO,        // abrir, ler, gravar ou fechar um arquivo
+    TRADUTOR_ERRO_FORMATO,        // entrada vazia, corrompida ou de versão incompatível
+    TRADUTOR_ERRO_TRADUCAO,       // a máquina não pode ser traduzida (tipo desconhecido, sem marcadores livres, ...)
+    TRADUTOR_ERRO_SOMENTE_LEITURA, // tentativa de modificar uma máquina carregada do formato binário
+    TRADUTOR_ERRO_LIMITE,         // a máquina excede um limite interno (tamanho da arena de nomes)
+    TRADUTOR_ERRO_ENTRADA         // argumento inválido (palavra com símbolo desconhecido, máquina nula, ...)
+} CodigoErro;
+
+// <estadoAtual> <simboloAtual> <novoSimbolo> <direcao> <novoEstado>
+// Estados são IDs da tabela 'estados' e símbolos são IDs da tabela 'simbolos' da máquina dona da transição
+typedef struct {
+    IdNome estadoAtual;
+    IdNome simboloAtual;
+    IdNome novoSimbolo;
+    IdNome novoEstado;
+    char direcao;
+} Transicao;
+
+// Arena de bump onde ficam os bytes de todos os nomes da máquina, cada um terminado em '\0'.
+// Os nomes são referenciados por deslocamento, então a arena pode crescer com realloc.
+typedef struct {
+    char* bytes;
+    size_t usados;
+    size_t capacidade;
+} Arena;
+
+// Associa cada nome distinto a um ID denso (0, 1, 2, ...) na ordem em que aparece
+typedef struct {
+    uint32_t* deslocamentos;   // posição do nome na arena, indexada pelo ID
+    uint32_t* tamanhos;        // tamanho do nome sem o '\0', indexado pelo ID
+    uint32_t numNomes;
+    uint32_t capacidadeNomes;
+    uint32_t* indice;          // tabela hash de endereçamento aberto: guarda ID+1 (0 = posição vazia)
+    uint32_t capacidadeIndice; // sempre potência de 2
+} TabelaNomes;
+
+// Maquina de Turing completa, lida de um arquivo
+typedef struct {
+    Transicao* transicoes;
+    int numTransicoes;
+    int capacidadeTransicoes;
+    char tipo;  // 'S' para sipser, 'I' para duplamente_infinita
+    Arena arena;           // bytes dos nomes de estados e símbolos
+    TabelaNomes estados;
+    TabelaNomes simbolos;
+    // Máquinas carregadas do formato binário apontam direto para a região do arquivo (somente leitura)
+    void* regiao;
+    size_t tamanhoRegiao;
+    int regiaoMapeada;     // 1 se 'regiao' veio de mmap, 0 se de malloc
+    // Código do primeiro erro ao adicionar transições (memória, somente leitura); a máquina fica
+    // incompleta e quem a construiu deve descartá-la
+    CodigoErro erro;
+} MaquinaTuring;
+
+// Construção usada por traduzir_maquina para máquinas do tipo 'I'
+typedef enum {
+    ESQUEMA_DESLOCAMENTO,  // '#' e '&' nas pontas; a fita inteira é deslocada ao passar do '#'
+    ESQUEMA_DOBRADO,       // fita dobrada em duas trilhas (opção -d)
+    ESQUEMA_COMPARTILHADO  // uma única sub-rotina de deslocamento para todos os estados (opção -c)
+} EsquemaIparaS;
+
+typedef struct {
+    int regrasAntes;
+    int regrasDepois;
+    int inalcancaveis;  // regras de estados inalcançáveis a partir de "0" ou de estados de parada
+    int duplicadas;     // regras repetidas ou sombreadas por outra regra do mesmo estado
+    int fundidas;       // regras a menos depois de fundir grupos em curingas
+} EstatisticasOtimizacao;
+
+typedef struct {
+    int completa;              // 1 se não havia manifesto válido para a saída anterior e tudo foi gerado
+    int blocosReaproveitados;  // blocos de estados copiados da saída anterior
+    int blocosGerados;
+    int blocosRemovidos;       // estados que saíram da máquina desde a saída anterior
+} EstatisticasIncremental;
+
+typedef struct {
+    int estadosAntes;
+    int estadosDepois;
+    int regrasAntes;
+    int regrasDepois;
+} EstatisticasMinimizacao;
+
+// Parâmetros de gerar_maquina
+typedef struct {
+    char tipo;          // 'S' ou 'I'
+    int numEstados;     // estados "0" a "<numEstados - 1>", além de "halt-accept"
+    int numSimbolos;    // o branco '_' mais até 62 dígitos e letras
+    int numTransicoes;  // no máximo numEstados * numSimbolos, a menos que 'permitirRepetidos' seja 1
+    int permitirRepetidos; // aceita mais transições que pares (estado, símbolo); as repetidas nunca executam
+    int pesoEsquerda;   // proporção de movimentos 'l', 'r' e '*'
+    int pesoDireita;
+    int pesoParado;
+    uint64_t semente;
+} ParametrosGerador;
+
+
+// Etapas medidas pela instrumentação
+typedef enum {
+    ETAPA_LEITURA,         // carregar_maquina
+    ETAPA_COLETA_ESTADOS,  // alfabeto, marcadores e estados que precisam de regras extras
+    ETAPA_FASE1,           // regras de preparação e regras da original
+    ETAPA_FASE2,           // sub-rotinas de borda de cada estado (I -> S por deslocamento)
+    ETAPA_ESCRITA,         // gravar_maquina
+    NUM_ETAPAS
+} EtapaTraducao;
+
+// Categorias das regras geradas pelas traduções
+typedef enum {
+    REGRAS_PREPARACAO,    // marcação da fita antes de entregar o cabeçote ao estado inicial
+    REGRAS_COPIADAS,      // regras da original, traduzidas uma a uma
+    REGRAS_MOLA,          // volta da barreira '#' (S -> I)
+    REGRAS_DESLOCAMENTO,  // deslocamento da fita ao cair no marcador esquerdo (I -> S)
+    REGRAS_EXTENSAO,      // avanço do marcador direito (I -> S)
+    NUM_CATEGORIAS
+} CategoriaRegra;
+
+// Origem de uma regra da máquina traduzida (traduzir_maquina_com_origens): o índice da transição da
+// original que ela traduz (>= 0), ou ORIGEM_AUXILIAR(categoria) para as regras que a tradução acrescenta
+#define ORIGEM_AUXILIAR(categoria) (-1 - (int32_t) (categoria))
+
+// Contadores acumulados enquanto a instrumentação está ativa (ver ativar_instrumentacao)
+typedef struct {
+    double segundos[NUM_ETAPAS];     // tempo real
+    double segundosCpu[NUM_ETAPAS];  // CPU do processo inteiro, somando as threads da tradução
+    uint64_t alocacoes;              // malloc, calloc e realloc feitos pela biblioteca
+    uint64_t bytesAlocados;
+    uint64_t crescimentosTransicoes; // realloc do vetor de transições de uma máquina
+    uint64_t regras[NUM_CATEGORIAS];
+} Instrumentacao;
+
+
+// Erros
+CodigoErro ultimo_codigo_erro(void);
+const char* ultimo_erro(void);
+
+// Instrumentação da thread atual: a biblioteca acumula em 'destino' (que não é zerado) até ser
+// chamada com NULL. As traduções em várias threads contam também o trabalho das suas partes.
+void ativar_instrumentacao(Instrumentacao* destino);
+const char* nome_etapa(EtapaTraducao etapa);
+const char* nome_categoria(CategoriaRegra categoria);
+
+// Construção
+MaquinaTuring* criar_maquina(char tipo, int capacidadeInicial);
+IdNome internar_nome(TabelaNomes* tabela, Arena* arena, const char* nome, size_t tamanho);
+IdNome buscar_nome(const TabelaNomes* tabela, const Arena* arena, const char* nome, size_t tamanho);
+void adicionar_transicao(MaquinaTuring* maquina, const char* estA, const char* simA, const char* simN, char dir, const char* estN);
+void adicionar_transicao_ids(MaquinaTuring* maquina, IdNome estA, IdNome simA, IdNome simN, char dir, IdNome estN);
+void liberar_maquina(MaquinaTuring* maquina);
+
+// Leitura: de um buffer em memória (texto ou binário, que é copiado) ou de um arquivo ("-" é a entrada padrão)
+MaquinaTuring* interpretar_maquina(const char* dados, size_t tamanho);
+MaquinaTuring* ler_maquina(const void* dados, size_t tamanho);
+MaquinaTuring* abrir_maquina_binaria(void* regiao, size_t tamanho, int regiaoMapeada);
+MaquinaTuring* carregar_maquina(const char* nomeArquivo);
+// Próximo token de [*cursor, fimLinha) no formato texto (separadores: espaço, tab e '\r'); 0 no fim da linha
+int proximo_token(const char** cursor, const char* fimLinha, const char** token, size_t* tamanho);
+
+// Gravação: para um buffer alocado com malloc (liberado por quem chamou) ou para um arquivo ("-" é a saída padrão).
+// 'buffer' de gravar_maquina é um buffer de TAMANHO_BUFFER_SAIDA bytes reaproveitado entre gravações, ou NULL.
+#define TAMANHO_BUFFER_SAIDA (1 << 20)
+int serializar_maquina(const MaquinaTuring* maquina, int binaria, char** dados, size_t* tamanho);
+int gravar_maquina(const MaquinaTuring* maquina, const char* nomeArquivo, int binaria, char* buffer);
+int salvar_maquina(const MaquinaTuring* maquina, const char* nomeArquivo);
+int salvar_maquina_binaria(const MaquinaTuring* maquina, const char* nomeArquivo);
+
+// Tradução
+MaquinaTuring* traduzir_maquina(const MaquinaTuring* maquinaOriginal, EsquemaIparaS esquema);
+// Como traduzir_maquina, dividindo a tradução entre até 'numThreads' threads. O resultado é idêntico ao
+// de traduzir_maquina; máquinas pequenas são traduzidas numa thread só.
+MaquinaTuring* traduzir_maquina_paralela(const MaquinaTuring* maquinaOriginal, EsquemaIparaS esquema, int numThreads);
+// Tradução numa thread só que também devolve em '*origens' (alocado com malloc, com uma posição por regra
+// da traduzida) a origem de cada regra
+MaquinaTuring* traduzir_maquina_com_origens(const MaquinaTuring* maquinaOriginal, EsquemaIparaS esquema, int32_t** origens);
+MaquinaTuring* traduzir_S_para_I(const MaquinaTuring* maquinaOriginal);
+MaquinaTuring* traduzir_I_para_S(const MaquinaTuring* maquinaOriginal);
+MaquinaTuring* traduzir_I_para_S_dobrada(const MaquinaTuring* maquinaOriginal);
+MaquinaTuring* traduzir_I_para_S_compartilhada(const MaquinaTuring* maquinaOriginal);
+int traduzir_S_para_I_fluxo(FILE* entrada, const char* nomeSaida);
+// Tradução I -> S em texto que reaproveita a saída anterior, guiada pelo manifesto '<nomeSaida>.manifesto'
+int traduzir_I_para_S_incremental(const MaquinaTuring* maquinaOriginal, const char* nomeSaida, EstatisticasIncremental* estatisticas);
+MaquinaTuring* otimizar_maquina(const MaquinaTuring* maquina, EstatisticasOtimizacao* estatisticas);
+MaquinaTuring* minimizar_maquina(const MaquinaTuring* maquina, EstatisticasMinimizacao* estatisticas);
+// Máquina aleatória válida, a mesma para os mesmos parâmetros. Cada transição usa um par (estado, símbolo)
+// novo; só com 'permitirRepetidos' as que passam do número de pares repetem pares aleatórios. O próximo
+// estado é "halt-accept" com chance 1/(numEstados + 1).
+MaquinaTuring* gerar_maquina(const ParametrosGerador* parametros);
+
+// Nome textual de um estado/símbolo. O ponteiro só é válido até o próximo nome ser internado na mesma máquina.
+static inline const char* nome_estado(const MaquinaTuring* maquina, IdNome id) {
+    return maquina->arena.bytes + maquina->estados.deslocamentos[id];
+}
+
+static inline const char* nome_simbolo(const MaquinaTuring* maquina, IdNome id) {
+    return maquina->arena.bytes + maquina->simbolos.deslocamentos[id];
+}
+
+
+// === Simulador ===
+// A máquina é compilada para uma tabela densa [estado][símbolo], já com os curingas '*' do Morphett
+// resolvidos, e executada sobre uma fita de IDs de símbolos que cresce para os dois lados.
+
+#define ACAO_PARADA   1u  // estado 'halt*': a máquina para antes de executar o passo
+#define ACAO_SEM_REGRA 2u // nenhuma regra para (estado, símbolo): a máquina para
+#define ACAO_DESLOCAMENTO 4u // início de uma varredura que desloca a fita em uma célula (ver acelerar_programa)
+#define ACAO_SEQUENCIA 8u    // laço de um só estado que anda sempre para o mesmo lado
+
+// Uma entrada da tabela: fita[cabeca] = (fita[cabeca] & mascara) | valor, cabeca += movimento.
+// O próximo estado é guardado já como início da sua linha na tabela (estado * numColunas).
+typedef struct {
+    uint32_t proximaLinha;
+    uint32_t mascara;   // UINT32_MAX mantém o símbolo lido ('*' como novo símbolo), 0 sobrescreve
+    uint32_t valor;
+    int16_t movimento;  // -1, 0 ou +1
+    uint16_t flags;     // ACAO_PARADA / ACAO_SEM_REGRA
+} AcaoCompilada;
+
+typedef struct {
+    const MaquinaTuring* maquina;  // dona dos nomes dos estados e dos símbolos
+    AcaoCompilada* acoes;          // numEstados * numColunas entradas
+    uint32_t numEstados;
+    uint32_t numColunas;           // símbolos da máquina + símbolos extras da entrada
+    uint32_t colunaBranco;         // coluna do símbolo '_'
+    uint32_t estadoInicial;
+    uint32_t mapaBytes[256];       // caractere da palavra de entrada -> coluna (ID_INEXISTENTE se não houver)
+    char extras[256][2];           // nomes das colunas extras (um caractere cada)
+    int semiInfinita;              // 1: fita de Sipser, mover 'l' na primeira célula não sai do lugar
+    uint64_t* simbolosDeslocamento; // por estado: colunas que a sua varredura de deslocamento percorre (NULL sem macropassos)
+} ProgramaCompilado;
+
+typedef enum {
+    MOTIVO_PARADA,      // entrou em um estado 'halt*'
+    MOTIVO_SEM_REGRA,   // não havia regra para o estado e o símbolo atuais
+    MOTIVO_LIMITE,      // atingiu o limite de passos
+    MOTIVO_SEM_MEMORIA  // a fita não pôde crescer
+} MotivoFim;
+
+typedef struct {
+    uint32_t estadoFinal;
+    uint64_t passos;
+    MotivoFim motivo;
+} ResultadoExecucao;
+
+// Fita duplamente infinita: 'celulas' cresce para o lado que o cabeçote ultrapassar
+typedef struct {
+    uint32_t* celulas;
+    int64_t capacidade;
+    int64_t cabeca;    // índice da célula sob o cabeçote
+    int64_t origem;    // índice da primeira célula da palavra de entrada
+} Fita;
+
+ProgramaCompilado* compilar_maquina(const MaquinaTuring* maquina, const char* alfabetoEntrada, const char* estadoInicial);
+int acelerar_programa(ProgramaCompilado* programa);
+void liberar_programa(ProgramaCompilado* programa);
+const char* nome_coluna(const ProgramaCompilado* programa, uint32_t coluna);
+int fita_iniciar(Fita* fita, const ProgramaCompilado* programa, const char* palavra);
+void fita_liberar(Fita* fita);
+ResultadoExecucao executar_programa(const ProgramaCompilado* programa, Fita* fita, uint64_t limitePassos);
+// Perfil: executa passo a passo (sem macropassos) somando em contagens[estado * numColunas + coluna] os
+// passos de cada entrada da tabela. 'contagens' tem numEstados * numColunas posições, zeradas por quem chamou.
+ResultadoExecucao executar_programa_perfilado(const ProgramaCompilado* programa, Fita* fita, uint64_t limitePassos, uint64_t* contagens);
+// Índice da transição da máquina que cada entrada da tabela executa, ou -1 (sem regra ou estado de parada).
+// Vetor de numEstados * numColunas posições alocado com malloc.
+int32_t* regras_do_programa(const ProgramaCompilado* programa);
+void fita_escrever(const Fita* fita, const ProgramaCompilado* programa, FILE* saida);
+// Execução em lote: chamada para cada palavra concluída, em qualquer ordem. 'resultado' e 'fita' são NULL se a
+// palavra tem um símbolo que o programa não conhece (a mensagem fica em ultimo_erro()). A fita só vale
+// durante a chamada.
+typedef void (*ConcluirPalavra)(void* contexto, int indice, const ResultadoExecucao* resultado, const Fita* fita);
+// Executa o programa (sem macropassos) sobre palavras[0, numPalavras), com até 'numPistas' fitas avançando
+// juntas; cada pista que para é entregue a 'concluir' e recebe a próxima palavra. Retorna -1 se faltar memória.
+int executar_lote(const ProgramaCompilado* programa, const char* const* palavras, int numPalavras, int numPistas,
+                  uint64_t limitePassos, ConcluirPalavra concluir, void* contexto);
+const char* descrever_motivo(MotivoFim motivo);
+// Gera um programa C independente que executa o programa compilado (sem macropassos) sobre as palavras
+// passadas na linha de comando e imprime o resultado como o modo "run"
+int gerar_programa_c(const ProgramaCompilado* programa, const char* nomeArquivo);
+
+
+
+// === Verificação diferencial ===
+// Executa a máquina original e a traduzida sobre as mesmas palavras e compara como cada uma para e a fita
+// que deixa. As palavras são todas as de até 'comprimentoMaximo' símbolos, em ordem de comprimento, seguidas
+// de 'numAleatorias' palavras aleatórias de até 'comprimentoAleatorio' símbolos.
+
+typedef struct {
+    int comprimentoMaximo;
+    int comprimentoAleatorio;
+    uint64_t numAleatorias;
+    uint64_t semente;           // das palavras aleatórias
+    uint64_t limitePassos;      // da original; se ela não parar, a palavra é inconclusiva
+    uint64_t fatorTraduzida;    // a traduzida pode dar limitePassos * fatorTraduzida passos (UINT64_MAX se não couber)
+    const char* alfabeto;       // NULL: símbolos de um caractere lidos pela original, exceto '_' e '*'
+    int macropassos;            // executa as duas com acelerar_programa
+    int fitaDobrada;            // a traduzida veio de traduzir_I_para_S_dobrada: a fita é lida como pares
+} ParametrosVerificacao;
+
+typedef struct {
+    uint64_t totalPalavras;
+    char alfabeto[257];         // alfabeto das palavras
+    uint64_t verificadas;
+    uint64_t inconclusivas;
+    uint64_t contraExemplo;     // índice da primeira palavra que diverge (UINT64_MAX se nenhuma)
+    char relato[2048];          // palavra, estado final, passos e fita de cada máquina no contraexemplo
+} ResultadoVerificacao;
+
+typedef struct Verificacao Verificacao;
+
+// Compila as duas máquinas, que devem viver até liberar_verificacao. Preenche o total de palavras e o
+// alfabeto de 'resultado' (que pode ser NULL).
+Verificacao* preparar_verificacao(const MaquinaTuring* original, const MaquinaTuring* traduzida,
+                                  const ParametrosVerificacao* parametros, ResultadoVerificacao* resultado);
+// Verifica todas as palavras com até 'numThreads' threads (1: na thread que chamou) e preenche 'resultado'.
+// Retorna -1 se uma palavra não pôde ser executada (por exemplo, sem memória para a fita).
+int executar_verificacao(Verificacao* verificacao, int numThreads, ResultadoVerificacao* resultado);
+// Palavra de índice 'indice', em 'palavra' com espaço para max(comprimentoMaximo, comprimentoAleatorio) + 1 bytes
+void palavra_da_verificacao(const Verificacao* verificacao, uint64_t indice, char* palavra);
+void liberar_verificacao(Verificacao* verificacao);
+
+#endif